@@ -0,0 +1,51 @@
+#include <algorithm>
+
+#include "AddressSpace.h"
+
+void AddressSpace::addMapping(const Mapping &mapping) {
+  auto it = std::upper_bound(mappings.begin(), mappings.end(), mapping.addr,
+                             [](quint64 value, const Mapping &m) {
+                               return value < m.addr;
+                             });
+  mappings.insert(it - mappings.begin(), mapping);
+}
+
+int AddressSpace::findMapping(quint64 addr) const {
+  // Last mapping that starts at or before the address.
+  auto it = std::upper_bound(mappings.constBegin(), mappings.constEnd(), addr,
+                             [](quint64 value, const Mapping &m) {
+                               return value < m.addr;
+                             });
+  if (it == mappings.constBegin()) {
+    return -1;
+  }
+  --it;
+  if (addr - it->addr >= it->size) {
+    return -1;
+  }
+  return it - mappings.constBegin();
+}
+
+bool AddressSpace::toOffset(quint64 addr, quint64 &offset) const {
+  int idx = findMapping(addr);
+  if (idx == -1) {
+    return false;
+  }
+  const auto &mapping = mappings[idx];
+  quint64 delta = addr - mapping.addr;
+  if (delta >= mapping.fileSize) {
+    return false;
+  }
+  offset = mapping.offset + delta;
+  return true;
+}
+
+QByteArray AddressSpace::read(quint64 addr, quint64 len) const {
+  quint64 offset;
+  if (!toOffset(addr, offset)) {
+    return QByteArray();
+  }
+  const auto &mapping = mappings[findMapping(addr)];
+  quint64 avail = mapping.fileSize - (addr - mapping.addr);
+  return file->getData(offset, qMin(len, avail));
+}
@@ -0,0 +1,61 @@
+#ifndef BMOD_ADDRESS_SPACE_H
+#define BMOD_ADDRESS_SPACE_H
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+
+#include <memory>
+
+#include "MappedFile.h"
+
+class AddressSpace;
+typedef std::shared_ptr<AddressSpace> AddressSpacePtr;
+
+/**
+ * Virtual memory of a core dump backed by a mapped file. Nothing is read
+ * until an address is accessed, so even huge cores are cheap to open.
+ */
+class AddressSpace {
+public:
+  struct Mapping {
+    QString name;
+    quint64 addr, size; // Virtual memory range.
+    quint64 offset, fileSize; // Backing bytes in the file.
+    quint64 sectionsEnd; // File offset after the last section, or 0.
+    quint32 prot;
+  };
+
+  AddressSpace(MappedFilePtr file) : file{file} { }
+
+  MappedFilePtr getFile() const { return file; }
+
+  /**
+   * Add a mapping and keep them sorted by address.
+   */
+  void addMapping(const Mapping &mapping);
+  const QVector<Mapping> &getMappings() const { return mappings; }
+
+  /**
+   * Index of the mapping containing the address, or -1.
+   */
+  int findMapping(quint64 addr) const;
+
+  /**
+   * File offset of the address if it is backed by the file.
+   */
+  bool toOffset(quint64 addr, quint64 &offset) const;
+
+  /**
+   * Data at the address without copying, up to the end of its mapping.
+   */
+  QByteArray read(quint64 addr, quint64 len) const;
+
+private:
+  MappedFilePtr file;
+  QVector<Mapping> mappings;
+};
+
+#endif // BMOD_ADDRESS_SPACE_H
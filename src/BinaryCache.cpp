@@ -0,0 +1,162 @@
+#include <QFileInfo>
+
+#include <algorithm>
+
+#include "Util.h"
+#include "BinaryCache.h"
+
+BinaryCache::BinaryCache(quint64 budget) : budget{budget}, usage{0}, tick{0}
+{ }
+
+BinaryCache::ObjectPtr BinaryCache::getObject(const QString &file,
+                                              const QString &arch,
+                                              QString &error) {
+  QFileInfo fi(file);
+  if (!fi.exists()) {
+    error = QObject::tr("No such file");
+    return nullptr;
+  }
+  QString path = fi.canonicalFilePath();
+
+  auto it = entries.find(path);
+  if (it != entries.end() && (it->modified != fi.lastModified() ||
+                              it->fileSize != fi.size())) {
+    usage -= it->cost;
+    entries.erase(it);
+    it = entries.end();
+  }
+
+  if (it == entries.end()) {
+    auto fmt = Format::detect(path);
+    if (!fmt || !fmt->parse()) {
+      error = QObject::tr("Could not parse file");
+      return nullptr;
+    }
+
+    Entry entry;
+    entry.fmt = fmt;
+    entry.modified = fi.lastModified();
+    entry.fileSize = fi.size();
+    entry.cost = fi.size();
+    foreach (auto obj, fmt->getObjects()) {
+      auto object = ObjectPtr(new Object);
+      object->obj = obj;
+      object->indexed = object->decoded = object->xrefsBuilt = false;
+      entry.objects << object;
+    }
+    usage += entry.cost;
+    it = entries.insert(path, entry);
+  }
+  it->lastUse = ++tick;
+
+  ObjectPtr res;
+  foreach (auto object, it->objects) {
+    if (arch.isEmpty() ||
+        Util::cpuTypeString(object->obj->getCpuType())
+        .compare(arch, Qt::CaseInsensitive) == 0) {
+      res = object;
+      break;
+    }
+  }
+  evict(path);
+  if (!res) {
+    error = QObject::tr("No object of architecture %1").arg(arch);
+  }
+  return res;
+}
+
+bool BinaryCache::lookupSymbol(ObjectPtr obj, const QString &name,
+                               quint64 &addr) {
+  if (!obj->indexed) {
+    obj->indexed = true;
+    quint64 cost{0};
+    auto index = [&](const SymbolTable &tbl) {
+      foreach (const auto &entry, tbl.getSymbols()) {
+        const QString &str = entry.getString();
+        if (!str.isEmpty() && entry.getValue() != 0 &&
+            !obj->addrByName.contains(str)) {
+          obj->addrByName[str] = entry.getValue();
+          cost += str.size() * 2 + 32;
+        }
+      }
+    };
+    index(obj->obj->getSymbolTable());
+    index(obj->obj->getDynSymbolTable());
+    addCost(obj, cost);
+  }
+
+  auto it = obj->addrByName.constFind(name);
+  if (it == obj->addrByName.constEnd()) {
+    return false;
+  }
+  addr = it.value();
+  return true;
+}
+
+int BinaryCache::findLine(ObjectPtr obj, quint64 addr) {
+  if (!obj->decoded) {
+    obj->decoded = true;
+    obj->text = obj->obj->getSection(SectionType::Text);
+    if (obj->text) {
+      Disassembler dis(obj->obj);
+      dis.disassemble(obj->text, obj->disasm);
+    }
+
+    const auto &disasm = obj->disasm;
+    quint64 lineAddr = (obj->text ? obj->text->getAddress() : 0), cost{0};
+    obj->lineAddrs.reserve(disasm.asmLines.size());
+    for (int i = 0; i < disasm.asmLines.size(); i++) {
+      obj->lineAddrs << lineAddr;
+      lineAddr += disasm.bytesConsumed[i];
+      cost += disasm.asmLines[i].size() * 2 + 48;
+    }
+    addCost(obj, cost);
+  }
+
+  const auto &addrs = obj->lineAddrs;
+  if (addrs.isEmpty() || addr < addrs.first()) {
+    return -1;
+  }
+  int idx = std::upper_bound(addrs.constBegin(), addrs.constEnd(), addr) -
+    addrs.constBegin() - 1;
+  if (addr >= addrs[idx] + obj->disasm.bytesConsumed[idx]) {
+    return -1;
+  }
+  return idx;
+}
+
+XrefIndexPtr BinaryCache::getXrefIndex(ObjectPtr obj) {
+  auto xrefs = obj->obj->getXrefIndex();
+  if (!obj->xrefsBuilt) {
+    obj->xrefsBuilt = true;
+    addCost(obj, (quint64) xrefs->getTargetCount() * 24 +
+            (quint64) xrefs->getReferenceCount() * 9);
+  }
+  return xrefs;
+}
+
+void BinaryCache::addCost(ObjectPtr obj, quint64 cost) {
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (it->objects.contains(obj)) {
+      it->cost += cost;
+      usage += cost;
+      evict(it.key());
+      return;
+    }
+  }
+}
+
+void BinaryCache::evict(const QString &keep) {
+  while (usage > budget && entries.size() > 1) {
+    auto oldest = entries.end();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (it.key() != keep &&
+          (oldest == entries.end() || it->lastUse < oldest->lastUse)) {
+        oldest = it;
+      }
+    }
+    if (oldest == entries.end()) return;
+    usage -= oldest->cost;
+    entries.erase(oldest);
+  }
+}
@@ -0,0 +1,93 @@
+#ifndef BMOD_BINARY_CACHE_H
+#define BMOD_BINARY_CACHE_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QDateTime>
+
+#include <memory>
+
+#include "formats/Format.h"
+#include "asm/Disassembler.h"
+#include "analysis/XrefIndex.h"
+
+/**
+ * Parsed binaries kept resident across queries of the analysis server.
+ * Indexes are built on first use and the least recently used binaries
+ * are dropped when the estimated memory use exceeds the budget. A binary
+ * is parsed again if its file changed since.
+ */
+class BinaryCache {
+public:
+  /**
+   * Resident data of one object of a binary.
+   */
+  struct Object {
+    BinaryObjectPtr obj;
+
+    // Symbol names to addresses of both symbol tables.
+    bool indexed;
+    QHash<QString, quint64> addrByName;
+
+    // Linear sweep of the code section and the address of each line.
+    bool decoded;
+    SectionPtr text;
+    Disassembly disasm;
+    QVector<quint64> lineAddrs;
+
+    bool xrefsBuilt;
+  };
+  typedef std::shared_ptr<Object> ObjectPtr;
+
+  BinaryCache(quint64 budget);
+
+  /**
+   * Object of the file of the CPU type named as by Util::cpuTypeString(),
+   * or the first one if arch is empty. Returns null and sets the error if
+   * it could not be loaded.
+   */
+  ObjectPtr getObject(const QString &file, const QString &arch,
+                      QString &error);
+
+  /**
+   * Address of the symbol name.
+   */
+  bool lookupSymbol(ObjectPtr obj, const QString &name, quint64 &addr);
+
+  /**
+   * Index of the decoded line containing the address, or -1.
+   */
+  int findLine(ObjectPtr obj, quint64 addr);
+
+  /**
+   * Cross-reference index of the object, kept with it.
+   */
+  XrefIndexPtr getXrefIndex(ObjectPtr obj);
+
+  int getCount() const { return entries.size(); }
+  quint64 getUsage() const { return usage; }
+  quint64 getBudget() const { return budget; }
+
+private:
+  struct Entry {
+    FormatPtr fmt;
+    QDateTime modified;
+    qint64 fileSize;
+    QVector<ObjectPtr> objects;
+    quint64 cost, lastUse;
+  };
+
+  void addCost(ObjectPtr obj, quint64 cost);
+
+  /**
+   * Drop the least recently used entries until within budget, except
+   * the one in use.
+   */
+  void evict(const QString &keep);
+
+  quint64 budget, usage, tick;
+  QHash<QString, Entry> entries;
+};
+
+#endif // BMOD_BINARY_CACHE_H
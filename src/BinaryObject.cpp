@@ -1,9 +1,17 @@
 #include "BinaryObject.h"
+#include "analysis/ObjcIndex.h"
+#include "analysis/XrefIndex.h"
+#include "analysis/CallGraph.h"
+#include "analysis/SimilarityIndex.h"
+#include "analysis/ControlFlowGraph.h"
+#include "formats/DwarfLineTable.h"
 
 BinaryObject::BinaryObject(CpuType cpuType, CpuType cpuSubType,
                            bool littleEndian, int systemBits, FileType fileType)
   : cpuType{cpuType}, cpuSubType{cpuSubType}, littleEndian{littleEndian},
-  systemBits{systemBits}, fileType{fileType}
+  systemBits{systemBits}, fileType{fileType}, fileOffset{0}, fileSize{0},
+  entryPoint{0}, lineTableBuilt{false}, objcIndexBuilt{false},
+  xrefVersion{0}, cfgVersion{0}, callGraphVersion{0}, simIndexVersion{0}
 {
   if (cpuType == CpuType::X86_64) {
     this->systemBits = 64;
@@ -28,3 +36,130 @@ SectionPtr BinaryObject::getSection(SectionType type) const {
   }
   return nullptr;
 }
+
+DwarfLineTablePtr BinaryObject::getLineTable() {
+  if (!lineTableBuilt) {
+    lineTableBuilt = true;
+    lineTable = DwarfLineTable::build(debugSections, littleEndian);
+  }
+  return lineTable;
+}
+
+ObjcIndexPtr BinaryObject::getObjcIndex() {
+  if (!objcIndexBuilt) {
+    objcIndexBuilt = true;
+    objcIndex = ObjcIndex::build(shared_from_this());
+  }
+  return objcIndex;
+}
+
+quint64 BinaryObject::getVersion() const {
+  // Section versions only increase so their sum changes with any edit.
+  quint64 version{0};
+  foreach (auto sec, sections) {
+    version += sec->getVersion();
+  }
+  return version;
+}
+
+void BinaryObject::dropStaleAnalyses() {
+  // The call graph and fingerprints are built from the control flow.
+  quint64 version = getVersion();
+  if (xrefVersion != version) {
+    xrefIndex.reset();
+  }
+  if (cfgVersion != version) {
+    cfg.reset();
+    callGraph.reset();
+    simIndex.reset();
+  }
+  if (callGraphVersion != version) {
+    callGraph.reset();
+  }
+  if (simIndexVersion != version) {
+    simIndex.reset();
+  }
+}
+
+XrefIndexPtr BinaryObject::getXrefIndex(quint64 *version) {
+  if (!xrefIndex) {
+    xrefIndex = XrefIndex::build(shared_from_this());
+    xrefVersion = getVersion();
+  }
+  if (version) {
+    *version = xrefVersion;
+  }
+  return xrefIndex;
+}
+
+void BinaryObject::setXrefIndex(XrefIndexPtr index) {
+  xrefIndex = index;
+  xrefVersion = getVersion();
+}
+
+ControlFlowGraphPtr BinaryObject::getControlFlowGraph(quint64 *version) {
+  if (!cfg) {
+    cfg = ControlFlowGraph::build(shared_from_this());
+    cfgVersion = getVersion();
+  }
+  if (version) {
+    *version = cfgVersion;
+  }
+  return cfg;
+}
+
+void BinaryObject::setControlFlowGraph(ControlFlowGraphPtr cfg) {
+  this->cfg = cfg;
+  cfgVersion = getVersion();
+}
+
+CallGraphPtr BinaryObject::getCallGraph(quint64 *version) {
+  if (!callGraph) {
+    callGraph = CallGraph::build(shared_from_this());
+    callGraphVersion = getVersion();
+  }
+  if (version) {
+    *version = callGraphVersion;
+  }
+  return callGraph;
+}
+
+void BinaryObject::setCallGraph(CallGraphPtr graph) {
+  callGraph = graph;
+  callGraphVersion = getVersion();
+}
+
+SimilarityIndexPtr BinaryObject::getSimilarityIndex(quint64 *version) {
+  if (!simIndex) {
+    simIndex = SimilarityIndex::build(shared_from_this());
+    simIndexVersion = getVersion();
+  }
+  if (version) {
+    *version = simIndexVersion;
+  }
+  return simIndex;
+}
+
+void BinaryObject::setSimilarityIndex(SimilarityIndexPtr index) {
+  simIndex = index;
+  simIndexVersion = getVersion();
+}
+
+void BinaryObject::update(BinaryObjectPtr other) {
+  symTable = other->symTable;
+  dynsymTable = other->dynsymTable;
+  entryPoint = other->entryPoint;
+  funcStarts = other->funcStarts;
+  debugSections = other->debugSections;
+  addrSpace = other->addrSpace;
+  threads = other->threads;
+
+  lineTable.reset();
+  lineTableBuilt = false;
+  objcIndex.reset();
+  objcIndexBuilt = false;
+  xrefIndex.reset();
+  cfg.reset();
+  callGraph.reset();
+  simIndex.reset();
+}
@@ -9,11 +9,31 @@
 #include "CpuType.h"
 #include "FileType.h"
 #include "SymbolTable.h"
+#include "ThreadState.h"
+#include "AddressSpace.h"
 
 class BinaryObject;
 typedef std::shared_ptr<BinaryObject> BinaryObjectPtr;
 
-class BinaryObject {
+class XrefIndex;
+typedef std::shared_ptr<XrefIndex> XrefIndexPtr;
+
+class ControlFlowGraph;
+typedef std::shared_ptr<ControlFlowGraph> ControlFlowGraphPtr;
+
+class CallGraph;
+typedef std::shared_ptr<CallGraph> CallGraphPtr;
+
+class SimilarityIndex;
+typedef std::shared_ptr<SimilarityIndex> SimilarityIndexPtr;
+
+class DwarfLineTable;
+typedef std::shared_ptr<DwarfLineTable> DwarfLineTablePtr;
+
+class ObjcIndex;
+typedef std::shared_ptr<ObjcIndex> ObjcIndexPtr;
+
+class BinaryObject : public std::enable_shared_from_this<BinaryObject> {
 public:
   BinaryObject(CpuType cpuType = CpuType::X86, CpuType cpuSubType = CpuType::I386,
                bool littleEndian = true, int systemBits = 32,
@@ -34,6 +54,17 @@ public:
   FileType getFileType() const { return fileType; }
   void setFileType(FileType type) { fileType = type; }
 
+  /**
+   * Range of the object in the file, where a zero size means until the
+   * end of the file.
+   */
+  quint64 getFileOffset() const { return fileOffset; }
+  quint64 getFileSize() const { return fileSize; }
+  void setFileRange(quint64 offset, quint64 size) {
+    fileOffset = offset;
+    fileSize = size;
+  }
+
   QList<SectionPtr> getSections() const { return sections; }
   QList<SectionPtr> getSectionsByType(SectionType type) const;
   SectionPtr getSection(SectionType type) const;
@@ -45,13 +76,116 @@ public:
   void setDynSymbolTable(const SymbolTable &tbl) { dynsymTable = tbl; }
   const SymbolTable &getDynSymbolTable() const { return dynsymTable; }
 
+  /**
+   * Address of the program entry point, or 0 if unknown.
+   */
+  quint64 getEntryPoint() const { return entryPoint; }
+  void setEntryPoint(quint64 addr) { entryPoint = addr; }
+
+  /**
+   * Function addresses recorded by the linker, if any.
+   */
+  const QList<quint64> &getFunctionStarts() const { return funcStarts; }
+  void setFunctionStarts(const QList<quint64> &starts) { funcStarts = starts; }
+
+  /**
+   * DWARF sections of the object or of its dSYM bundle. They are kept
+   * apart from the other sections since they are never edited and may
+   * belong to another file.
+   */
+  const QList<SectionPtr> &getDebugSections() const { return debugSections; }
+  void addDebugSection(SectionPtr sec) { debugSections << sec; }
+
+  /**
+   * Source lines of addresses, built on first request. Null if there is
+   * no line information.
+   */
+  DwarfLineTablePtr getLineTable();
+
+  /**
+   * Virtual memory of the segments mapped from the file, and threads of
+   * core dumps.
+   */
+  AddressSpacePtr getAddressSpace() const { return addrSpace; }
+  void setAddressSpace(AddressSpacePtr space) { addrSpace = space; }
+
+  const QList<ThreadState> &getThreads() const { return threads; }
+  void addThread(const ThreadState &thread) { threads << thread; }
+
+  /**
+   * Objective-C classes and selectors, built on first request. Null if
+   * there is no Objective-C metadata.
+   */
+  ObjcIndexPtr getObjcIndex();
+
+  /**
+   * Version of the data of all sections that increases with every edit.
+   * The analyses below are tagged with the version they were built from,
+   * which is set if requested. They are kept after edits so callers
+   * compare it to the current version and decide when to rebuild.
+   */
+  quint64 getVersion() const;
+
+  /**
+   * Drop the analyses built from an older version so they are built
+   * again on next request.
+   */
+  void dropStaleAnalyses();
+
+  /**
+   * Cross-references of the code sections, built on first request.
+   */
+  XrefIndexPtr getXrefIndex(quint64 *version = nullptr);
+  void setXrefIndex(XrefIndexPtr index);
+
+  /**
+   * Functions and basic blocks recovered from the code sections, built
+   * on first request.
+   */
+  ControlFlowGraphPtr getControlFlowGraph(quint64 *version = nullptr);
+  void setControlFlowGraph(ControlFlowGraphPtr cfg);
+
+  /**
+   * Call graph of the recovered functions, built on first request.
+   */
+  CallGraphPtr getCallGraph(quint64 *version = nullptr);
+  void setCallGraph(CallGraphPtr graph);
+
+  /**
+   * Fingerprints of the recovered functions, built on first request.
+   */
+  SimilarityIndexPtr getSimilarityIndex(quint64 *version = nullptr);
+  void setSimilarityIndex(SimilarityIndexPtr index);
+
+  /**
+   * Take what was parsed from the headers of the same object after the
+   * file changed and drop the analyses so they are built again. The
+   * sections are left to the caller.
+   */
+  void update(BinaryObjectPtr other);
+
 private:
   CpuType cpuType, cpuSubType;
   bool littleEndian;
   int systemBits;
   FileType fileType;
+  quint64 fileOffset, fileSize;
   QList<SectionPtr> sections;
   SymbolTable symTable, dynsymTable;
+  quint64 entryPoint;
+  QList<quint64> funcStarts;
+  QList<SectionPtr> debugSections;
+  DwarfLineTablePtr lineTable;
+  bool lineTableBuilt;
+  AddressSpacePtr addrSpace;
+  QList<ThreadState> threads;
+  ObjcIndexPtr objcIndex;
+  bool objcIndexBuilt;
+  XrefIndexPtr xrefIndex;
+  ControlFlowGraphPtr cfg;
+  CallGraphPtr callGraph;
+  SimilarityIndexPtr simIndex;
+  quint64 xrefVersion, cfgVersion, callGraphVersion, simIndexVersion;
 };
 
 #endif // BMOD_BINARY_OBJECT_H
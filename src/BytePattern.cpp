@@ -0,0 +1,161 @@
+#include <QStringList>
+#include <QtConcurrentMap>
+
+#include "BytePattern.h"
+
+namespace {
+  struct Job {
+    SectionPtr sec;
+    QList<int> matches;
+  };
+}
+
+BytePattern::BytePattern(const QString &pattern, bool *ok) : anchorPos{0} {
+  bool res{true};
+  QStringList tokens = pattern.simplified().split(" ", QString::SkipEmptyParts);
+  foreach (const auto &token, tokens) {
+    if (token == "??") {
+      wildPos << bytes.size();
+      bytes += (char) 0;
+      wild << true;
+      continue;
+    }
+
+    bool okNum;
+    uint num = token.toUInt(&okNum, 16);
+    if (token.size() != 2 || !okNum) {
+      res = false;
+      break;
+    }
+    bytes += (char) num;
+    wild << false;
+  }
+  if (bytes.isEmpty()) {
+    res = false;
+  }
+
+  // The longest literal run is searched for first.
+  for (int i = 0, start = 0; i <= bytes.size(); i++) {
+    if (i == bytes.size() || wild[i]) {
+      if (i - start > anchor.size()) {
+        anchor = bytes.mid(start, i - start);
+        anchorPos = start;
+      }
+      start = i + 1;
+    }
+  }
+
+  if (ok) *ok = res;
+}
+
+bool BytePattern::setReplacement(const QString &tmpl) {
+  QVector<int> repl;
+  QStringList tokens = tmpl.simplified().split(" ", QString::SkipEmptyParts);
+  foreach (const auto &token, tokens) {
+    bool ok;
+    if (token == "??") {
+      repl << -1;
+    }
+    else if (token.startsWith("$")) {
+      int num = token.mid(1).toInt(&ok);
+      if (!ok || num < 1 || num > wildPos.size()) {
+        return false;
+      }
+      repl << -(num + 1);
+    }
+    else {
+      uint num = token.toUInt(&ok, 16);
+      if (token.size() != 2 || !ok) {
+        return false;
+      }
+      repl << num;
+    }
+  }
+
+  // Patching is in place so the sizes must agree.
+  if (repl.size() != bytes.size()) {
+    return false;
+  }
+  replBytes = repl;
+  return true;
+}
+
+QList<int> BytePattern::findAll(const QByteArray &data) const {
+  QList<int> res;
+  const int size = bytes.size(), len = data.size();
+  if (size == 0 || len < size) {
+    return res;
+  }
+
+  // Only wildcards so every position matches.
+  if (anchor.isEmpty()) {
+    for (int pos = 0; pos + size <= len; pos += size) {
+      res << pos;
+    }
+    return res;
+  }
+
+  // Candidates are found by the anchor using the optimized search of
+  // QByteArray and verified afterwards.
+  int from = anchorPos;
+  while (true) {
+    int idx = data.indexOf(anchor, from);
+    if (idx == -1) break;
+    int start = idx - anchorPos;
+    if (start + size > len) break;
+    if (matchesAt(data.constData() + start)) {
+      res << start;
+      from = start + size + anchorPos;
+    }
+    else {
+      from = idx + 1;
+    }
+  }
+  return res;
+}
+
+QVector<QList<int>> BytePattern::findAll(const QList<SectionPtr> &secs) const {
+  QVector<Job> jobs;
+  foreach (auto sec, secs) {
+    Job job;
+    job.sec = sec;
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [this](Job &job) {
+      auto snap = job.sec->getSnapshot();
+      job.matches = findAll(snap.data);
+    });
+
+  QVector<QList<int>> res;
+  foreach (const auto &job, jobs) {
+    res << job.matches;
+  }
+  return res;
+}
+
+QByteArray BytePattern::replacement(const QByteArray &data, int pos) const {
+  QByteArray res(replBytes.size(), 0);
+  for (int i = 0; i < replBytes.size(); i++) {
+    int repl = replBytes[i];
+    if (repl >= 0) {
+      res[i] = (char) repl;
+    }
+    else if (repl == -1) {
+      res[i] = data[pos + i];
+    }
+    else {
+      res[i] = data[pos + wildPos[-repl - 2]];
+    }
+  }
+  return res;
+}
+
+bool BytePattern::matchesAt(const char *data) const {
+  for (int i = 0; i < bytes.size(); i++) {
+    if (!wild[i] && data[i] != bytes[i]) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef BMOD_BYTE_PATTERN_H
+#define BMOD_BYTE_PATTERN_H
+
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+
+#include "Section.h"
+
+/**
+ * Byte pattern with wildcards like "E8 ?? ?? ?? ??" and an optional
+ * replacement template of the same length.
+ *
+ * In the template "XX" is a literal byte, "??" keeps the matched byte
+ * and "$N" inserts the byte matched by the Nth wildcard (from 1).
+ */
+class BytePattern {
+public:
+  BytePattern(const QString &pattern, bool *ok = nullptr);
+
+  int size() const { return bytes.size(); }
+
+  bool setReplacement(const QString &tmpl);
+  bool hasReplacement() const { return !replBytes.isEmpty(); }
+
+  /**
+   * Offsets of the non-overlapping matches in the data.
+   */
+  QList<int> findAll(const QByteArray &data) const;
+
+  /**
+   * Matches of every section searched in parallel, in section order.
+   */
+  QVector<QList<int>> findAll(const QList<SectionPtr> &secs) const;
+
+  /**
+   * Replacement bytes for the match at the position in the data.
+   */
+  QByteArray replacement(const QByteArray &data, int pos) const;
+
+private:
+  bool matchesAt(const char *data) const;
+
+  QByteArray bytes;
+  QVector<bool> wild;
+  QList<int> wildPos; // Position of each wildcard.
+
+  // Longest run of literal bytes used to find candidates quickly.
+  QByteArray anchor;
+  int anchorPos;
+
+  // Replacement byte per position: 0-255 literal, -1 to keep, or
+  // -(N + 1) for the Nth wildcard (from 1).
+  QVector<int> replBytes;
+};
+
+#endif // BMOD_BYTE_PATTERN_H
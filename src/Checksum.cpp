@@ -0,0 +1,350 @@
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <QtConcurrentMap>
+
+#include <cstring>
+#include <climits>
+
+#include "Section.h"
+#include "Checksum.h"
+
+namespace {
+  struct Job {
+    QByteArray data;
+    MappedFilePtr file; // Keeps mapped section data valid.
+    SectionPtr sec;
+    quint64 version;
+    Checksum::Digest digest;
+  };
+
+  /**
+   * Slicing-by-8 tables of the reflected Castagnoli polynomial.
+   */
+  struct Crc32cTables {
+    Crc32cTables() {
+      for (quint32 i = 0; i < 256; i++) {
+        quint32 crc = i;
+        for (int j = 0; j < 8; j++) {
+          crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+        }
+        table[0][i] = crc;
+      }
+      for (quint32 i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+          quint32 prev = table[t - 1][i];
+          table[t][i] = (prev >> 8) ^ table[0][prev & 0xFF];
+        }
+      }
+    }
+
+    quint32 table[8][256];
+  };
+
+  quint32 crc32cTable(const char *data, qint64 len, quint32 crc) {
+    static const Crc32cTables tables;
+    const auto &t = tables.table;
+    const auto *p = (const uchar*) data;
+    while (len >= 8) {
+      quint32 lo, hi;
+      memcpy(&lo, p, 4);
+      memcpy(&hi, p + 4, 4);
+      lo ^= crc;
+      crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+        t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+        t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+        t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+      p += 8;
+      len -= 8;
+    }
+    while (len-- > 0) {
+      crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+  }
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BMOD_CRC32C_HW
+
+  __attribute__((target("sse4.2")))
+  quint32 crc32cHw(const char *data, qint64 len, quint32 crc) {
+    quint64 crc64 = crc;
+    while (len >= 8) {
+      quint64 value;
+      memcpy(&value, data, 8);
+      crc64 = __builtin_ia32_crc32di(crc64, value);
+      data += 8;
+      len -= 8;
+    }
+    crc = crc64;
+    while (len-- > 0) {
+      crc = __builtin_ia32_crc32qi(crc, *data++);
+    }
+    return crc;
+  }
+#endif
+
+  const quint64 PRIME1{0x9E3779B185EBCA87ULL}, PRIME2{0xC2B2AE3D27D4EB4FULL},
+    PRIME3{0x165667B19E3779F9ULL}, PRIME4{0x85EBCA77C2B2AE63ULL},
+    PRIME5{0x27D4EB2F165667C5ULL};
+
+  inline quint64 rotl(quint64 x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  inline quint64 read64(const uchar *p) {
+    quint64 value;
+    memcpy(&value, p, 8);
+    return value;
+  }
+
+  inline quint32 read32(const uchar *p) {
+    quint32 value;
+    memcpy(&value, p, 4);
+    return value;
+  }
+
+  inline quint64 xxhRound(quint64 acc, quint64 input) {
+    acc += input * PRIME2;
+    return rotl(acc, 31) * PRIME1;
+  }
+
+  inline quint64 mergeRound(quint64 acc, quint64 value) {
+    acc ^= xxhRound(0, value);
+    return acc * PRIME1 + PRIME4;
+  }
+
+  // Digests keyed by XXH64 and size so identical contents, like the same
+  // section in several binaries, are only hashed fully once. The contents
+  // are compared on lookup so colliding data is never given another
+  // digest. They are copied since the data may refer to a mapping.
+  typedef QPair<quint64, int> CacheKey;
+  struct CacheEntry {
+    QByteArray data;
+    Checksum::Digest digest;
+  };
+  QHash<CacheKey, CacheEntry> cache;
+  qint64 cachedSize{0};
+  QMutex cacheMutex;
+  const qint64 MAX_CACHED_SIZE{64 * 1024 * 1024};
+
+  // Largest amount hashed at once since lengths of Qt are ints.
+  const qint64 CHUNK_SIZE{1024 * 1024 * 1024};
+
+  struct RangeJob {
+    const char *data;
+    qint64 len;
+    Checksum::Digest digest;
+  };
+
+  Checksum::Digest compute(const char *data, qint64 len, quint64 xxh64) {
+    Checksum::Digest res;
+    res.xxh64 = xxh64;
+    res.crc32c = Checksum::crc32c(data, len);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    for (qint64 pos = 0; pos < len; pos += CHUNK_SIZE) {
+      hash.addData(data + pos, qMin(CHUNK_SIZE, len - pos));
+    }
+    res.sha256 = hash.result();
+    return res;
+  }
+}
+
+quint32 Checksum::crc32c(const char *data, qint64 len, quint32 crc) {
+  crc = ~crc;
+#ifdef BMOD_CRC32C_HW
+  static const bool hw = __builtin_cpu_supports("sse4.2");
+  if (hw) {
+    return ~crc32cHw(data, len, crc);
+  }
+#endif
+  return ~crc32cTable(data, len, crc);
+}
+
+quint64 Checksum::xxh64(const char *data, qint64 len, quint64 seed) {
+  // Assumes little-endian hosts like the rest of bmod.
+  const auto *p = (const uchar*) data, *end = p + len;
+  quint64 h;
+  if (len >= 32) {
+    quint64 v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed,
+      v4 = seed - PRIME1;
+    const uchar *limit = end - 32;
+    do {
+      v1 = xxhRound(v1, read64(p));
+      v2 = xxhRound(v2, read64(p + 8));
+      v3 = xxhRound(v3, read64(p + 16));
+      v4 = xxhRound(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = mergeRound(h, v1);
+    h = mergeRound(h, v2);
+    h = mergeRound(h, v3);
+    h = mergeRound(h, v4);
+  }
+  else {
+    h = seed + PRIME5;
+  }
+  h += (quint64) len;
+
+  while (p + 8 <= end) {
+    h ^= xxhRound(0, read64(p));
+    h = rotl(h, 27) * PRIME1 + PRIME4;
+    p += 8;
+  }
+  if (p + 4 <= end) {
+    h ^= (quint64) read32(p) * PRIME1;
+    h = rotl(h, 23) * PRIME2 + PRIME3;
+    p += 4;
+  }
+  while (p < end) {
+    h ^= (*p++) * PRIME5;
+    h = rotl(h, 11) * PRIME1;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME2;
+  h ^= h >> 29;
+  h *= PRIME3;
+  h ^= h >> 32;
+  return h;
+}
+
+Checksum::Digest Checksum::digest(const QByteArray &data) {
+  quint64 hash = xxh64(data.constData(), data.size());
+  CacheKey key(hash, data.size());
+  {
+    QMutexLocker locker(&cacheMutex);
+    auto it = cache.find(key);
+    if (it != cache.end() && it->data == data) {
+      return it->digest;
+    }
+  }
+
+  Digest res = compute(data.constData(), data.size(), hash);
+  if (data.size() > MAX_CACHED_SIZE / 4) {
+    return res;
+  }
+
+  QMutexLocker locker(&cacheMutex);
+  if (cachedSize + data.size() > MAX_CACHED_SIZE) {
+    cache.clear();
+    cachedSize = 0;
+  }
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    cachedSize -= it->data.size();
+  }
+  CacheEntry entry;
+  entry.data = QByteArray(data.constData(), data.size());
+  entry.digest = res;
+  cache.insert(key, entry);
+  cachedSize += data.size();
+  return res;
+}
+
+QVector<Checksum::Digest> Checksum::digestAll(const QList<QByteArray> &datas) {
+  QVector<Job> jobs;
+  foreach (const auto &data, datas) {
+    Job job;
+    job.data = data;
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [](Job &job) {
+      job.digest = digest(job.data);
+    });
+
+  QVector<Digest> res;
+  foreach (const auto &job, jobs) {
+    res << job.digest;
+  }
+  return res;
+}
+
+QVector<Checksum::Digest> Checksum::digestSections(const QList<SectionPtr> &secs) {
+  QVector<Job> jobs;
+  foreach (auto sec, secs) {
+    Job job;
+    job.sec = sec;
+    job.digest = sec->getDigest();
+    if (job.digest.isNull()) {
+      auto snap = sec->getSnapshot();
+      job.data = snap.data;
+      job.version = snap.version;
+      job.file = snap.file;
+    }
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [](Job &job) {
+      if (job.digest.isNull()) {
+        job.digest = digest(job.data);
+      }
+    });
+
+  // Only keep digests of the data the section still has.
+  QVector<Digest> res;
+  foreach (const auto &job, jobs) {
+    if (!job.data.isNull() && job.sec->getVersion() == job.version) {
+      job.sec->setDigest(job.digest);
+    }
+    res << job.digest;
+  }
+  return res;
+}
+
+QVector<Checksum::Digest>
+Checksum::digestRanges(const QString &file,
+                       const QList<QPair<quint64, quint64>> &ranges,
+                       bool *ok) {
+  QVector<Digest> res;
+  QFile f(file);
+  if (!f.open(QIODevice::ReadOnly)) {
+    if (ok) *ok = false;
+    return res;
+  }
+
+  quint64 size = f.size();
+  uchar *map = f.map(0, size);
+  if (!map) {
+    if (ok) *ok = false;
+    return res;
+  }
+
+  QVector<RangeJob> jobs;
+  bool okRanges{true};
+  foreach (const auto &range, ranges) {
+    quint64 len = (range.second == 0 ? size - range.first : range.second);
+    if (range.first > size || len > size - range.first) {
+      okRanges = false;
+      break;
+    }
+    RangeJob job;
+    job.data = (const char*) map + range.first;
+    job.len = len;
+    jobs << job;
+  }
+
+  // Ranges of 2 GiB or more do not fit a QByteArray nor the cache.
+  if (okRanges) {
+    QtConcurrent::blockingMap(jobs, [](RangeJob &job) {
+        if (job.len <= INT_MAX) {
+          job.digest = digest(QByteArray::fromRawData(job.data, job.len));
+        }
+        else {
+          job.digest = compute(job.data, job.len, xxh64(job.data, job.len));
+        }
+      });
+    foreach (const auto &job, jobs) {
+      res << job.digest;
+    }
+  }
+
+  f.unmap(map);
+  if (ok) *ok = okRanges;
+  return res;
+}
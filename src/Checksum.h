@@ -0,0 +1,75 @@
+#ifndef BMOD_CHECKSUM_H
+#define BMOD_CHECKSUM_H
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+
+#include <memory>
+
+class Section;
+typedef std::shared_ptr<Section> SectionPtr;
+
+/**
+ * Content digests of sections and object slices: CRC32C, XXH64 and
+ * SHA-256.
+ */
+class Checksum {
+public:
+  struct Digest {
+    Digest() : crc32c{0}, xxh64{0} { }
+
+    bool isNull() const { return sha256.isEmpty(); }
+
+    QString crc32cString() const {
+      return QString::number(crc32c, 16).toUpper().rightJustified(8, '0');
+    }
+    QString xxh64String() const {
+      return QString::number(xxh64, 16).toUpper().rightJustified(16, '0');
+    }
+    QString sha256String() const {
+      return QString(sha256.toHex().toUpper());
+    }
+
+    quint32 crc32c;
+    quint64 xxh64;
+    QByteArray sha256;
+  };
+
+  /**
+   * CRC32C (Castagnoli) using the SSE 4.2 instruction when the CPU has it.
+   * Pass the previous result as the crc to continue a checksum.
+   */
+  static quint32 crc32c(const char *data, qint64 len, quint32 crc = 0);
+
+  static quint64 xxh64(const char *data, qint64 len, quint64 seed = 0);
+
+  /**
+   * All digests of the data. Identical contents are only hashed fully
+   * once since the digests of smaller data are cached by content.
+   */
+  static Digest digest(const QByteArray &data);
+
+  /**
+   * Digests of each data in parallel, in data order.
+   */
+  static QVector<Digest> digestAll(const QList<QByteArray> &datas);
+
+  /**
+   * Digests of the sections in parallel, reusing the digests stored in
+   * sections that were not modified since.
+   */
+  static QVector<Digest> digestSections(const QList<SectionPtr> &secs);
+
+  /**
+   * Digests of the (offset, size) ranges of the memory mapped file where
+   * a zero size means the rest of the file.
+   */
+  static QVector<Digest> digestRanges(const QString &file,
+                                      const QList<QPair<quint64, quint64>> &ranges,
+                                      bool *ok = nullptr);
+};
+
+#endif // BMOD_CHECKSUM_H
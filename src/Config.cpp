@@ -19,6 +19,7 @@ void Config::load() {
   settings.beginReadArray("General");
   confirmCommit = settings.value("confirmCommit", true).toBool();
   confirmQuit = settings.value("confirmQuit", true).toBool();
+  watchFiles = settings.value("watchFiles", true).toBool();
   settings.endArray();
 
   settings.beginReadArray("Backups");
@@ -35,6 +36,7 @@ void Config::save() {
   settings.beginGroup("General");
   settings.setValue("confirmCommit", confirmCommit);
   settings.setValue("confirmQuit", confirmQuit);
+  settings.setValue("watchFiles", watchFiles);
   settings.endGroup();
 
   settings.beginGroup("Backups");
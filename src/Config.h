@@ -17,6 +17,9 @@ public:
   bool getConfirmQuit() const { return confirmQuit; }
   void setConfirmQuit(bool confirm) { confirmQuit = confirm; }
 
+  bool getWatchFiles() const { return watchFiles; }
+  void setWatchFiles(bool watch) { watchFiles = watch; }
+
   bool getBackupEnabled() const { return backupEnabled; }
   void setBackupEnabled(bool enabled) { backupEnabled = enabled; }
 
@@ -30,7 +33,7 @@ private:
   QSettings settings;
 
   // General
-  bool confirmCommit, confirmQuit;
+  bool confirmCommit, confirmQuit, watchFiles;
 
   // Backup
   bool backupEnabled, backupAsk;
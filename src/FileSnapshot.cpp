@@ -0,0 +1,79 @@
+#include <QFile>
+#include <QtConcurrentMap>
+
+#include "Checksum.h"
+#include "FileSnapshot.h"
+
+namespace {
+  // Pages are read in chunks so each job does a single read.
+  const int CHUNK_PAGES{256};
+
+  struct Job {
+    quint64 offset, size;
+    quint64 *hashes;
+    bool ok;
+  };
+}
+
+FileSnapshotPtr FileSnapshot::take(const QString &file) {
+  QFile f(file);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return nullptr;
+  }
+
+  auto snap = FileSnapshotPtr(new FileSnapshot);
+  snap->size = f.size();
+  f.close();
+  snap->hashes.resize((snap->size + PAGE_SIZE - 1) / PAGE_SIZE);
+
+  // The file is read instead of mapped since it might be truncated by
+  // whoever is rewriting it.
+  const quint64 chunkSize = (quint64) CHUNK_PAGES * PAGE_SIZE;
+  QVector<Job> jobs;
+  for (quint64 offset = 0; offset < snap->size; offset += chunkSize) {
+    Job job;
+    job.offset = offset;
+    job.size = qMin(chunkSize, snap->size - offset);
+    job.hashes = snap->hashes.data() + offset / PAGE_SIZE;
+    job.ok = false;
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [&file](Job &job) {
+      QFile f(file);
+      if (!f.open(QIODevice::ReadOnly) || !f.seek(job.offset)) return;
+      QByteArray data = f.read(job.size);
+      if ((quint64) data.size() != job.size) return;
+      for (quint64 pos = 0; pos < job.size; pos += PAGE_SIZE) {
+        *job.hashes++ =
+          Checksum::xxh64(data.constData() + pos,
+                          qMin((quint64) PAGE_SIZE, job.size - pos));
+      }
+      job.ok = true;
+    });
+
+  foreach (const auto &job, jobs) {
+    if (!job.ok) {
+      return nullptr;
+    }
+  }
+  return snap;
+}
+
+IntervalSet FileSnapshot::changedRanges(const FileSnapshot &other) const {
+  IntervalSet res;
+  int common = qMin(hashes.size(), other.hashes.size());
+  for (int i = 0; i < common; i++) {
+    if (hashes[i] != other.hashes[i]) {
+      res.add((quint64) i * PAGE_SIZE, PAGE_SIZE);
+    }
+  }
+
+  // A shorter last page of the same hash can only be equal if the sizes
+  // are too.
+  if (size != other.size) {
+    quint64 start = (quint64) qMax(0, common - 1) * PAGE_SIZE;
+    res.add(start, qMax(size, other.size) - start);
+  }
+  return res;
+}
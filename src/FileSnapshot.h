@@ -0,0 +1,43 @@
+#ifndef BMOD_FILE_SNAPSHOT_H
+#define BMOD_FILE_SNAPSHOT_H
+
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "IntervalSet.h"
+
+class FileSnapshot;
+typedef std::shared_ptr<FileSnapshot> FileSnapshotPtr;
+
+/**
+ * XXH64 hashes of each page of a file to tell which parts of it were
+ * rewritten on disk since.
+ */
+class FileSnapshot {
+public:
+  static const int PAGE_SIZE{4096};
+
+  /**
+   * Hashes the pages in parallel. Returns null if the file could not be
+   * read.
+   */
+  static FileSnapshotPtr take(const QString &file);
+
+  quint64 getSize() const { return size; }
+
+  /**
+   * File ranges of the pages that differ from the other snapshot. Pages
+   * beyond the end of either file count as changed.
+   */
+  IntervalSet changedRanges(const FileSnapshot &other) const;
+
+private:
+  FileSnapshot() : size{0} { }
+
+  quint64 size;
+  QVector<quint64> hashes;
+};
+
+#endif // BMOD_FILE_SNAPSHOT_H
@@ -0,0 +1,68 @@
+#include <algorithm>
+
+#include "IntervalSet.h"
+
+void IntervalSet::add(quint64 start, quint64 size) {
+  if (size == 0) return;
+  quint64 end = start + size;
+
+  // Appending in order is the common case.
+  if (intervals.isEmpty() || start > intervals.last().second) {
+    intervals << Interval(start, end);
+    return;
+  }
+
+  // First interval that ends at or after the start.
+  auto first = std::lower_bound(intervals.begin(), intervals.end(), start,
+                                [](const Interval &in, quint64 value) {
+                                  return in.second < value;
+                                });
+  // First interval that starts after the end.
+  auto last = std::upper_bound(first, intervals.end(), end,
+                               [](quint64 value, const Interval &in) {
+                                 return value < in.first;
+                               });
+  if (first == last) {
+    intervals.insert(first - intervals.begin(), Interval(start, end));
+    return;
+  }
+
+  // Merge the overlapped intervals into the first one.
+  first->first = qMin(first->first, start);
+  first->second = qMax((last - 1)->second, end);
+  int idx = first - intervals.begin();
+  intervals.remove(idx + 1, last - first - 1);
+}
+
+quint64 IntervalSet::getTotalSize() const {
+  quint64 total{0};
+  foreach (const auto &in, intervals) {
+    total += in.second - in.first;
+  }
+  return total;
+}
+
+bool IntervalSet::intersects(quint64 start, quint64 size) const {
+  if (size == 0) return false;
+  auto it = std::upper_bound(intervals.constBegin(), intervals.constEnd(),
+                             start, [](quint64 value, const Interval &in) {
+                               return value < in.second;
+                             });
+  return it != intervals.constEnd() && it->first < start + size;
+}
+
+IntervalSet IntervalSet::complement(quint64 end) const {
+  IntervalSet res;
+  quint64 pos{0};
+  foreach (const auto &in, intervals) {
+    if (in.first >= end) break;
+    if (in.first > pos) {
+      res.intervals << Interval(pos, in.first);
+    }
+    pos = in.second;
+  }
+  if (pos < end) {
+    res.intervals << Interval(pos, end);
+  }
+  return res;
+}
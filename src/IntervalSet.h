@@ -0,0 +1,39 @@
+#ifndef BMOD_INTERVAL_SET_H
+#define BMOD_INTERVAL_SET_H
+
+#include <QPair>
+#include <QVector>
+
+/**
+ * Set of half-open intervals [start, end) kept sorted and disjoint.
+ * Adjacent and overlapping intervals are merged when added.
+ */
+class IntervalSet {
+public:
+  typedef QPair<quint64, quint64> Interval;
+
+  void add(quint64 start, quint64 size);
+  void clear() { intervals.clear(); }
+
+  bool isEmpty() const { return intervals.isEmpty(); }
+  int count() const { return intervals.size(); }
+  const QVector<Interval> &getIntervals() const { return intervals; }
+
+  /**
+   * Sum of the sizes of all intervals.
+   */
+  quint64 getTotalSize() const;
+
+  bool contains(quint64 pos) const { return intersects(pos, 1); }
+  bool intersects(quint64 start, quint64 size) const;
+
+  /**
+   * Intervals of [0, end) not covered by this set.
+   */
+  IntervalSet complement(quint64 end) const;
+
+private:
+  QVector<Interval> intervals;
+};
+
+#endif // BMOD_INTERVAL_SET_H
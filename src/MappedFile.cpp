@@ -0,0 +1,101 @@
+#include <new>
+#include <climits>
+#include <cstring>
+
+#include "MappedFile.h"
+#include "IntervalSet.h"
+
+namespace {
+  // Largest read at once when copying a file.
+  const qint64 CHUNK_SIZE{64 * 1024 * 1024};
+}
+
+MappedFilePtr MappedFile::open(const QString &file, bool copy) {
+  auto mapped = MappedFilePtr(new MappedFile(file));
+  if (!mapped->f.open(QIODevice::ReadOnly)) {
+    return nullptr;
+  }
+  mapped->size = mapped->f.size();
+  if (mapped->size == 0) {
+    return nullptr;
+  }
+  if (copy) {
+    if (!mapped->allocate() || !mapped->read(0, mapped->size)) {
+      return nullptr;
+    }
+    mapped->f.close();
+    return mapped;
+  }
+  mapped->map = mapped->f.map(0, mapped->size);
+  if (!mapped->map) {
+    return nullptr;
+  }
+  return mapped;
+}
+
+MappedFilePtr MappedFile::reread(MappedFilePtr prev,
+                                 const IntervalSet &changed) {
+  if (!prev->isCopied()) {
+    return open(prev->f.fileName(), true);
+  }
+
+  auto mapped = MappedFilePtr(new MappedFile(prev->f.fileName()));
+  if (!mapped->f.open(QIODevice::ReadOnly)) {
+    return nullptr;
+  }
+  mapped->size = mapped->f.size();
+  if (mapped->size == 0 || !mapped->allocate()) {
+    return nullptr;
+  }
+
+  IntervalSet same = changed.complement(qMin(prev->size, mapped->size));
+  foreach (const auto &in, same.getIntervals()) {
+    memcpy(mapped->map + in.first, prev->map + in.first,
+           in.second - in.first);
+  }
+  foreach (const auto &in, same.complement(mapped->size).getIntervals()) {
+    if (!mapped->read(in.first, in.second - in.first)) {
+      return nullptr;
+    }
+  }
+  mapped->f.close();
+  return mapped;
+}
+
+MappedFile::MappedFile(const QString &file) : f{file}, size{0}, map{nullptr}
+{ }
+
+MappedFile::~MappedFile() {
+  if (map && !copy) {
+    f.unmap(map);
+  }
+}
+
+bool MappedFile::allocate() {
+  copy.reset(new (std::nothrow) uchar[size]);
+  map = copy.get();
+  return map != nullptr;
+}
+
+bool MappedFile::read(quint64 offset, quint64 len) {
+  if (!f.seek(offset)) {
+    return false;
+  }
+  while (len > 0) {
+    qint64 chunk = qMin((quint64) CHUNK_SIZE, len);
+    if (f.read((char*) map + offset, chunk) != chunk) {
+      return false;
+    }
+    offset += chunk;
+    len -= chunk;
+  }
+  return true;
+}
+
+QByteArray MappedFile::getData(quint64 offset, quint64 len) const {
+  // QByteArray sizes are ints, so larger ranges must use getPointer().
+  if (!contains(offset, len) || len > (quint64) INT_MAX) {
+    return QByteArray();
+  }
+  return QByteArray::fromRawData((const char*) map + offset, len);
+}
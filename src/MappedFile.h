@@ -0,0 +1,65 @@
+#ifndef BMOD_MAPPED_FILE_H
+#define BMOD_MAPPED_FILE_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+#include <memory>
+
+class IntervalSet;
+class MappedFile;
+typedef std::shared_ptr<MappedFile> MappedFilePtr;
+
+/**
+ * Read-only memory mapping of a whole file. Pages are only loaded when
+ * touched, and data handed out refers to the mapping without copying so
+ * it must be kept alive as long as the data is used.
+ *
+ * Rewriting a mapped file in place (like a build does) changes the data
+ * under the parsed layout or faults on truncated pages, so files that are
+ * watched for changes are read into private memory instead.
+ */
+class MappedFile {
+public:
+  static MappedFilePtr open(const QString &file, bool copy = false);
+
+  /**
+   * Private copy of the file after it changed on disk. Only the changed
+   * file ranges are read, the rest is taken from the previous copy.
+   */
+  static MappedFilePtr reread(MappedFilePtr prev, const IntervalSet &changed);
+
+  ~MappedFile();
+
+  /**
+   * Whether the file was read instead of mapped.
+   */
+  bool isCopied() const { return copy != nullptr; }
+
+  quint64 getSize() const { return size; }
+  const uchar *getPointer() const { return map; }
+
+  bool contains(quint64 offset, quint64 len) const {
+    return offset <= size && len <= size - offset;
+  }
+
+  /**
+   * Data of the range without copying, or empty if out of bounds. It is
+   * copied on the first modification as usual.
+   */
+  QByteArray getData(quint64 offset, quint64 len) const;
+
+private:
+  MappedFile(const QString &file);
+
+  bool allocate();
+  bool read(quint64 offset, quint64 len);
+
+  QFile f;
+  quint64 size;
+  uchar *map;
+  std::unique_ptr<uchar[]> copy;
+};
+
+#endif // BMOD_MAPPED_FILE_H
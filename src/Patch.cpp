@@ -0,0 +1,213 @@
+#include <QFile>
+#include <QVector>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <cstring>
+
+#include "Patch.h"
+#include "IntervalSet.h"
+
+namespace {
+  const quint32 MAGIC{0x424D5041}; // "BMPA"
+  const quint32 VERSION{1};
+
+  struct Job {
+    QString target;
+    Patch::Result result;
+  };
+
+  /**
+   * Sort entries by offset and merge adjacent ones into single runs.
+   */
+  QList<Patch::Entry> coalesce(QList<Patch::Entry> entries) {
+    std::sort(entries.begin(), entries.end(),
+              [](const Patch::Entry &a, const Patch::Entry &b) {
+                return a.offset < b.offset;
+              });
+    QList<Patch::Entry> res;
+    foreach (const auto &entry, entries) {
+      if (!res.isEmpty()) {
+        auto &last = res.last();
+        if (last.offset + last.newData.size() == entry.offset) {
+          last.oldData += entry.oldData;
+          last.newData += entry.newData;
+          continue;
+        }
+      }
+      res << entry;
+    }
+    return res;
+  }
+}
+
+PatchPtr Patch::fromFormat(FormatPtr fmt) {
+  QList<Entry> entries;
+  foreach (const auto obj, fmt->getObjects()) {
+    foreach (const auto sec, obj->getSections()) {
+      if (!sec->isModified()) continue;
+
+      // Regions edited several times overlap so merge them first.
+      IntervalSet regions;
+      foreach (const auto &region, sec->getModifiedRegions()) {
+        regions.add(region.first, region.second);
+      }
+
+      const QByteArray &data = sec->getData(),
+        &original = sec->getOriginalData();
+      foreach (const auto &region, regions.getIntervals()) {
+        Entry entry;
+        int len = region.second - region.first;
+        entry.offset = sec->getOffset() + region.first;
+        entry.newData = data.mid(region.first, len);
+        entry.oldData = original.mid(region.first, len);
+        if (entry.oldData.size() != entry.newData.size()) {
+          return nullptr;
+        }
+
+        // Edits that were undone leave the bytes as they were.
+        if (entry.oldData != entry.newData) {
+          entries << entry;
+        }
+      }
+    }
+  }
+
+  bool ok;
+  auto patch = PatchPtr(new Patch);
+  patch->entries = coalesce(entries);
+  patch->checksum = fileChecksum(fmt->getFile(), &ok);
+  if (!ok) {
+    return nullptr;
+  }
+  return patch;
+}
+
+PatchPtr Patch::load(const QString &file) {
+  QFile f(file);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return nullptr;
+  }
+
+  QDataStream stream(&f);
+  stream.setVersion(QDataStream::Qt_5_0);
+  quint32 magic, version, count;
+  auto patch = PatchPtr(new Patch);
+  stream >> magic >> version >> patch->checksum >> count;
+  if (stream.status() != QDataStream::Ok || magic != MAGIC ||
+      version != VERSION) {
+    return nullptr;
+  }
+
+  QList<Entry> entries;
+  for (quint32 i = 0; i < count; i++) {
+    Entry entry;
+    stream >> entry.offset >> entry.oldData >> entry.newData;
+    if (stream.status() != QDataStream::Ok ||
+        entry.oldData.size() != entry.newData.size()) {
+      return nullptr;
+    }
+    entries << entry;
+  }
+  patch->entries = coalesce(entries);
+  return patch;
+}
+
+bool Patch::save(const QString &file) const {
+  QFile f(file);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+
+  QDataStream stream(&f);
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << MAGIC << VERSION << checksum << (quint32) entries.size();
+  foreach (const auto &entry, entries) {
+    stream << entry.offset << entry.oldData << entry.newData;
+  }
+  return stream.status() == QDataStream::Ok;
+}
+
+Patch::Result Patch::apply(const QString &target) const {
+  QFile f(target);
+  if (!f.open(QIODevice::ReadWrite)) {
+    return Result::Error;
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  if (!hash.addData(&f)) {
+    return Result::Error;
+  }
+  bool sameTarget = (hash.result() == checksum);
+
+  // Mapping the file makes each coalesced run a single copy. Otherwise
+  // fall back to seeking.
+  quint64 size = f.size();
+  uchar *map = f.map(0, size);
+
+  bool allOld{true}, allNew{true};
+  foreach (const auto &entry, entries) {
+    int len = entry.newData.size();
+    if (entry.offset + len > size) {
+      return Result::Mismatch;
+    }
+
+    QByteArray cur;
+    if (map) {
+      cur = QByteArray::fromRawData((const char*) map + entry.offset, len);
+    }
+    else {
+      f.seek(entry.offset);
+      cur = f.read(len);
+    }
+    allOld = allOld && (cur == entry.oldData);
+    allNew = allNew && (cur == entry.newData);
+  }
+  if (!allOld) {
+    return (allNew ? Result::AlreadyApplied : Result::Mismatch);
+  }
+
+  foreach (const auto &entry, entries) {
+    const QByteArray &data = entry.newData;
+    if (map) {
+      memcpy(map + entry.offset, data.constData(), data.size());
+    }
+    else if (!f.seek(entry.offset) || f.write(data) != data.size()) {
+      return Result::Error;
+    }
+  }
+  if (map) {
+    f.unmap(map);
+  }
+  return (sameTarget ? Result::AppliedToOriginal : Result::AppliedToOther);
+}
+
+QList<Patch::Result> Patch::applyAll(const QStringList &targets) const {
+  QVector<Job> jobs;
+  foreach (const auto &target, targets) {
+    Job job;
+    job.target = target;
+    job.result = Result::Error;
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [this](Job &job) {
+      job.result = apply(job.target);
+    });
+
+  QList<Result> res;
+  foreach (const auto &job, jobs) {
+    res << job.result;
+  }
+  return res;
+}
+
+QByteArray Patch::fileChecksum(const QString &file, bool *ok) {
+  QFile f(file);
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  bool res = f.open(QIODevice::ReadOnly) && hash.addData(&f);
+  if (ok) *ok = res;
+  return (res ? hash.result() : QByteArray());
+}
@@ -0,0 +1,72 @@
+#ifndef BMOD_PATCH_H
+#define BMOD_PATCH_H
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+
+#include <memory>
+
+#include "formats/Format.h"
+
+class Patch;
+typedef std::shared_ptr<Patch> PatchPtr;
+
+/**
+ * Portable set of byte changes to a file.
+ *
+ * Each entry holds the file offset with the expected old bytes and the
+ * new bytes. The SHA-256 of the original target is stored too, but a
+ * patch also applies to other targets (like other build variants) as
+ * long as all old bytes match.
+ */
+class Patch {
+public:
+  struct Entry {
+    quint64 offset;
+    QByteArray oldData, newData;
+  };
+
+  enum class Result : int {
+    AppliedToOriginal, // Checksum and all old bytes matched.
+    AppliedToOther, // Checksum differs but all old bytes matched.
+    AlreadyApplied,
+    Mismatch,
+    Error
+  };
+
+  /**
+   * Collect the uncommitted modifications of all objects of the format.
+   * The old bytes are those the sections had before they were edited.
+   */
+  static PatchPtr fromFormat(FormatPtr fmt);
+
+  static PatchPtr load(const QString &file);
+  bool save(const QString &file) const;
+
+  const QList<Entry> &getEntries() const { return entries; }
+  const QByteArray &getChecksum() const { return checksum; }
+
+  /**
+   * Verify and apply the patch to the target. Entries are sorted and
+   * adjacent ones coalesced so each run is written once.
+   */
+  Result apply(const QString &target) const;
+
+  /**
+   * Apply to all targets in parallel. Results are in target order.
+   */
+  QList<Result> applyAll(const QStringList &targets) const;
+
+  /**
+   * SHA-256 of the file contents.
+   */
+  static QByteArray fileChecksum(const QString &file, bool *ok = nullptr);
+
+private:
+  QList<Entry> entries; // Sorted by offset and not overlapping.
+  QByteArray checksum;
+};
+
+#endif // BMOD_PATCH_H
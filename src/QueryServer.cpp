@@ -0,0 +1,267 @@
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+#include "Util.h"
+#include "BytePattern.h"
+#include "QueryServer.h"
+#include "analysis/XrefIndex.h"
+
+namespace {
+  // Longest request line kept while waiting for its newline.
+  const qint64 MAX_LINE{1024 * 1024};
+
+  /**
+   * Whether the name refers to a socket left by a server that is gone.
+   * Anything else at the path is not touched.
+   */
+  bool isStaleSocket(const QString &name) {
+#ifdef Q_OS_UNIX
+    // Relative names are put in the temporary directory like
+    // QLocalServer does.
+    QString path = (name.startsWith('/') ? name
+                    : QDir::cleanPath(QDir::tempPath()) + '/' + name);
+    struct stat st;
+    if (lstat(QFile::encodeName(path).constData(), &st) != 0 ||
+        !S_ISSOCK(st.st_mode)) {
+      return false;
+    }
+#endif
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    return !socket.waitForConnected(100);
+  }
+
+  QString addrString(quint64 addr) {
+    return QString::number(addr, 16).toUpper();
+  }
+
+  bool getAddress(const QJsonObject &req, quint64 &addr) {
+    bool ok;
+    addr = req.value("address").toString().toULongLong(&ok, 16);
+    return ok;
+  }
+
+  QJsonObject error(const QString &msg) {
+    QJsonObject res;
+    res.insert("ok", false);
+    res.insert("error", msg);
+    return res;
+  }
+}
+
+QueryServer::QueryServer(quint64 budget, QObject *parent)
+  : QObject(parent), cache{budget}
+{
+  server = new QLocalServer(this);
+  connect(server, &QLocalServer::newConnection,
+          this, &QueryServer::onNewConnection);
+}
+
+bool QueryServer::listen(const QString &name) {
+  if (isStaleSocket(name)) {
+    QLocalServer::removeServer(name);
+  }
+
+  // Only the user may query since the server reads any file it can.
+  server->setSocketOptions(QLocalServer::UserAccessOption);
+  return server->listen(name);
+}
+
+QString QueryServer::errorString() const {
+  return server->errorString();
+}
+
+void QueryServer::onNewConnection() {
+  QLocalSocket *socket;
+  while ((socket = server->nextPendingConnection())) {
+    connect(socket, &QLocalSocket::readyRead,
+            this, &QueryServer::onReadyRead);
+    connect(socket, &QLocalSocket::disconnected,
+            socket, &QLocalSocket::deleteLater);
+  }
+}
+
+void QueryServer::onReadyRead() {
+  auto *socket = qobject_cast<QLocalSocket*>(sender());
+  if (!socket) return;
+
+  while (socket->canReadLine()) {
+    QByteArray line = socket->readLine().trimmed();
+    if (line.isEmpty()) continue;
+
+    QJsonParseError parseError;
+    auto doc = QJsonDocument::fromJson(line, &parseError);
+    QJsonDocument reply;
+    if (doc.isArray()) {
+      QJsonArray replies;
+      foreach (const auto &req, doc.array()) {
+        replies.append(handle(req.toObject()));
+      }
+      reply = QJsonDocument(replies);
+    }
+    else if (doc.isObject()) {
+      reply = QJsonDocument(handle(doc.object()));
+    }
+    else {
+      reply = QJsonDocument(error(tr("Invalid request: %1")
+                                  .arg(parseError.errorString())));
+    }
+    QByteArray data = reply.toJson(QJsonDocument::Compact);
+    data += '\n';
+    socket->write(data);
+  }
+
+  if (socket->bytesAvailable() > MAX_LINE) {
+    QByteArray data = QJsonDocument(error(tr("Request too long")))
+      .toJson(QJsonDocument::Compact);
+    data += '\n';
+    socket->write(data);
+    socket->disconnectFromServer();
+  }
+}
+
+QJsonObject QueryServer::handle(const QJsonObject &req) {
+  QJsonObject res;
+  QString op = req.value("op").toString();
+  if (op == "stats") {
+    res.insert("binaries", cache.getCount());
+    res.insert("usage", (qint64) cache.getUsage());
+    res.insert("budget", (qint64) cache.getBudget());
+  }
+  else {
+    QString err;
+    auto obj = cache.getObject(req.value("file").toString(),
+                               req.value("arch").toString(), err);
+    if (!obj) {
+      res = error(err);
+    }
+    else if (op == "symbol") {
+      res = symbol(obj, req);
+    }
+    else if (op == "disassemble") {
+      res = disassemble(obj, req);
+    }
+    else if (op == "search") {
+      res = search(obj, req);
+    }
+    else if (op == "xrefs") {
+      res = xrefs(obj, req);
+    }
+    else {
+      res = error(tr("Unknown operation: %1").arg(op));
+    }
+  }
+
+  if (!res.contains("ok")) {
+    res.insert("ok", true);
+  }
+  if (req.contains("id")) {
+    res.insert("id", req.value("id"));
+  }
+  return res;
+}
+
+QJsonObject QueryServer::symbol(BinaryCache::ObjectPtr obj,
+                                const QJsonObject &req) {
+  QJsonObject res;
+  if (req.contains("name")) {
+    quint64 addr;
+    if (!cache.lookupSymbol(obj, req.value("name").toString(), addr)) {
+      return error(tr("No such symbol"));
+    }
+    res.insert("address", addrString(addr));
+    return res;
+  }
+
+  quint64 addr;
+  QString name;
+  if (!getAddress(req, addr)) {
+    return error(tr("Expected a name or an address"));
+  }
+  if (!obj->obj->getSymbolTable().getString(addr, name) &&
+      !obj->obj->getDynSymbolTable().getString(addr, name)) {
+    return error(tr("No symbol at address"));
+  }
+  res.insert("name", name);
+  return res;
+}
+
+QJsonObject QueryServer::disassemble(BinaryCache::ObjectPtr obj,
+                                     const QJsonObject &req) {
+  quint64 addr;
+  if (!getAddress(req, addr)) {
+    return error(tr("Expected an address"));
+  }
+  int idx = cache.findLine(obj, addr);
+  if (idx == -1) {
+    return error(tr("Address is not in the code"));
+  }
+
+  const auto &disasm = obj->disasm;
+  int count = qMax(1, req.value("count").toInt(1)),
+    end = qMin(disasm.asmLines.size(), idx + count);
+  QJsonArray lines;
+  for (int i = idx; i < end; i++) {
+    QJsonObject line;
+    line.insert("address", addrString(obj->lineAddrs[i]));
+    line.insert("size", disasm.bytesConsumed[i]);
+    line.insert("text", disasm.asmLines[i]);
+    lines.append(line);
+  }
+
+  QJsonObject res;
+  res.insert("lines", lines);
+  return res;
+}
+
+QJsonObject QueryServer::search(BinaryCache::ObjectPtr obj,
+                                const QJsonObject &req) {
+  bool ok;
+  BytePattern pattern(req.value("pattern").toString(), &ok);
+  if (!ok) {
+    return error(tr("Invalid pattern"));
+  }
+
+  auto secs = obj->obj->getSections();
+  auto matches = pattern.findAll(secs);
+  int limit = req.value("limit").toInt(1000);
+  QJsonArray addrs;
+  for (int i = 0; i < secs.size() && addrs.size() < limit; i++) {
+    foreach (int pos, matches[i]) {
+      if (addrs.size() == limit) break;
+      addrs.append(addrString(secs[i]->getAddress() + pos));
+    }
+  }
+
+  QJsonObject res;
+  res.insert("matches", addrs);
+  return res;
+}
+
+QJsonObject QueryServer::xrefs(BinaryCache::ObjectPtr obj,
+                               const QJsonObject &req) {
+  quint64 addr;
+  if (!getAddress(req, addr)) {
+    return error(tr("Expected an address"));
+  }
+
+  QJsonArray refs;
+  foreach (const auto &ref, cache.getXrefIndex(obj)->getReferences(addr)) {
+    QJsonObject entry;
+    entry.insert("from", addrString(ref.from));
+    entry.insert("type", Util::referenceTypeString(ref.type));
+    refs.append(entry);
+  }
+
+  QJsonObject res;
+  res.insert("references", refs);
+  return res;
+}
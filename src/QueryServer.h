@@ -0,0 +1,63 @@
+#ifndef BMOD_QUERY_SERVER_H
+#define BMOD_QUERY_SERVER_H
+
+#include <QObject>
+#include <QJsonObject>
+
+#include "BinaryCache.h"
+
+class QLocalServer;
+
+/**
+ * Headless analysis service answering queries on a local socket while
+ * keeping the parsed binaries resident.
+ *
+ * Each request is a line of JSON: an object, or an array of objects to
+ * batch several queries, answered by one line with the response object
+ * or array in the same order. A request has an "op", the "file" and
+ * optionally the "arch" and an "id" that is echoed back. Addresses are
+ * hexadecimal strings.
+ *
+ *   {"op": "symbol", "name": "_main"}      -> {"address": "100000F50"}
+ *   {"op": "symbol", "address": "F50"}     -> {"name": "_main"}
+ *   {"op": "disassemble", "address": "F50", "count": 20}
+ *                                          -> {"lines": [{"address", "size", "text"}]}
+ *   {"op": "search", "pattern": "E8 ?? ?? ?? ??", "limit": 100}
+ *                                          -> {"matches": ["100000F54", ..]}
+ *   {"op": "xrefs", "address": "F50"}      -> {"references": [{"from", "type"}]}
+ *   {"op": "stats"}                        -> {"binaries", "usage", "budget"}
+ *
+ * Responses have "ok" set to false and an "error" if the query failed.
+ * Connections sending a line longer than 1 MiB are closed.
+ */
+class QueryServer : public QObject {
+  Q_OBJECT
+
+public:
+  QueryServer(quint64 budget, QObject *parent = nullptr);
+
+  /**
+   * Start listening on the socket name or path, only accessible by the
+   * user. A stale socket left by a previous server is replaced, but
+   * nothing else at the path is.
+   */
+  bool listen(const QString &name);
+  QString errorString() const;
+
+private slots:
+  void onNewConnection();
+  void onReadyRead();
+
+private:
+  QJsonObject handle(const QJsonObject &req);
+
+  QJsonObject symbol(BinaryCache::ObjectPtr obj, const QJsonObject &req);
+  QJsonObject disassemble(BinaryCache::ObjectPtr obj, const QJsonObject &req);
+  QJsonObject search(BinaryCache::ObjectPtr obj, const QJsonObject &req);
+  QJsonObject xrefs(BinaryCache::ObjectPtr obj, const QJsonObject &req);
+
+  QLocalServer *server;
+  BinaryCache cache;
+};
+
+#endif // BMOD_QUERY_SERVER_H
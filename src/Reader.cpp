@@ -74,6 +74,13 @@ bool Reader::peekList(std::initializer_list<unsigned char> list) {
   return true;
 }
 
+bool Reader::peekList(const QByteArray &list) {
+  if (list.isEmpty()) {
+    return false;
+  }
+  return dev.peek(list.size()) == list;
+}
+
 template <typename T>
 T Reader::getUInt(bool *ok) {
   constexpr int num = sizeof(T);
@@ -33,6 +33,7 @@ public:
   bool atEnd() const;
 
   bool peekList(std::initializer_list<unsigned char> list);
+  bool peekList(const QByteArray &list);
 
 private:
   template <typename T>
@@ -0,0 +1,22 @@
+#include <algorithm>
+
+#include "RelocationTable.h"
+
+void RelocationTable::sort() {
+  std::stable_sort(relocs.begin(), relocs.end(),
+                   [](const Relocation &a, const Relocation &b) {
+                     return a.offset < b.offset;
+                   });
+}
+
+const RelocationTable::Relocation *RelocationTable::find(quint64 start,
+                                                         quint64 end) const {
+  auto it = std::lower_bound(relocs.constBegin(), relocs.constEnd(), start,
+                             [](const Relocation &reloc, quint64 value) {
+                               return reloc.offset < value;
+                             });
+  if (it == relocs.constEnd() || it->offset >= end) {
+    return nullptr;
+  }
+  return &*it;
+}
@@ -0,0 +1,49 @@
+#ifndef BMOD_RELOCATION_TABLE_H
+#define BMOD_RELOCATION_TABLE_H
+
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+class RelocationTable;
+typedef std::shared_ptr<RelocationTable> RelocationTablePtr;
+
+/**
+ * Relocation entries of a section sorted by the offset they patch, so
+ * the entry of an instruction is found in logarithmic time.
+ */
+class RelocationTable {
+public:
+  struct Relocation {
+    quint32 offset; // Relative to the section.
+    quint32 symbolNum; // Symbol table index if external.
+    quint64 value; // Target address if resolved.
+    quint8 length; // Log2 of the size of the patched field.
+    quint8 type;
+    bool pcRel, external, scattered;
+    bool resolved; // Scattered or the external symbol is defined here.
+    QString symbol; // Resolved name, if any.
+  };
+
+  void addRelocation(const Relocation &reloc) { relocs << reloc; }
+
+  /**
+   * Sort the entries by offset, which must be done after adding them.
+   */
+  void sort();
+
+  int size() const { return relocs.size(); }
+  QVector<Relocation> &getRelocations() { return relocs; }
+  const QVector<Relocation> &getRelocations() const { return relocs; }
+
+  /**
+   * First entry patching the range [start, end) of the section, or null.
+   */
+  const Relocation *find(quint64 start, quint64 end) const;
+
+private:
+  QVector<Relocation> relocs;
+};
+
+#endif // BMOD_RELOCATION_TABLE_H
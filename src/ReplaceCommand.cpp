@@ -0,0 +1,19 @@
+#include "ReplaceCommand.h"
+
+ReplaceCommand::ReplaceCommand(const QList<Edit> &edits, const QString &text)
+  : QUndoCommand(text), edits{edits}
+{ }
+
+void ReplaceCommand::undo() {
+  // Restore in reverse order in case edits overlap.
+  for (int i = edits.size() - 1; i >= 0; i--) {
+    const auto &edit = edits[i];
+    edit.sec->setSubData(edit.oldData, edit.pos);
+  }
+}
+
+void ReplaceCommand::redo() {
+  foreach (const auto &edit, edits) {
+    edit.sec->setSubData(edit.newData, edit.pos);
+  }
+}
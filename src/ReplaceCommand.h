@@ -0,0 +1,32 @@
+#ifndef BMOD_REPLACE_COMMAND_H
+#define BMOD_REPLACE_COMMAND_H
+
+#include <QList>
+#include <QByteArray>
+#include <QUndoCommand>
+
+#include "Section.h"
+
+/**
+ * Batch of in-place section edits that is undone and redone as one step.
+ */
+class ReplaceCommand : public QUndoCommand {
+public:
+  struct Edit {
+    SectionPtr sec;
+    int pos;
+    QByteArray oldData, newData;
+  };
+
+  ReplaceCommand(const QList<Edit> &edits, const QString &text);
+
+  void undo();
+  void redo();
+
+  const QList<Edit> &getEdits() const { return edits; }
+
+private:
+  QList<Edit> edits;
+};
+
+#endif // BMOD_REPLACE_COMMAND_H
@@ -1,23 +1,129 @@
 #include "Section.h"
 
 Section::Section(SectionType type, const QString &name, quint64 addr,
-                 quint64 size, quint32 offset)
-  : type{type}, name{name}, addr{addr}, size{size}, offset{offset}
+                 quint64 size, quint64 offset)
+  : type{type}, name{name}, addr{addr}, size{size}, offset{offset},
+  version{0}, stored{false}
 { }
 
+Section::~Section() {
+  if (stored) {
+    SectionStore::release(storeKey);
+  }
+}
+
+void Section::setData(const QByteArray &data) {
+  if (stored) {
+    SectionStore::release(storeKey);
+  }
+  publish(SectionStore::intern(data, storeKey, &stored), nullptr);
+  original = this->data;
+  digest = Checksum::Digest();
+}
+
+void Section::setMappedData(MappedFilePtr file) {
+  if (stored) {
+    SectionStore::release(storeKey);
+    stored = false;
+  }
+  publish(file->getData(offset, size), file);
+  original = data;
+  digest = Checksum::Digest();
+}
+
 void Section::setSubData(const QByteArray &subData, int pos) {
   if (pos < 0 || pos > data.size() - 1) {
     return;
   }
-  data.replace(pos, subData.size(), subData);
+  // The shared buffer is copied on this first write.
+  if (stored) {
+    SectionStore::release(storeKey);
+    stored = false;
+  }
+  {
+    // Snapshots keep the buffer they pinned since the replacement
+    // detaches from it.
+    QMutexLocker locker(&dataMutex);
+    data.replace(pos, subData.size(), subData);
+    version++;
+  }
   modified = QDateTime::currentDateTime();
+  digest = Checksum::Digest();
 
   QPair<int, int> region(pos, subData.size());
   if (!modifiedRegions.contains(region)) {
     modifiedRegions << region;
   }
+  emit dataChanged(pos, qMin(subData.size(), data.size() - pos));
+}
+
+QList<QPair<int, int>> Section::rebase(SectionPtr other,
+                                      const IntervalSet &changed) {
+  QByteArray local = data;
+  if (other->mapped) {
+    setMappedData(other->mapped);
+  }
+  else {
+    setData(other->data);
+  }
+
+  QList<QPair<int, int>> conflicts;
+  if (modifiedRegions.isEmpty()) {
+    return conflicts;
+  }
+
+  // The edits detach the buffer from the store as in setSubData().
+  if (stored) {
+    SectionStore::release(storeKey);
+    stored = false;
+  }
+  QByteArray rebased = data;
+  foreach (const auto &region, modifiedRegions) {
+    QByteArray edit = local.mid(region.first, region.second);
+    if (changed.intersects(region.first, region.second) &&
+        rebased.mid(region.first, region.second) != edit) {
+      conflicts << region;
+    }
+    rebased.replace(region.first, edit.size(), edit);
+  }
+  publish(rebased, nullptr);
+  return conflicts;
+}
+
+Section::Snapshot Section::getSnapshot() const {
+  QMutexLocker locker(&dataMutex);
+  Snapshot snap;
+  snap.data = data;
+  snap.version = version;
+  snap.file = mapped;
+  return snap;
+}
+
+quint64 Section::getVersion() const {
+  QMutexLocker locker(&dataMutex);
+  return version;
+}
+
+void Section::setCommitted() {
+  modifiedRegions.clear();
+  original = data;
 }
 
 const QList<QPair<int, int>> &Section::getModifiedRegions() const {
   return modifiedRegions;
 }
+
+void Section::publish(const QByteArray &data, MappedFilePtr file) {
+  {
+    QMutexLocker locker(&dataMutex);
+    this->data = data;
+    mapped = file;
+    version++;
+  }
+  emit dataChanged(0, data.size());
+}
+
+void Section::setDiffRegions(const IntervalSet &regions) {
+  diffRegions = regions;
+  diffed = QDateTime::currentDateTime();
+}
@@ -3,6 +3,8 @@
 
 #include <QList>
 #include <QPair>
+#include <QMutex>
+#include <QObject>
 #include <QString>
 #include <QDateTime>
 #include <QByteArray>
@@ -10,37 +12,148 @@
 #include <memory>
 
 #include "SectionType.h"
+#include "Checksum.h"
+#include "IntervalSet.h"
+#include "MappedFile.h"
+#include "SectionStore.h"
+#include "RelocationTable.h"
 
 class Section;
 typedef std::shared_ptr<Section> SectionPtr;
 
-class Section {
+/**
+ * Named range of an object and its data. Views of the data listen to
+ * dataChanged() to update only what an edit touched.
+ */
+class Section : public QObject {
+  Q_OBJECT
+
 public:
   Section(SectionType type, const QString &name, quint64 addr, quint64 size,
-          quint32 offset = 0);
+          quint64 offset = 0);
+  ~Section();
+
+  Section(const Section &other) = delete;
+  Section &operator=(const Section &other) = delete;
 
   SectionType getType() const { return type; }
   QString getName() const { return name; }
   quint64 getAddress() const { return addr; }
   quint64 getSize() const { return size; }
-  quint32 getOffset() const { return offset; }
+  quint64 getOffset() const { return offset; }
 
+  /**
+   * The data for the thread that edits the section. Other threads must
+   * use a snapshot.
+   */
   const QByteArray &getData() const { return data; }
-  void setData(const QByteArray &data) { this->data = data; }
+
+  /**
+   * The data is shared with other sections of identical content until
+   * it is modified.
+   */
+  void setData(const QByteArray &data);
+
+  /**
+   * Use data of the mapped file directly instead of a copy. It is not
+   * shared through the store since the mapping is shared already.
+   */
+  void setMappedData(MappedFilePtr file);
 
   void setSubData(const QByteArray &subData, int pos);
+
+  /**
+   * Data pinned for reading from any thread. Mapped data refers to the
+   * file which is held too, so the data is valid as long as the snapshot
+   * is kept.
+   */
+  struct Snapshot {
+    QByteArray data;
+    quint64 version;
+    MappedFilePtr file;
+  };
+
+  /**
+   * The current data pinned for reading from any thread. Later edits
+   * publish a new version instead of changing it, so taking one only
+   * costs a reference while it is not edited.
+   */
+  Snapshot getSnapshot() const;
+
+  /**
+   * Number of changes of the data so far.
+   */
+  quint64 getVersion() const;
+
+  /**
+   * Take the data of the same section parsed again after the file
+   * changed, keeping the modified regions on top. Returns the modified
+   * regions that overlap the changed bytes (relative to the section) and
+   * differ from the new data; the local edit is kept in those too.
+   */
+  QList<QPair<int, int>> rebase(SectionPtr other, const IntervalSet &changed);
   bool isModified() const { return !modifiedRegions.isEmpty(); }
+
+  /**
+   * The data was written to the file so it has no modified regions
+   * anymore and is the original data.
+   */
+  void setCommitted();
+
   QDateTime modifiedWhen() const { return modified; }
   const QList<QPair<int, int>> &getModifiedRegions() const;
 
+  /**
+   * The data as it is in the file, without the modified regions.
+   */
+  const QByteArray &getOriginalData() const { return original; }
+
+  /**
+   * Byte ranges (relative to the section) that differ from the section
+   * it was last compared against.
+   */
+  void setDiffRegions(const IntervalSet &regions);
+  const IntervalSet &getDiffRegions() const { return diffRegions; }
+  bool isDiffed() const { return !diffRegions.isEmpty(); }
+  QDateTime diffedWhen() const { return diffed; }
+
+  /**
+   * Digest of the data, or a null one if it changed since it was set.
+   */
+  Checksum::Digest getDigest() const { return digest; }
+  void setDigest(const Checksum::Digest &digest) { this->digest = digest; }
+
+  /**
+   * Relocation entries of object files, or null if there are none.
+   */
+  RelocationTablePtr getRelocations() const { return relocs; }
+  void setRelocations(RelocationTablePtr relocs) { this->relocs = relocs; }
+
+signals:
+  /**
+   * The bytes of the range (relative to the section) were changed. All
+   * of them are reported when the data is replaced.
+   */
+  void dataChanged(int pos, int size);
+
 private:
+  void publish(const QByteArray &data, MappedFilePtr file);
+
   SectionType type;
   QString name;
-  quint64 addr, size;
-  quint32 offset;
-  QByteArray data;
+  quint64 addr, size, offset;
+  QByteArray data, original;
+  mutable QMutex dataMutex; // Guards data, version and mapped for snapshots.
+  quint64 version;
+  SectionStore::Key storeKey;
+  bool stored;
+  MappedFilePtr mapped;
   QList<QPair<int, int>> modifiedRegions;
   QDateTime modified;
+  IntervalSet diffRegions;
+  QDateTime diffed;
+  Checksum::Digest digest;
+  RelocationTablePtr relocs;
 };
 
 #endif // BMOD_SECTION_H
@@ -0,0 +1,68 @@
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "Checksum.h"
+#include "SectionStore.h"
+
+namespace {
+  struct Entry {
+    QByteArray data;
+    int refs;
+  };
+
+  QHash<SectionStore::Key, Entry> entries;
+  qint64 totalSize{0};
+  QMutex mutex;
+}
+
+QByteArray SectionStore::intern(const QByteArray &data, Key &key,
+                                bool *interned) {
+  *interned = false;
+  if (data.isEmpty()) {
+    return data;
+  }
+
+  key = Key(Checksum::xxh64(data.constData(), data.size()), data.size());
+  QMutexLocker locker(&mutex);
+  auto it = entries.find(key);
+  if (it == entries.end()) {
+    Entry entry;
+    entry.data = data;
+    entry.refs = 1;
+    entries.insert(key, entry);
+    totalSize += data.size();
+    *interned = true;
+    return data;
+  }
+
+  // Colliding contents are simply not shared.
+  if (it->data != data) {
+    return data;
+  }
+  it->refs++;
+  *interned = true;
+  return it->data;
+}
+
+void SectionStore::release(const Key &key) {
+  QMutexLocker locker(&mutex);
+  auto it = entries.find(key);
+  if (it == entries.end()) {
+    return;
+  }
+  if (--it->refs == 0) {
+    totalSize -= it->data.size();
+    entries.erase(it);
+  }
+}
+
+int SectionStore::getCount() {
+  QMutexLocker locker(&mutex);
+  return entries.size();
+}
+
+qint64 SectionStore::getTotalSize() {
+  QMutexLocker locker(&mutex);
+  return totalSize;
+}
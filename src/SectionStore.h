@@ -0,0 +1,33 @@
+#ifndef BMOD_SECTION_STORE_H
+#define BMOD_SECTION_STORE_H
+
+#include <QPair>
+#include <QByteArray>
+
+/**
+ * Process-wide store of section buffers keyed by content.
+ *
+ * Sections with identical data, like the same section in a fat binary
+ * and its thin slice or in adjacent builds, share one implicitly shared
+ * buffer. Writing to a section detaches its copy as usual.
+ */
+class SectionStore {
+public:
+  typedef QPair<quint64, int> Key; // XXH64 and size.
+
+  /**
+   * Buffer equal to the data which is shared if it was seen before. The
+   * key to release it with is set if the buffer was interned.
+   */
+  static QByteArray intern(const QByteArray &data, Key &key, bool *interned);
+
+  /**
+   * Release a reference so the buffer is dropped when unused.
+   */
+  static void release(const Key &key);
+
+  static int getCount();
+  static qint64 getTotalSize();
+};
+
+#endif // BMOD_SECTION_STORE_H
@@ -10,6 +10,9 @@ enum class SectionType : int {
   String, // String table constants.
   FuncStarts, // Function starts.
   CodeSig, // Code signature.
+  Memory, // Memory of a core dump.
+  Debug, // DWARF debug information (__debug_*, .debug_*).
+  ObjC, // Objective-C metadata lists (__objc_classlist, ..).
 };
 
 #endif // BMOD_SECTION_TYPE_H
@@ -0,0 +1,249 @@
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+#include "StringScanner.h"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define BMOD_STRINGS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+  // Chunks are kept even so UTF-16 units never straddle two of them.
+  const quint64 CHUNK_SIZE{1 << 20};
+
+  typedef StringScanner::Match Match;
+  typedef StringScanner::Encoding Encoding;
+
+  struct Job {
+    quint64 begin, end;
+    QVector<Match> matches;
+  };
+
+  /**
+   * Bytes that can never be part of a string: control characters other
+   * than tab and line breaks, and bytes that are invalid in UTF-8.
+   */
+  struct BreakTable {
+    BreakTable() {
+      for (int c = 0; c < 256; c++) {
+        table[c] = (c < 0x20 && c != '\t' && c != '\n' && c != '\r') ||
+          c == 0x7F || c == 0xC0 || c == 0xC1 || c >= 0xF5;
+      }
+    }
+
+    bool table[256];
+  };
+
+  const BreakTable breaks;
+
+  inline bool isBreak(uchar c) {
+    return breaks.table[c];
+  }
+
+#ifdef BMOD_STRINGS_SSE2
+  /**
+   * Bit mask of the break bytes of 16 bytes of data.
+   */
+  inline quint32 breakMask(const uchar *data) {
+    __m128i v = _mm_loadu_si128((const __m128i*) data);
+
+    // Signed compares of the bytes with the top bit flipped order them
+    // as unsigned.
+    __m128i s = _mm_xor_si128(v, _mm_set1_epi8((char) 0x80));
+    __m128i ctrl = _mm_cmplt_epi8(s, _mm_set1_epi8((char) (0x20 ^ 0x80)));
+    __m128i space =
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')),
+                   _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    __m128i res = _mm_andnot_si128(space, ctrl);
+    res = _mm_or_si128(res, _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+    res = _mm_or_si128(res, _mm_cmpeq_epi8(v, _mm_set1_epi8((char) 0xC0)));
+    res = _mm_or_si128(res, _mm_cmpeq_epi8(v, _mm_set1_epi8((char) 0xC1)));
+    res = _mm_or_si128(res, _mm_cmpgt_epi8(s, _mm_set1_epi8((char) (0xF4 ^ 0x80))));
+    return _mm_movemask_epi8(res);
+  }
+#endif
+
+  /**
+   * Position of the first byte from pos that is a break byte, or not if
+   * brk is false. Returns len if there is none.
+   */
+  quint64 findBreak(const uchar *data, quint64 pos, quint64 len, bool brk) {
+#ifdef BMOD_STRINGS_SSE2
+    while (pos + 16 <= len) {
+      quint32 mask = breakMask(data + pos);
+      if (!brk) {
+        mask = ~mask & 0xFFFF;
+      }
+      if (mask) {
+        return pos + __builtin_ctz(mask);
+      }
+      pos += 16;
+    }
+#endif
+    while (pos < len && isBreak(data[pos]) != brk) {
+      pos++;
+    }
+    return pos;
+  }
+
+  /**
+   * Adds the valid UTF-8 parts of the run of non-break bytes.
+   */
+  void addRun(const uchar *data, quint64 start, quint64 end, int minLength,
+              QVector<Match> &matches) {
+    quint64 begin{start};
+    int chars{0};
+    bool multi{false};
+    auto add = [&](quint64 pos) {
+      if (chars >= minLength) {
+        matches << Match{begin, quint32(pos - begin),
+            multi ? Encoding::Utf8 : Encoding::Ascii};
+      }
+    };
+
+    quint64 pos{start};
+    while (pos < end) {
+      uchar c = data[pos];
+      int len = (c < 0x80 ? 1 : c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC2 ? 2 : 0);
+      bool valid = (len > 0 && pos + len <= end);
+      for (int i = 1; valid && i < len; i++) {
+        valid = ((data[pos + i] & 0xC0) == 0x80);
+      }
+
+      // Reject overlong forms, surrogates and code points above U+10FFFF.
+      if (valid && len > 2) {
+        uchar next = data[pos + 1];
+        valid = !((c == 0xE0 && next < 0xA0) || (c == 0xED && next >= 0xA0) ||
+                  (c == 0xF0 && next < 0x90) || (c == 0xF4 && next >= 0x90));
+      }
+
+      if (!valid) {
+        add(pos);
+        pos++;
+        begin = pos;
+        chars = 0;
+        multi = false;
+        continue;
+      }
+      if (len > 1) {
+        multi = true;
+      }
+      chars++;
+      pos += len;
+    }
+    add(end);
+  }
+
+  void scanText(const uchar *data, quint64 len, Job &job, int minLength) {
+    // A run crossing into the chunk belongs to the previous one.
+    quint64 pos = job.begin;
+    if (pos > 0 && !isBreak(data[pos - 1])) {
+      pos = findBreak(data, pos, len, true);
+    }
+
+    while (pos < job.end) {
+      quint64 start = findBreak(data, pos, job.end, false);
+      if (start >= job.end) break;
+      quint64 end = findBreak(data, start, len, true);
+      addRun(data, start, end, minLength, job.matches);
+      pos = end;
+    }
+  }
+
+  inline bool isText16(quint16 unit) {
+    return (unit >= 0x20 && unit < 0x7F) || unit == '\t' || unit == '\n' ||
+      unit == '\r' || (unit >= 0xA0 && unit < 0x180);
+  }
+
+  void scanUtf16(const uchar *data, quint64 len, Job &job, int minLength) {
+    auto unit = [data](quint64 pos) -> quint16 {
+      return data[pos] | (data[pos + 1] << 8);
+    };
+
+    for (int align = 0; align < 2; align++) {
+      quint64 pos = job.begin + align;
+      if (job.begin > 0 && pos + 1 < len && isText16(unit(pos - 2))) {
+        while (pos + 1 < len && isText16(unit(pos))) {
+          pos += 2;
+        }
+      }
+
+      while (pos < job.end && pos + 1 < len) {
+        if (!isText16(unit(pos))) {
+          pos += 2;
+          continue;
+        }
+        quint64 start = pos;
+        while (pos + 1 < len && isText16(unit(pos))) {
+          pos += 2;
+        }
+        if ((pos - start) / 2 >= (quint64) minLength) {
+          job.matches << Match{start, quint32(pos - start), Encoding::Utf16};
+        }
+      }
+    }
+  }
+}
+
+StringScanner::StringScanner(int minLength, bool utf16)
+  : minLength{qMax(minLength, 1)}, utf16{utf16}
+{ }
+
+QVector<StringScanner::Match> StringScanner::scan(const QByteArray &data) const {
+  return scan((const uchar*) data.constData(), data.size());
+}
+
+QVector<StringScanner::Match> StringScanner::scan(const uchar *ptr,
+                                                  quint64 len) const {
+  QVector<Job> jobs;
+  for (quint64 begin = 0; begin < len; begin += CHUNK_SIZE) {
+    Job job;
+    job.begin = begin;
+    job.end = qMin(begin + CHUNK_SIZE, len);
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [this, ptr, len](Job &job) {
+      scanText(ptr, len, job, minLength);
+      if (utf16) {
+        scanUtf16(ptr, len, job, minLength);
+        std::sort(job.matches.begin(), job.matches.end(),
+                  [](const Match &a, const Match &b) {
+                    return a.offset < b.offset;
+                  });
+      }
+    });
+
+  // Chunks own the strings starting in them so the order is kept.
+  QVector<Match> matches;
+  foreach (const auto &job, jobs) {
+    matches += job.matches;
+  }
+  return matches;
+}
+
+QString StringScanner::decode(const QByteArray &data, const Match &match) {
+  return decode((const uchar*) data.constData(), data.size(), match);
+}
+
+QString StringScanner::decode(const uchar *data, quint64 len,
+                              const Match &match) {
+  if (match.offset + match.size > len) {
+    return QString();
+  }
+
+  const char *ptr = (const char*) data + match.offset;
+  if (match.encoding != Encoding::Utf16) {
+    return QString::fromUtf8(ptr, match.size);
+  }
+
+  QString str;
+  str.reserve(match.size / 2);
+  for (quint32 i = 0; i + 1 < match.size; i += 2) {
+    str += QChar(ushort((uchar) ptr[i] | ((uchar) ptr[i + 1] << 8)));
+  }
+  return str;
+}
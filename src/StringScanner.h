@@ -0,0 +1,53 @@
+#ifndef BMOD_STRING_SCANNER_H
+#define BMOD_STRING_SCANNER_H
+
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+
+/**
+ * Finds printable strings in arbitrary data like strings(1): runs of
+ * ASCII or valid UTF-8, and optionally UTF-16LE at both alignments.
+ *
+ * The data is scanned in parallel chunks. A string belongs to the chunk
+ * it starts in and is followed past the end of it, so strings crossing
+ * chunk boundaries are found once and whole.
+ */
+class StringScanner {
+public:
+  enum class Encoding : char {
+    Ascii,
+    Utf8,
+    Utf16
+  };
+
+  struct Match {
+    quint64 offset;
+    quint32 size; // In bytes.
+    Encoding encoding;
+  };
+
+  /**
+   * Minimum length is in characters.
+   */
+  StringScanner(int minLength = 4, bool utf16 = true);
+
+  /**
+   * Matches sorted by offset.
+   */
+  QVector<Match> scan(const QByteArray &data) const;
+
+  /**
+   * Scans a raw range, like a mapping of a file too large for a QByteArray.
+   */
+  QVector<Match> scan(const uchar *data, quint64 len) const;
+
+  static QString decode(const QByteArray &data, const Match &match);
+  static QString decode(const uchar *data, quint64 len, const Match &match);
+
+private:
+  int minLength;
+  bool utf16;
+};
+
+#endif // BMOD_STRING_SCANNER_H
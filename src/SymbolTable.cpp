@@ -1,17 +1,46 @@
 #include "SymbolTable.h"
 
+SymbolTable::SymbolTable(const SymbolTable &other)
+  : entries{other.entries}, indexed{false}
+{ }
+
+SymbolTable &SymbolTable::operator=(const SymbolTable &other) {
+  if (this != &other) {
+    QMutexLocker locker(&indexMutex);
+    entries = other.entries;
+    indexed = false;
+    index.clear();
+  }
+  return *this;
+}
+
 void SymbolTable::addSymbol(const SymbolEntry &entry) {
   entries << entry;
+  indexed = false;
+}
+
+QList<SymbolEntry> &SymbolTable::getSymbols() {
+  indexed = false;
+  return entries;
 }
 
 bool SymbolTable::getString(quint64 value, QString &str) const {
-  foreach (const auto &entry, entries) {
-    if (entry.getValue() == value) {
-      const auto &s  = entry.getString();
-      if (s.isEmpty()) continue;
-      str = s;
-      return true;
+  QMutexLocker locker(&indexMutex);
+  if (!indexed) {
+    index.clear();
+    for (int i = 0; i < entries.size(); i++) {
+      const auto &entry = entries[i];
+      if (!entry.getString().isEmpty() && !index.contains(entry.getValue())) {
+        index[entry.getValue()] = i;
+      }
     }
+    indexed = true;
+  }
+
+  auto it = index.constFind(value);
+  if (it == index.constEnd()) {
+    return false;
   }
-  return false;
+  str = entries[it.value()].getString();
+  return true;
 }
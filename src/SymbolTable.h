@@ -1,7 +1,9 @@
 #ifndef BMOD_SYMBOL_TABLE_H
 #define BMOD_SYMBOL_TABLE_H
 
+#include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QString>
 
 class SymbolEntry {
@@ -27,14 +29,31 @@ private:
 
 class SymbolTable {
 public:
+  SymbolTable() : indexed{false} { }
+  SymbolTable(const SymbolTable &other);
+  SymbolTable &operator=(const SymbolTable &other);
+
   void addSymbol(const SymbolEntry &entry);
-  QList<SymbolEntry> &getSymbols() { return entries; }  
+
+  /**
+   * Entries may be changed through the list so the lookup index is
+   * rebuilt on the next lookup.
+   */
+  QList<SymbolEntry> &getSymbols();
   const QList<SymbolEntry> &getSymbols() const { return entries; }
 
+  /**
+   * String of the first named symbol with the value. The values are
+   * indexed on first lookup.
+   */
   bool getString(quint64 value, QString &str) const;
 
 private:
   QList<SymbolEntry> entries;
+
+  mutable QMutex indexMutex;
+  mutable bool indexed;
+  mutable QHash<quint64, int> index; // Value -> entry.
 };
 
 #endif // BMOD_SYMBOL_TABLE_H
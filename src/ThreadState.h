@@ -0,0 +1,38 @@
+#ifndef BMOD_THREAD_STATE_H
+#define BMOD_THREAD_STATE_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/**
+ * Register values of a thread, like those saved in a core dump.
+ */
+class ThreadState {
+public:
+  void addRegister(const QString &name, quint64 value) {
+    registers << QPair<QString, quint64>(name, value);
+  }
+
+  const QList<QPair<QString, quint64>> &getRegisters() const {
+    return registers;
+  }
+
+  /**
+   * Value of the register, or false if there is no such register.
+   */
+  bool getRegister(const QString &name, quint64 &value) const {
+    foreach (const auto &reg, registers) {
+      if (reg.first == name) {
+        value = reg.second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  QList<QPair<QString, quint64>> registers;
+};
+
+#endif // BMOD_THREAD_STATE_H
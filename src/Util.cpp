@@ -1,4 +1,5 @@
 #include <QDir>
+#include <QColor>
 #include <QWidget>
 #include <QFileInfo>
 #include <QApplication>
@@ -6,12 +7,22 @@
 #include <QTreeWidgetItem>
 
 #include "Util.h"
+#include "AddressSpace.h"
 
 QString Util::formatTypeString(FormatType type) {
   switch (type) {
   default:
   case FormatType::MachO:
     return "Mach-O";
+
+  case FormatType::ELF:
+    return "ELF";
+
+  case FormatType::DyldCache:
+    return "dyld shared cache";
+
+  case FormatType::Archive:
+    return "Archive";
   }
 }
 
@@ -138,6 +149,69 @@ QString Util::sectionTypeString(SectionType type) {
   }
 }
 
+QString Util::referenceTypeString(Reference::Type type) {
+  switch (type) {
+  case Reference::Type::Call:
+    return QObject::tr("Call");
+
+  case Reference::Type::Jump:
+    return QObject::tr("Jump");
+
+  case Reference::Type::CondJump:
+    return QObject::tr("Conditional jump");
+
+  case Reference::Type::CodePointer:
+    return QObject::tr("Code pointer");
+
+  case Reference::Type::DataPointer:
+    return QObject::tr("Data pointer");
+
+  default:
+  case Reference::Type::Data:
+    return QObject::tr("Data");
+  }
+}
+
+QString Util::patchResultString(Patch::Result result) {
+  switch (result) {
+  case Patch::Result::AppliedToOriginal:
+    return QObject::tr("Applied");
+
+  case Patch::Result::AppliedToOther:
+    return QObject::tr("Applied to other file (old bytes matched)");
+
+  case Patch::Result::AlreadyApplied:
+    return QObject::tr("Already applied");
+
+  case Patch::Result::Mismatch:
+    return QObject::tr("Old bytes do not match");
+
+  default:
+  case Patch::Result::Error:
+    return QObject::tr("Could not read or write file");
+  }
+}
+
+QString Util::hashTypeString(CodeSignature::HashType type) {
+  switch (type) {
+  case CodeSignature::HashType::Sha1:
+    return "SHA-1";
+
+  case CodeSignature::HashType::Sha256:
+    return "SHA-256";
+
+  case CodeSignature::HashType::Sha256Truncated:
+    return "SHA-256 (truncated)";
+
+  case CodeSignature::HashType::Sha384:
+    return "SHA-384";
+
+  default:
+  case CodeSignature::HashType::None:
+    return QObject::tr("Unknown");
+  }
+}
+
 void Util::centerWidget(QWidget *widget) {
   widget->move(QApplication::desktop()->screen()->rect().center()
                - widget->rect().center());
@@ -245,6 +319,58 @@ void Util::setTreeItemMarked(QTreeWidgetItem *item, int column) {
   item->setForeground(column, Qt::red);
 }
 
+void Util::setTreeItemDiffed(QTreeWidgetItem *item, int column) {
+  item->setBackground(column, QColor(255, 240, 170));
+}
+
+QString Util::referencesString(const QVector<Reference> &refs, int padSize,
+                               int max) {
+  QStringList lines;
+  for (int i = 0; i < refs.size() && i < max; i++) {
+    const auto &ref = refs[i];
+    lines << QObject::tr("%1 from %2")
+      .arg(referenceTypeString(ref.type))
+      .arg(padString(QString::number(ref.from, 16).toUpper(), padSize));
+  }
+  if (refs.size() > max) {
+    lines << QObject::tr("(%1 more)").arg(refs.size() - max);
+  }
+  return lines.join("\n");
+}
+
+QString Util::functionName(BinaryObjectPtr obj, quint64 addr) {
+  QString name;
+  if (obj->getSymbolTable().getString(addr, name) ||
+      obj->getDynSymbolTable().getString(addr, name)) {
+    return name;
+  }
+  return "sub_" + QString::number(addr, 16).toUpper();
+}
+
+bool Util::fileOffsetToAddress(BinaryObjectPtr obj, quint64 offset,
+                               quint64 &addr) {
+  foreach (const auto sec, obj->getSections()) {
+    if (sec->getType() != SectionType::Memory && sec->getOffset() > 0 &&
+        offset >= sec->getOffset() &&
+        offset - sec->getOffset() < sec->getSize()) {
+      addr = sec->getAddress() + (offset - sec->getOffset());
+      return true;
+    }
+  }
+
+  auto space = obj->getAddressSpace();
+  if (space) {
+    foreach (const auto &mapping, space->getMappings()) {
+      if (offset >= mapping.offset &&
+          offset - mapping.offset < mapping.fileSize) {
+        addr = mapping.addr + (offset - mapping.offset);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 QString Util::addrDataString(quint64 addr, QByteArray data) {
   // Pad data to a multiple of 16.
   quint64 rest = data.size() % 16;
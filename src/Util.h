@@ -2,12 +2,16 @@
 #define BMOD_UTIL_H
 
 #include <QString>
+#include <QVector>
 #include <QByteArray>
 
 #include "Section.h"
 #include "CpuType.h"
 #include "FileType.h"
+#include "Patch.h"
+#include "asm/Disassembler.h"
 #include "formats/FormatType.h"
+#include "formats/CodeSignature.h"
 
 class QWidget;
 class QTreeWidgetItem;
@@ -18,6 +22,9 @@ public:
   static QString cpuTypeString(CpuType type);
   static QString fileTypeString(FileType type);
   static QString sectionTypeString(SectionType type);
+  static QString referenceTypeString(Reference::Type type);
+  static QString patchResultString(Patch::Result result);
+  static QString hashTypeString(CodeSignature::HashType type);
 
   static void centerWidget(QWidget *widget);
   static QString formatSize(qint64 bytes, int digits = 1);
@@ -35,6 +42,25 @@ public:
   static QString resolveAppBinary(const QString &path);
 
   static void setTreeItemMarked(QTreeWidgetItem *item, int column);
+  static void setTreeItemDiffed(QTreeWidgetItem *item, int column);
+
+  /**
+   * List the first max references like "Call from ADDR", one per line.
+   */
+  static QString referencesString(const QVector<Reference> &refs,
+                                  int padSize, int max = 10);
+
+  /**
+   * Symbol name of the function at the address or "sub_ADDR".
+   */
+  static QString functionName(BinaryObjectPtr obj, quint64 addr);
+
+  /**
+   * Address of the byte at the file offset, found by the sections or
+   * the segments of the object.
+   */
+  static bool fileOffsetToAddress(BinaryObjectPtr obj, quint64 offset,
+                                  quint64 &addr);
 
   /**
    * Generate string of format:
@@ -0,0 +1,185 @@
+#include <QHash>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <cstring>
+
+#include "BinaryDiff.h"
+
+namespace {
+  const quint32 PRIME{16777619};
+
+  quint32 blockHash(const char *data, int size) {
+    quint32 hash{0};
+    for (int i = 0; i < size; i++) {
+      hash = hash * PRIME + (unsigned char) data[i];
+    }
+    return hash;
+  }
+
+  /**
+   * Add the ranges where the equally sized buffers differ to both sets.
+   */
+  void diffInPlace(const char *a, const char *b, quint64 size,
+                   IntervalSet &changedA, IntervalSet &changedB) {
+    // Skip equal chunks quickly and only scan the others byte by byte.
+    const quint64 chunk{4096};
+    for (quint64 off = 0; off < size; off += chunk) {
+      quint64 end = qMin(off + chunk, size);
+      if (memcmp(a + off, b + off, end - off) == 0) continue;
+      for (quint64 i = off; i < end;) {
+        if (a[i] == b[i]) {
+          i++;
+          continue;
+        }
+        quint64 start = i;
+        while (i < end && a[i] != b[i]) i++;
+        changedA.add(start, i - start);
+        changedB.add(start, i - start);
+      }
+    }
+  }
+
+  /**
+   * Find the ranges of b that also occur in a. Blocks of a are indexed by
+   * hash and a rolling hash of b is looked up at every offset. Matches
+   * are extended forward byte by byte.
+   */
+  void matchBlocks(const char *a, quint64 na, const char *b, quint64 nb,
+                   IntervalSet &matchedA, IntervalSet &matchedB) {
+    // Keep the index at about a million blocks.
+    int size{32};
+    while (na / size > (1 << 20)) size *= 2;
+    if (na < (quint64) size || nb < (quint64) size) return;
+
+    QHash<quint32, quint64> index;
+    index.reserve(na / size);
+    for (quint64 off = 0; off + size <= na; off += size) {
+      quint32 hash = blockHash(a + off, size);
+      if (!index.contains(hash)) {
+        index.insert(hash, off);
+      }
+    }
+
+    // Weight of the byte leaving the window.
+    quint32 outWeight{1};
+    for (int i = 1; i < size; i++) {
+      outWeight *= PRIME;
+    }
+
+    quint64 pos{0};
+    quint32 hash = blockHash(b, size);
+    while (pos + size <= nb) {
+      auto it = index.constFind(hash);
+      if (it != index.constEnd() && memcmp(a + it.value(), b + pos, size) == 0) {
+        quint64 off = it.value(), len = size;
+        while (off + len < na && pos + len < nb && a[off + len] == b[pos + len]) {
+          len++;
+        }
+        matchedA.add(off, len);
+        matchedB.add(pos, len);
+        pos += len;
+        if (pos + size <= nb) {
+          hash = blockHash(b + pos, size);
+        }
+        continue;
+      }
+
+      if (pos + size < nb) {
+        hash = (hash - (unsigned char) b[pos] * outWeight) * PRIME +
+          (unsigned char) b[pos + size];
+      }
+      pos++;
+    }
+  }
+}
+
+BinaryDiffPtr BinaryDiff::diff(BinaryObjectPtr a, BinaryObjectPtr b) {
+  QVector<SectionDiff> pairs;
+  auto rest = b->getSections();
+  foreach (auto secA, a->getSections()) {
+    SectionDiff pair;
+    pair.a = secA;
+    for (int i = 0; i < rest.size(); i++) {
+      auto secB = rest[i];
+      if (secB->getType() == secA->getType() &&
+          secB->getName() == secA->getName()) {
+        pair.b = secB;
+        rest.removeAt(i);
+        break;
+      }
+    }
+    pairs << pair;
+  }
+  foreach (auto secB, rest) {
+    SectionDiff pair;
+    pair.b = secB;
+    pairs << pair;
+  }
+
+  QtConcurrent::blockingMap(pairs, [](SectionDiff &pair) {
+      if (pair.a && pair.b) {
+        auto snapA = pair.a->getSnapshot(), snapB = pair.b->getSnapshot();
+        diffData(snapA.data, snapB.data, pair.changedA, pair.changedB);
+      }
+      else if (pair.a) {
+        pair.changedA.add(0, pair.a->getSnapshot().data.size());
+      }
+      else {
+        pair.changedB.add(0, pair.b->getSnapshot().data.size());
+      }
+    });
+
+  auto res = BinaryDiffPtr(new BinaryDiff);
+  res->sections = pairs.toList();
+  return res;
+}
+
+int BinaryDiff::getChangedCount() const {
+  int count{0};
+  foreach (const auto &sec, sections) {
+    if (!sec.changedA.isEmpty() || !sec.changedB.isEmpty()) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void BinaryDiff::markSections() const {
+  foreach (const auto &sec, sections) {
+    if (sec.a) sec.a->setDiffRegions(sec.changedA);
+    if (sec.b) sec.b->setDiffRegions(sec.changedB);
+  }
+}
+
+void BinaryDiff::diffData(const QByteArray &a, const QByteArray &b,
+                          IntervalSet &changedA, IntervalSet &changedB) {
+  quint64 na = a.size(), nb = b.size();
+  if (na == nb) {
+    diffInPlace(a.constData(), b.constData(), na, changedA, changedB);
+    return;
+  }
+
+  // Only the middle part differing between common prefix and suffix is
+  // matched by blocks.
+  quint64 prefix{0}, suffix{0};
+  while (prefix < na && prefix < nb && a[(int) prefix] == b[(int) prefix]) {
+    prefix++;
+  }
+  while (suffix < na - prefix && suffix < nb - prefix &&
+         a[(int) (na - 1 - suffix)] == b[(int) (nb - 1 - suffix)]) {
+    suffix++;
+  }
+
+  quint64 midA = na - prefix - suffix, midB = nb - prefix - suffix;
+  IntervalSet matchedA, matchedB;
+  matchBlocks(a.constData() + prefix, midA, b.constData() + prefix, midB,
+              matchedA, matchedB);
+
+  foreach (const auto &in, matchedA.complement(midA).getIntervals()) {
+    changedA.add(prefix + in.first, in.second - in.first);
+  }
+  foreach (const auto &in, matchedB.complement(midB).getIntervals()) {
+    changedB.add(prefix + in.first, in.second - in.first);
+  }
+}
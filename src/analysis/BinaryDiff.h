@@ -0,0 +1,57 @@
+#ifndef BMOD_BINARY_DIFF_H
+#define BMOD_BINARY_DIFF_H
+
+#include <QList>
+
+#include <memory>
+
+#include "../IntervalSet.h"
+#include "../BinaryObject.h"
+
+class BinaryDiff;
+typedef std::shared_ptr<BinaryDiff> BinaryDiffPtr;
+
+/**
+ * Byte-level differences between the sections of two objects.
+ *
+ * Sections are aligned by type and name. Sections of equal size are
+ * compared in place. Otherwise blocks of the first section are indexed
+ * by a rolling hash and looked up at every offset of the second, like
+ * rsync, so that inserted or removed bytes only affect their own range.
+ */
+class BinaryDiff {
+public:
+  struct SectionDiff {
+    SectionPtr a, b; // Either is null if it only exists in one object.
+    IntervalSet changedA, changedB; // Relative to each section.
+  };
+
+  /**
+   * Compare the objects with the section pairs processed in parallel.
+   */
+  static BinaryDiffPtr diff(BinaryObjectPtr a, BinaryObjectPtr b);
+
+  const QList<SectionDiff> &getSections() const { return sections; }
+
+  /**
+   * Number of sections that differ.
+   */
+  int getChangedCount() const;
+
+  /**
+   * Store the changed ranges on the sections for the panes to show.
+   */
+  void markSections() const;
+
+  /**
+   * Compare two buffers and add the ranges of each that are not found
+   * in the other.
+   */
+  static void diffData(const QByteArray &a, const QByteArray &b,
+                       IntervalSet &changedA, IntervalSet &changedB);
+
+private:
+  QList<SectionDiff> sections;
+};
+
+#endif // BMOD_BINARY_DIFF_H
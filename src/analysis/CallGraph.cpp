@@ -0,0 +1,214 @@
+#include <QSet>
+
+#include <algorithm>
+
+#include "CallGraph.h"
+#include "ControlFlowGraph.h"
+
+CallGraph::CallGraph() : callersDirty{false} { }
+
+CallGraphPtr CallGraph::build(BinaryObjectPtr obj) {
+  auto cfg = obj->getControlFlowGraph();
+  const auto &calls = cfg->getCalls();
+
+  auto graph = CallGraphPtr(new CallGraph);
+  foreach (const auto &func, cfg->getFunctions()) {
+    graph->addFunction(func.addr, calls.mid(func.firstCall, func.callCount));
+  }
+  return graph;
+}
+
+quint32 CallGraph::addFunction(quint64 addr,
+                               const QVector<quint64> &callees) {
+  // Resolve the callees first since they might add nodes.
+  QVector<quint32> nodes;
+  QSet<quint32> seen;
+  foreach (quint64 callee, callees) {
+    quint32 node = getNode(callee);
+    if (!seen.contains(node)) {
+      seen << node;
+      nodes << node;
+    }
+  }
+
+  quint32 node = getNode(addr);
+  starts[node] = edges.size();
+  counts[node] = nodes.size();
+  edges += nodes;
+  callersDirty = true;
+  return node;
+}
+
+int CallGraph::findNode(quint64 addr) const {
+  auto it = lookup.constFind(addr);
+  if (it == lookup.constEnd()) {
+    return -1;
+  }
+  return it.value();
+}
+
+QVector<quint32> CallGraph::getCallees(quint32 node) const {
+  return edges.mid(starts[node], counts[node]);
+}
+
+QVector<quint32> CallGraph::getCallers(quint32 node) const {
+  buildCallers();
+  quint32 first = callerOffsets[node];
+  return callers.mid(first, callerOffsets[node + 1] - first);
+}
+
+QVector<quint32> CallGraph::getComponents(int *count) const {
+  struct Frame {
+    quint32 node, next;
+  };
+
+  const int size = addrs.size();
+  QVector<quint32> comps(size), stack;
+  QVector<int> index(size, -1), low(size);
+  QVector<bool> onStack(size, false);
+  QVector<Frame> frames;
+  int counter{0}, compCount{0};
+
+  for (int root = 0; root < size; root++) {
+    if (index[root] != -1) continue;
+
+    index[root] = low[root] = counter++;
+    stack << root;
+    onStack[root] = true;
+    frames << Frame{(quint32) root, 0};
+
+    while (!frames.isEmpty()) {
+      quint32 node = frames.last().node;
+
+      // Visit the next callee, if any.
+      if (frames.last().next < counts[node]) {
+        quint32 callee = edges[starts[node] + frames.last().next++];
+        if (index[callee] == -1) {
+          index[callee] = low[callee] = counter++;
+          stack << callee;
+          onStack[callee] = true;
+          frames << Frame{callee, 0};
+        }
+        else if (onStack[callee]) {
+          low[node] = qMin(low[node], index[callee]);
+        }
+        continue;
+      }
+
+      // All callees visited so pop the component if this is its root.
+      if (low[node] == index[node]) {
+        quint32 member;
+        do {
+          member = stack.takeLast();
+          onStack[member] = false;
+          comps[member] = compCount;
+        } while (member != node);
+        compCount++;
+      }
+
+      frames.removeLast();
+      if (!frames.isEmpty()) {
+        quint32 caller = frames.last().node;
+        low[caller] = qMin(low[caller], low[node]);
+      }
+    }
+  }
+
+  if (count) {
+    *count = compCount;
+  }
+  return comps;
+}
+
+QVector<bool> CallGraph::getReachable(const QList<quint32> &roots) const {
+  QVector<bool> reached(addrs.size(), false);
+  QVector<quint32> queue;
+  foreach (quint32 root, roots) {
+    if (!reached[root]) {
+      reached[root] = true;
+      queue << root;
+    }
+  }
+
+  for (int i = 0; i < queue.size(); i++) {
+    quint32 node = queue[i];
+    quint32 end = starts[node] + counts[node];
+    for (quint32 j = starts[node]; j < end; j++) {
+      quint32 callee = edges[j];
+      if (!reached[callee]) {
+        reached[callee] = true;
+        queue << callee;
+      }
+    }
+  }
+  return reached;
+}
+
+QList<QPair<quint32, int>> CallGraph::getCallersUpTo(quint32 node,
+                                                     int depth) const {
+  buildCallers();
+
+  QList<QPair<quint32, int>> res;
+  QSet<quint32> seen;
+  seen << node;
+
+  // Breadth-first so each caller gets its shortest distance.
+  QVector<quint32> level{node};
+  for (int dist = 1; dist <= depth && !level.isEmpty(); dist++) {
+    QVector<quint32> next;
+    foreach (quint32 callee, level) {
+      for (quint32 i = callerOffsets[callee]; i < callerOffsets[callee + 1];
+           i++) {
+        quint32 caller = callers[i];
+        if (seen.contains(caller)) continue;
+        seen << caller;
+        next << caller;
+        res << qMakePair(caller, dist);
+      }
+    }
+    level = next;
+  }
+  return res;
+}
+
+quint32 CallGraph::getNode(quint64 addr) {
+  auto it = lookup.constFind(addr);
+  if (it != lookup.constEnd()) {
+    return it.value();
+  }
+  quint32 node = addrs.size();
+  lookup.insert(addr, node);
+  addrs << addr;
+  starts << 0;
+  counts << 0;
+  return node;
+}
+
+void CallGraph::buildCallers() const {
+  if (!callersDirty && callerOffsets.size() == addrs.size() + 1) {
+    return;
+  }
+
+  // Counting sort of the edges by callee.
+  const int size = addrs.size();
+  callerOffsets.fill(0, size + 1);
+  for (int node = 0; node < size; node++) {
+    quint32 end = starts[node] + counts[node];
+    for (quint32 i = starts[node]; i < end; i++) {
+      callerOffsets[edges[i] + 1]++;
+    }
+  }
+  for (int node = 0; node < size; node++) {
+    callerOffsets[node + 1] += callerOffsets[node];
+  }
+
+  QVector<quint32> pos = callerOffsets;
+  callers.resize(callerOffsets[size]);
+  for (int node = 0; node < size; node++) {
+    quint32 end = starts[node] + counts[node];
+    for (quint32 i = starts[node]; i < end; i++) {
+      callers[pos[edges[i]]++] = node;
+    }
+  }
+  callersDirty = false;
+}
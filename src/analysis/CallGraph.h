@@ -0,0 +1,82 @@
+#ifndef BMOD_CALL_GRAPH_H
+#define BMOD_CALL_GRAPH_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include <memory>
+
+#include "../BinaryObject.h"
+
+class CallGraph;
+typedef std::shared_ptr<CallGraph> CallGraphPtr;
+
+/**
+ * Whole-program call graph over the functions of an object.
+ *
+ * Functions are nodes numbered in the order they are first seen. The
+ * callees of node n are edges[starts[n]] to edges[starts[n] + counts[n]
+ * - 1] so functions can be added one at a time as they are decoded. The
+ * callers are kept in compressed sparse row form which is rebuilt on the
+ * first query after functions were added.
+ */
+class CallGraph {
+public:
+  CallGraph();
+
+  /**
+   * Build from the recovered functions of the object.
+   */
+  static CallGraphPtr build(BinaryObjectPtr obj);
+
+  /**
+   * Add a function with its direct callees and return its node. Callees
+   * not added yet become nodes without callees until added themselves.
+   */
+  quint32 addFunction(quint64 addr, const QVector<quint64> &callees);
+
+  int getNodeCount() const { return addrs.size(); }
+  int getEdgeCount() const { return edges.size(); }
+  quint64 getAddress(quint32 node) const { return addrs[node]; }
+
+  /**
+   * Node of the function at the address, or -1.
+   */
+  int findNode(quint64 addr) const;
+
+  QVector<quint32> getCallees(quint32 node) const;
+  QVector<quint32> getCallers(quint32 node) const;
+
+  /**
+   * Strongly connected components using an iterative Tarjan's
+   * algorithm. Returns the component of each node. Components are
+   * numbered in reverse topological order, callees before callers.
+   */
+  QVector<quint32> getComponents(int *count = nullptr) const;
+
+  /**
+   * Mark the nodes reachable from the roots through calls.
+   */
+  QVector<bool> getReachable(const QList<quint32> &roots) const;
+
+  /**
+   * Transitive callers of the node at most depth calls away, paired
+   * with their distance and ordered by it.
+   */
+  QList<QPair<quint32, int>> getCallersUpTo(quint32 node, int depth) const;
+
+private:
+  quint32 getNode(quint64 addr);
+  void buildCallers() const;
+
+  QVector<quint64> addrs;
+  QHash<quint64, quint32> lookup;
+  QVector<quint32> starts, counts, edges;
+
+  mutable bool callersDirty;
+  mutable QVector<quint32> callerOffsets, callers;
+};
+
+#endif // BMOD_CALL_GRAPH_H
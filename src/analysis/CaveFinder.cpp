@@ -0,0 +1,202 @@
+#include <QtConcurrentMap>
+
+#include <cstring>
+#include <algorithm>
+
+#include "CaveFinder.h"
+#include "../AddressSpace.h"
+#include "../asm/AsmX86.h"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define BMOD_CAVES_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+  typedef CaveFinder::Cave Cave;
+  typedef CaveFinder::Kind Kind;
+
+  struct Job {
+    BinaryObjectPtr obj;
+    SectionPtr sec;
+    QVector<Cave> caves;
+  };
+
+  /**
+   * Position of the first byte from pos that differs from the value.
+   */
+  quint64 skipRun(const uchar *data, quint64 pos, quint64 len, uchar value) {
+#ifdef BMOD_CAVES_SSE2
+    const __m128i v = _mm_set1_epi8((char) value);
+    while (pos + 16 <= len) {
+      __m128i d = _mm_loadu_si128((const __m128i*) (data + pos));
+      quint32 mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(d, v)) & 0xFFFF;
+      if (mask) {
+        return pos + __builtin_ctz(mask);
+      }
+      pos += 16;
+    }
+#endif
+    while (pos < len && data[pos] == value) {
+      pos++;
+    }
+    return pos;
+  }
+
+  inline bool isCandidate(uchar c, bool x86) {
+    return c == 0x00 || c == 0xCC ||
+      (x86 && (c == 0x90 || c == 0x66 || c == 0x0F));
+  }
+
+  /**
+   * Position of the first byte from pos that may start a cave: zero,
+   * INT3 or the first byte of a NOP form.
+   */
+  quint64 findCandidate(const uchar *data, quint64 pos, quint64 len, bool x86) {
+#ifdef BMOD_CAVES_SSE2
+    const __m128i zero = _mm_setzero_si128(), int3 = _mm_set1_epi8((char) 0xCC),
+      nop = _mm_set1_epi8((char) 0x90), opsize = _mm_set1_epi8(0x66),
+      escape = _mm_set1_epi8(0x0F);
+    while (pos + 16 <= len) {
+      __m128i d = _mm_loadu_si128((const __m128i*) (data + pos));
+      __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(d, zero), _mm_cmpeq_epi8(d, int3));
+      if (x86) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(d, nop));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(d, opsize));
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(d, escape));
+      }
+      quint32 mask = _mm_movemask_epi8(hit);
+      if (mask) {
+        return pos + __builtin_ctz(mask);
+      }
+      pos += 16;
+    }
+#endif
+    while (pos < len && !isCandidate(data[pos], x86)) {
+      pos++;
+    }
+    return pos;
+  }
+
+  /**
+   * Position after the NOP padding starting at pos, or pos if none.
+   */
+  quint64 skipNops(const uchar *data, quint64 pos, quint64 len) {
+    const auto &forms = AsmX86::getNopForms();
+    for (;;) {
+      if (pos < len && data[pos] == 0x90) {
+        pos++;
+        continue;
+      }
+
+      // Extra operand size prefixes are allowed before the forms.
+      quint64 start{pos};
+      while (pos + 1 < len && data[pos] == 0x66 && data[pos + 1] == 0x66) {
+        pos++;
+      }
+      bool found{false};
+      foreach (const auto &form, forms) {
+        quint64 size = form.bytes.size();
+        if (pos + size <= len &&
+            memcmp(data + pos, form.bytes.constData(), size) == 0) {
+          pos += size;
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        return start;
+      }
+    }
+  }
+
+  void scanSection(Job &job, quint64 minSize) {
+    auto snap = job.sec->getSnapshot();
+    const QByteArray &data = snap.data;
+    const auto *ptr = (const uchar*) data.constData();
+    quint64 len = data.size();
+    auto cpu = job.obj->getCpuType();
+    bool x86 = (cpu == CpuType::X86 || cpu == CpuType::X86_64);
+
+    auto add = [&](quint64 pos, quint64 size, Kind kind) {
+      if (size < minSize) return;
+      Cave cave;
+      cave.obj = job.obj;
+      cave.sec = job.sec;
+      cave.where = job.sec->getName();
+      cave.addr = job.sec->getAddress() + pos;
+      cave.offset = job.sec->getOffset() + pos;
+      cave.size = size;
+      cave.kind = kind;
+      job.caves << cave;
+    };
+
+    quint64 pos{0};
+    while ((pos = findCandidate(ptr, pos, len, x86)) < len) {
+      uchar c = ptr[pos];
+      if (c == 0x00 || c == 0xCC) {
+        quint64 end = skipRun(ptr, pos, len, c);
+        add(pos, end - pos, c == 0x00 ? Kind::Zeros : Kind::Int3);
+        pos = end;
+        continue;
+      }
+      quint64 end = skipNops(ptr, pos, len);
+      if (end == pos) {
+        pos++;
+        continue;
+      }
+      add(pos, end - pos, Kind::Nops);
+      pos = end;
+    }
+  }
+
+  bool lessBySize(const Cave &a, const Cave &b) {
+    return a.size > b.size || (a.size == b.size && a.addr < b.addr);
+  }
+}
+
+QVector<CaveFinder::Cave> CaveFinder::find(const QList<BinaryObjectPtr> &objs,
+                                           quint64 minSize) {
+  QVector<Job> jobs;
+  QVector<Cave> caves;
+  foreach (const auto obj, objs) {
+    foreach (const auto sec, obj->getSections()) {
+      auto type = sec->getType();
+      if (type == SectionType::Text || type == SectionType::SymbolStubs) {
+        Job job;
+        job.obj = obj;
+        job.sec = sec;
+        jobs << job;
+      }
+    }
+
+    // Segments are padded to page size after the last section.
+    auto space = obj->getAddressSpace();
+    if (!space) continue;
+    foreach (const auto &mapping, space->getMappings()) {
+      quint64 end = mapping.offset + mapping.fileSize;
+      if (mapping.sectionsEnd == 0 || mapping.sectionsEnd >= end ||
+          end - mapping.sectionsEnd < minSize) {
+        continue;
+      }
+      Cave cave;
+      cave.obj = obj;
+      cave.where = mapping.name;
+      cave.offset = mapping.sectionsEnd;
+      cave.addr = mapping.addr + (mapping.sectionsEnd - mapping.offset);
+      cave.size = end - mapping.sectionsEnd;
+      cave.kind = Kind::Slack;
+      caves << cave;
+    }
+  }
+
+  QtConcurrent::blockingMap(jobs, [minSize](Job &job) {
+      scanSection(job, minSize);
+    });
+
+  foreach (const auto &job, jobs) {
+    caves += job.caves;
+  }
+  std::sort(caves.begin(), caves.end(), lessBySize);
+  return caves;
+}
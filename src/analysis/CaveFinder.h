@@ -0,0 +1,41 @@
+#ifndef BMOD_CAVE_FINDER_H
+#define BMOD_CAVE_FINDER_H
+
+#include <QList>
+#include <QVector>
+#include <QString>
+
+#include "../Section.h"
+#include "../BinaryObject.h"
+
+/**
+ * Finds unused space for patches: runs of zeros, INT3 (0xCC) or NOP
+ * padding in the code sections, and the slack between the last section
+ * and the end of a segment in the file.
+ */
+class CaveFinder {
+public:
+  enum class Kind : char {
+    Zeros,
+    Int3,
+    Nops,
+    Slack // Segment bytes after the last section.
+  };
+
+  struct Cave {
+    BinaryObjectPtr obj;
+    SectionPtr sec; // Null for slack.
+    QString where; // Section or segment name.
+    quint64 addr, offset, size;
+    Kind kind;
+  };
+
+  /**
+   * Caves of at least minSize bytes of all objects, searched in parallel
+   * and sorted by descending size and then address.
+   */
+  static QVector<Cave> find(const QList<BinaryObjectPtr> &objs,
+                            quint64 minSize = 16);
+};
+
+#endif // BMOD_CAVE_FINDER_H
@@ -0,0 +1,298 @@
+#include <QMap>
+#include <QSet>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+#include "ControlFlowGraph.h"
+#include "../asm/Disassembler.h"
+
+namespace {
+  struct Inst {
+    quint32 size;
+    FlowType flow;
+    quint64 target; // Of direct branches.
+  };
+
+  struct Job {
+    quint64 addr;
+    SectionPtr sec;
+    QVector<ControlFlowGraph::Block> blocks; // Successors are local.
+    QVector<quint32> successors;
+    QVector<quint64> calls;
+  };
+
+  bool endsBlock(FlowType flow) {
+    return flow == FlowType::Jump || flow == FlowType::CondJump ||
+      flow == FlowType::IndirectJump || flow == FlowType::Return ||
+      flow == FlowType::Stop;
+  }
+
+  SectionPtr findSection(const QList<SectionPtr> &secs, quint64 addr) {
+    foreach (auto sec, secs) {
+      if (addr >= sec->getAddress() &&
+          addr < sec->getAddress() + sec->getSize()) {
+        return sec;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Follow all intra-procedural branches from the function entry and
+   * split the decoded instructions into basic blocks. Jumps to other
+   * known entries are treated as tail calls.
+   */
+  void explore(BinaryObjectPtr obj, const QSet<quint64> &entries, Job &job) {
+    const auto &sec = job.sec;
+    const quint64 secAddr = sec->getAddress(),
+      secEnd = secAddr + sec->getSize();
+
+    Disassembler dis(obj);
+    QMap<quint64, Inst> insts;
+    QSet<quint64> leaders;
+    QVector<quint64> work;
+    leaders << job.addr;
+    work << job.addr;
+
+    while (!work.isEmpty()) {
+      quint64 addr = work.takeLast();
+      if (insts.contains(addr)) continue;
+
+      Disassembly run;
+      if (!dis.disassembleRun(sec, addr - secAddr, run)) continue;
+
+      int ref{0};
+      const auto &refs = run.references;
+      for (int i = 0; i < run.flows.size(); i++) {
+        // Stop when joining already decoded code or running into another
+        // function.
+        if (i > 0 && (insts.contains(addr) ||
+                      (addr != job.addr && entries.contains(addr)))) {
+          leaders << addr;
+          break;
+        }
+
+        // Undecodable bytes end the run without becoming part of a block.
+        if (run.flows[i] == FlowType::Invalid) break;
+
+        Inst inst;
+        inst.size = run.bytesConsumed[i];
+        inst.flow = run.flows[i];
+        inst.target = 0;
+
+        // References are recorded in instruction order. Branches to
+        // symbols outside of object files have none.
+        bool known{false};
+        if (inst.flow == FlowType::Call || inst.flow == FlowType::Jump ||
+            inst.flow == FlowType::CondJump) {
+          while (ref < refs.size() &&
+                 (refs[ref].from < addr ||
+                  refs[ref].type == Reference::Type::Data)) {
+            ref++;
+          }
+          if (ref < refs.size() && refs[ref].from == addr) {
+            inst.target = refs[ref].to;
+            known = true;
+          }
+        }
+        insts.insert(addr, inst);
+
+        quint64 next = addr + inst.size;
+        bool inside = (known && inst.target >= secAddr && inst.target < secEnd);
+        if (inst.flow == FlowType::Call) {
+          if (known) {
+            job.calls << inst.target;
+          }
+        }
+        else if (inst.flow == FlowType::Jump ||
+                 inst.flow == FlowType::CondJump) {
+          if (known && entries.contains(inst.target) &&
+              inst.target != job.addr) {
+            job.calls << inst.target;
+          }
+          else if (inside) {
+            leaders << inst.target;
+            work << inst.target;
+          }
+          if (inst.flow == FlowType::CondJump) {
+            leaders << next;
+          }
+        }
+        addr = next;
+      }
+    }
+
+    // Split into blocks at leaders and after branches.
+    QVector<Inst> lasts;
+    QHash<quint64, quint32> blockAt;
+    quint64 end{0};
+    bool open{false};
+    for (auto it = insts.constBegin(); it != insts.constEnd(); ++it) {
+      quint64 addr = it.key();
+      const auto &inst = it.value();
+      if (open && (addr != end || leaders.contains(addr))) {
+        open = false;
+      }
+      if (!open) {
+        blockAt.insert(addr, job.blocks.size());
+        ControlFlowGraph::Block block;
+        block.addr = addr;
+        block.size = block.instCount = block.firstSucc = block.succCount = 0;
+        job.blocks << block;
+        lasts << inst;
+        open = true;
+      }
+      auto &block = job.blocks.last();
+      block.size += inst.size;
+      block.instCount++;
+      lasts.last() = inst;
+      end = addr + inst.size;
+      if (endsBlock(inst.flow)) {
+        open = false;
+      }
+    }
+
+    // Link blocks by the last instruction of each.
+    for (int i = 0; i < job.blocks.size(); i++) {
+      auto &block = job.blocks[i];
+      const auto &last = lasts[i];
+      block.firstSucc = job.successors.size();
+
+      QList<quint64> succs;
+      if (last.flow == FlowType::Jump || last.flow == FlowType::CondJump) {
+        succs << last.target;
+      }
+      if (!endsBlock(last.flow) || last.flow == FlowType::CondJump) {
+        succs << block.addr + block.size;
+      }
+      foreach (quint64 succ, succs) {
+        auto it = blockAt.constFind(succ);
+        if (it != blockAt.constEnd()) {
+          job.successors << it.value();
+          block.succCount++;
+        }
+      }
+    }
+  }
+}
+
+ControlFlowGraphPtr ControlFlowGraph::build(BinaryObjectPtr obj) {
+  QList<SectionPtr> secs;
+  foreach (auto sec, obj->getSections()) {
+    auto type = sec->getType();
+    if (type == SectionType::Text || type == SectionType::SymbolStubs) {
+      secs << sec;
+    }
+  }
+
+  // Seed with the entry point, symbols and function starts.
+  QList<quint64> seeds;
+  if (obj->getEntryPoint() != 0) {
+    seeds << obj->getEntryPoint();
+  }
+  foreach (const auto &symbol, obj->getSymbolTable().getSymbols()) {
+    seeds << symbol.getValue();
+  }
+  seeds << obj->getFunctionStarts();
+
+  QSet<quint64> entries;
+  QVector<Job> pending, done;
+  foreach (quint64 addr, seeds) {
+    auto sec = findSection(secs, addr);
+    if (!sec || entries.contains(addr)) continue;
+    entries << addr;
+    Job job;
+    job.addr = addr;
+    job.sec = sec;
+    pending << job;
+  }
+
+  // Each round explores its functions in parallel and schedules the
+  // call targets not seen before for the next round.
+  while (!pending.isEmpty()) {
+    QtConcurrent::blockingMap(pending, [obj, &entries](Job &job) {
+        explore(obj, entries, job);
+      });
+
+    QVector<Job> next;
+    foreach (const auto &job, pending) {
+      foreach (quint64 addr, job.calls) {
+        if (entries.contains(addr)) continue;
+        auto sec = findSection(secs, addr);
+        if (!sec) continue;
+        entries << addr;
+        Job job2;
+        job2.addr = addr;
+        job2.sec = sec;
+        next << job2;
+      }
+    }
+    done += pending;
+    pending = next;
+  }
+
+  std::sort(done.begin(), done.end(), [](const Job &a, const Job &b) {
+      return a.addr < b.addr;
+    });
+
+  auto cfg = ControlFlowGraphPtr(new ControlFlowGraph);
+  cfg->functions.reserve(done.size());
+  foreach (const auto &job, done) {
+    Function func;
+    func.addr = job.addr;
+    func.firstBlock = cfg->blocks.size();
+    func.blockCount = job.blocks.size();
+    func.firstCall = cfg->calls.size();
+    func.callCount = job.calls.size();
+    cfg->functions << func;
+
+    quint32 succBase = cfg->successors.size();
+    foreach (auto block, job.blocks) {
+      block.firstSucc += succBase;
+      cfg->blocks << block;
+    }
+    foreach (quint32 succ, job.successors) {
+      cfg->successors << succ + func.firstBlock;
+    }
+    cfg->calls += job.calls;
+  }
+
+  const auto &blocks = cfg->blocks;
+  auto &order = cfg->blockOrder;
+  order.resize(blocks.size());
+  for (int i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&blocks](quint32 a, quint32 b) {
+      return blocks[a].addr < blocks[b].addr;
+    });
+  return cfg;
+}
+
+int ControlFlowGraph::findFunction(quint64 addr) const {
+  auto it = std::lower_bound(functions.constBegin(), functions.constEnd(), addr,
+                             [](const Function &func, quint64 value) {
+                               return func.addr < value;
+                             });
+  if (it == functions.constEnd() || it->addr != addr) {
+    return -1;
+  }
+  return it - functions.constBegin();
+}
+
+int ControlFlowGraph::findBlock(quint64 addr) const {
+  // Find the last block starting at or before the address.
+  auto it = std::upper_bound(blockOrder.constBegin(), blockOrder.constEnd(),
+                             addr, [this](quint64 value, quint32 idx) {
+                               return value < blocks[idx].addr;
+                             });
+  if (it == blockOrder.constBegin()) {
+    return -1;
+  }
+  const auto &block = blocks[*(it - 1)];
+  if (addr >= block.addr + block.size) {
+    return -1;
+  }
+  return *(it - 1);
+}
@@ -0,0 +1,76 @@
+#ifndef BMOD_CONTROL_FLOW_GRAPH_H
+#define BMOD_CONTROL_FLOW_GRAPH_H
+
+#include <QVector>
+
+#include <memory>
+
+#include "../BinaryObject.h"
+
+class ControlFlowGraph;
+typedef std::shared_ptr<ControlFlowGraph> ControlFlowGraphPtr;
+
+/**
+ * Functions and basic blocks recovered by recursive descent from the
+ * entry point, symbols and function starts of the object.
+ *
+ * All storage is flat: the blocks of function f are blocks[first] to
+ * blocks[first + count - 1] with first = functions[f].firstBlock and
+ * count = functions[f].blockCount. Likewise block b has the successors
+ * successors[b.firstSucc] to successors[b.firstSucc + b.succCount - 1]
+ * given as indices into blocks.
+ */
+class ControlFlowGraph {
+public:
+  struct Block {
+    quint64 addr;
+    quint32 size; // In bytes.
+    quint32 instCount;
+    quint32 firstSucc, succCount;
+  };
+
+  struct Function {
+    quint64 addr;
+    quint32 firstBlock, blockCount;
+    quint32 firstCall, callCount; // Direct call and tail call targets.
+  };
+
+  /**
+   * Recover the functions of the code sections. Functions are explored
+   * in parallel in rounds where each round processes the call targets
+   * discovered by the previous one.
+   */
+  static ControlFlowGraphPtr build(BinaryObjectPtr obj);
+
+  /**
+   * Functions sorted by address.
+   */
+  const QVector<Function> &getFunctions() const { return functions; }
+  const QVector<Block> &getBlocks() const { return blocks; }
+  const QVector<quint32> &getSuccessors() const { return successors; }
+  const QVector<quint64> &getCalls() const { return calls; }
+
+  /**
+   * Index of the function starting at the address, or -1.
+   */
+  int findFunction(quint64 addr) const;
+
+  /**
+   * Index of a block containing the address, or -1.
+   */
+  int findBlock(quint64 addr) const;
+
+  /**
+   * Indices of all blocks sorted by address.
+   */
+  const QVector<quint32> &getBlockOrder() const { return blockOrder; }
+
+private:
+  QVector<Function> functions;
+  QVector<Block> blocks;
+  QVector<quint32> successors;
+  QVector<quint64> calls;
+  QVector<quint32> blockOrder;
+};
+
+#endif // BMOD_CONTROL_FLOW_GRAPH_H
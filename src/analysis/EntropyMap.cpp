@@ -0,0 +1,159 @@
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
+
+#include <cmath>
+#include <cstring>
+
+#include "EntropyMap.h"
+#include "../Checksum.h"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define BMOD_ENTROPY_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+  const quint32 MIN_BLOCK_SIZE{1024};
+  const int MAX_BLOCKS{1 << 16};
+
+  // Blocks per job so threads are not handed too little work each.
+  const int BLOCKS_PER_JOB{64};
+
+  struct Job {
+    int first, count;
+  };
+
+  typedef QPair<quint64, quint64> CacheKey;
+  QHash<CacheKey, EntropyMapPtr> cache;
+  QMutex cacheMutex;
+  const int MAX_CACHED{32};
+
+  /**
+   * Counts zero, printable ASCII and high bytes.
+   */
+  void classify(const uchar *data, quint32 len, EntropyMap::Block &block) {
+    quint32 zeros{0}, text{0}, high{0}, i{0};
+#ifdef BMOD_ENTROPY_SSE2
+    const __m128i zero = _mm_setzero_si128();
+
+    // Printable is 0x20 to 0x7E, compared signed so high bytes are below.
+    const __m128i lo = _mm_set1_epi8(0x1F), hi = _mm_set1_epi8(0x7F);
+    for (; i + 16 <= len; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i*) (data + i));
+      zeros += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+      __m128i print = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+      text += __builtin_popcount(_mm_movemask_epi8(print));
+      high += __builtin_popcount(_mm_movemask_epi8(v));
+    }
+#endif
+    for (; i < len; i++) {
+      uchar c = data[i];
+      zeros += (c == 0);
+      text += (c >= 0x20 && c < 0x7F);
+      high += (c >= 0x80);
+    }
+    block.zeros = zeros;
+    block.text = text;
+    block.high = high;
+  }
+}
+
+EntropyMapPtr EntropyMap::build(const QByteArray &data) {
+  return build((const uchar*) data.constData(), data.size());
+}
+
+EntropyMapPtr EntropyMap::build(const uchar *data, quint64 size) {
+  CacheKey key(Checksum::xxh64((const char*) data, size), size);
+  {
+    QMutexLocker locker(&cacheMutex);
+    if (cache.contains(key)) {
+      return cache[key];
+    }
+  }
+
+  quint32 blockSize{MIN_BLOCK_SIZE};
+  while ((size + blockSize - 1) / blockSize > (quint64) MAX_BLOCKS) {
+    blockSize *= 2;
+  }
+
+  auto map = EntropyMapPtr(new EntropyMap(size, blockSize));
+  int count = (size + blockSize - 1) / blockSize;
+  map->blocks.resize(count);
+
+  // Entropy is log2(n) - sum(c * log2(c)) / n over the byte counts c, so
+  // c * log2(c) is tabulated once for all blocks.
+  QVector<float> clogc(blockSize + 1);
+  clogc[0] = 0;
+  for (quint32 c = 1; c <= blockSize; c++) {
+    clogc[c] = c * std::log2((double) c);
+  }
+
+  QVector<Job> jobs;
+  for (int first = 0; first < count; first += BLOCKS_PER_JOB) {
+    jobs << Job{first, qMin(BLOCKS_PER_JOB, count - first)};
+  }
+
+  const auto *ptr = data;
+  auto *blocks = map->blocks.data();
+  QtConcurrent::blockingMap(jobs, [&](Job &job) {
+      quint32 counts[256];
+      for (int idx = job.first; idx < job.first + job.count; idx++) {
+        quint32 len = map->getBlockLength(idx);
+        const auto *block = ptr + (quint64) idx * blockSize;
+        histogram((const char*) block, len, counts);
+
+        double sum{0};
+        for (int c = 0; c < 256; c++) {
+          sum += clogc[counts[c]];
+        }
+        blocks[idx].entropy = qMax(0.0, std::log2((double) len) - sum / len);
+        classify(block, len, blocks[idx]);
+      }
+    });
+
+  QMutexLocker locker(&cacheMutex);
+  if (cache.size() >= MAX_CACHED) {
+    cache.clear();
+  }
+  cache[key] = map;
+  return map;
+}
+
+quint32 EntropyMap::getBlockLength(int idx) const {
+  quint64 start = (quint64) idx * blockSize;
+  return (start >= size ? 0 : qMin((quint64) blockSize, size - start));
+}
+
+void EntropyMap::histogram(const char *data, quint64 len, quint32 counts[256]) {
+  // Four tables break the dependency between increments of equal bytes
+  // so consecutive updates don't stall on each other.
+  quint32 tables[4][256];
+  memset(tables, 0, sizeof(tables));
+  const auto *p = (const uchar*) data;
+  quint64 i{0};
+  for (; i + 8 <= len; i += 8) {
+    quint64 word;
+    memcpy(&word, p + i, 8);
+    tables[0][word & 0xFF]++;
+    tables[1][(word >> 8) & 0xFF]++;
+    tables[2][(word >> 16) & 0xFF]++;
+    tables[3][(word >> 24) & 0xFF]++;
+    tables[0][(word >> 32) & 0xFF]++;
+    tables[1][(word >> 40) & 0xFF]++;
+    tables[2][(word >> 48) & 0xFF]++;
+    tables[3][word >> 56]++;
+  }
+  for (; i < len; i++) {
+    tables[0][p[i]]++;
+  }
+  for (int c = 0; c < 256; c++) {
+    counts[c] = tables[0][c] + tables[1][c] + tables[2][c] + tables[3][c];
+  }
+}
+
+EntropyMap::EntropyMap(quint64 size, quint32 blockSize)
+  : size{size}, blockSize{blockSize}
+{ }
@@ -0,0 +1,48 @@
+#ifndef BMOD_ENTROPY_MAP_H
+#define BMOD_ENTROPY_MAP_H
+
+#include <QVector>
+#include <QByteArray>
+
+#include <memory>
+
+class EntropyMap;
+typedef std::shared_ptr<EntropyMap> EntropyMapPtr;
+
+/**
+ * Shannon entropy and byte classes of fixed-size blocks of data, for an
+ * overview of where code, text, compressed or zero-filled regions are.
+ *
+ * Blocks are at least 1 KiB and grow with the data so there are never
+ * more than 64Ki of them. Maps are computed in parallel and cached by
+ * content hash and size.
+ */
+class EntropyMap {
+public:
+  struct Block {
+    float entropy; // Bits per byte, 0 to 8.
+    quint32 zeros, text, high; // Zero, printable ASCII and >= 0x80 bytes.
+  };
+
+  static EntropyMapPtr build(const QByteArray &data);
+  static EntropyMapPtr build(const uchar *data, quint64 size);
+
+  quint64 getSize() const { return size; }
+  quint32 getBlockSize() const { return blockSize; }
+  quint32 getBlockLength(int idx) const;
+  const QVector<Block> &getBlocks() const { return blocks; }
+
+  /**
+   * Counts of each byte value in the data.
+   */
+  static void histogram(const char *data, quint64 len, quint32 counts[256]);
+
+private:
+  EntropyMap(quint64 size, quint32 blockSize);
+
+  quint64 size;
+  quint32 blockSize;
+  QVector<Block> blocks;
+};
+
+#endif // BMOD_ENTROPY_MAP_H
@@ -0,0 +1,322 @@
+#include <QtEndian>
+#include <QMutexLocker>
+#include <QtConcurrentMap>
+
+#include "ObjcIndex.h"
+
+namespace {
+  // Layout of the 64-bit runtime structures (objc4 objc-runtime-new.h).
+  const quint64 CLASS_DATA{32}, RO_NAME{24}, RO_METHODS{32};
+  const quint64 CAT_CLASS{8}, CAT_INST_METHODS{16}, CAT_CLASS_METHODS{24};
+
+  // Method lists of relative offsets instead of pointers.
+  const quint32 SMALL_METHOD_LIST{0x80000000};
+
+  // Class data pointers carry flags in the low bits.
+  const quint64 FAST_DATA_MASK{~quint64(7)};
+
+  // Limit of methods per list to avoid runaway reads of bad data.
+  const quint32 MAX_METHODS{1 << 16};
+}
+
+ObjcIndexPtr ObjcIndex::build(BinaryObjectPtr obj) {
+  if (!obj->getAddressSpace() || obj->getSystemBits() != 64) {
+    return nullptr;
+  }
+
+  auto index = ObjcIndexPtr(new ObjcIndex(obj));
+  foreach (const auto sec, obj->getSectionsByType(SectionType::ObjC)) {
+    bool category = (sec->getName() == "__objc_catlist");
+    if (sec->getName() == "__objc_selrefs") {
+      index->selRefs = sec;
+      continue;
+    }
+
+    // Only the lists are read here, the classes are decoded on demand.
+    for (quint64 pos = 0; pos + 8 <= sec->getSize(); pos += 8) {
+      bool ok;
+      quint64 addr = index->readPointer(sec->getAddress() + pos, &ok);
+      if (!ok || addr == 0) continue;
+      Class cls;
+      cls.addr = addr;
+      cls.category = category;
+      cls.decoded = false;
+      index->classes << cls;
+    }
+  }
+
+  if (index->classes.isEmpty() && !index->selRefs) {
+    return nullptr;
+  }
+  return index;
+}
+
+ObjcIndex::ObjcIndex(BinaryObjectPtr obj)
+  : space{obj->getAddressSpace()}, base{0}, impsIndexed{false},
+  selsIndexed{false}
+{
+  foreach (const auto &mapping, space->getMappings()) {
+    if (mapping.name == "__TEXT") {
+      base = mapping.addr;
+      break;
+    }
+  }
+  if (base == 0 && !space->getMappings().isEmpty()) {
+    base = space->getMappings().first().addr;
+  }
+}
+
+QString ObjcIndex::getClassName(int idx) {
+  QMutexLocker locker(&mutex);
+  if (idx < 0 || idx >= classes.size()) {
+    return QString();
+  }
+  auto &cls = classes[idx];
+  if (!cls.decoded) {
+    decode(cls);
+  }
+  return cls.name;
+}
+
+QVector<ObjcIndex::Method> ObjcIndex::getMethods(int idx) {
+  QMutexLocker locker(&mutex);
+  if (idx < 0 || idx >= classes.size()) {
+    return QVector<Method>();
+  }
+  auto &cls = classes[idx];
+  if (!cls.decoded) {
+    decode(cls);
+  }
+  return cls.methods;
+}
+
+bool ObjcIndex::getImplementationName(quint64 addr, QString &name) {
+  QMutexLocker locker(&mutex);
+  if (!impsIndexed) {
+    impsIndexed = true;
+
+    // Only the implementation addresses are read, without any names, and
+    // reading the mapping is done in parallel.
+    struct Job {
+      int idx;
+      QVector<quint64> imps;
+    };
+    QVector<Job> jobs(classes.size());
+    for (int i = 0; i < jobs.size(); i++) {
+      jobs[i].idx = i;
+    }
+    QtConcurrent::blockingMap(jobs, [this](Job &job) {
+        quint64 inst, meta;
+        getMethodLists(classes[job.idx], inst, meta);
+        readImps(inst, job.imps);
+        readImps(meta, job.imps);
+      });
+
+    foreach (const auto &job, jobs) {
+      foreach (quint64 imp, job.imps) {
+        if (imp != 0 && !impClasses.contains(imp)) {
+          impClasses[imp] = job.idx;
+        }
+      }
+    }
+  }
+
+  auto it = impClasses.constFind(addr);
+  if (it == impClasses.constEnd()) {
+    return false;
+  }
+  auto &cls = classes[it.value()];
+  if (!cls.decoded) {
+    decode(cls);
+  }
+  foreach (const auto &method, cls.methods) {
+    if (method.imp == addr) {
+      name = QString("%1[%2 %3]").arg(method.classMethod ? "+" : "-")
+        .arg(cls.name).arg(method.selector);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ObjcIndex::getSelector(quint64 ref, QString &sel) {
+  QMutexLocker locker(&mutex);
+  if (!selsIndexed) {
+    selsIndexed = true;
+    if (selRefs) {
+      quint64 addr = selRefs->getAddress();
+      for (quint64 pos = 0; pos + 8 <= selRefs->getSize(); pos += 8) {
+        bool ok;
+        quint64 str = readPointer(addr + pos, &ok);
+        if (ok) {
+          selectors[addr + pos] = readString(str);
+        }
+      }
+    }
+  }
+
+  auto it = selectors.constFind(ref);
+  if (it == selectors.constEnd() || it.value().isEmpty()) {
+    return false;
+  }
+  sel = it.value();
+  return true;
+}
+
+void ObjcIndex::decode(Class &cls) {
+  cls.decoded = true;
+
+  auto className = [this](quint64 addr) -> QString {
+    quint64 ro = readPointer(addr + CLASS_DATA) & FAST_DATA_MASK;
+    return readString(readPointer(ro + RO_NAME));
+  };
+
+  if (cls.category) {
+    // Categories are named like "Class(Category)". The class is unknown
+    // if it lives in another image.
+    QString name = readString(readPointer(cls.addr));
+    bool ok;
+    quint64 clsAddr = readPointer(cls.addr + CAT_CLASS, &ok);
+    QString clsName = (ok && clsAddr ? className(clsAddr) : QString());
+    cls.name = QString("%1(%2)")
+      .arg(clsName.isEmpty() ? QString("?") : clsName).arg(name);
+  }
+  else {
+    quint64 ro = readPointer(cls.addr + CLASS_DATA) & FAST_DATA_MASK;
+    cls.name = readString(readPointer(ro + RO_NAME));
+  }
+
+  quint64 inst, meta;
+  getMethodLists(cls, inst, meta);
+  readMethods(inst, false, cls.methods);
+  readMethods(meta, true, cls.methods);
+}
+
+void ObjcIndex::getMethodLists(const Class &cls, quint64 &inst,
+                               quint64 &meta) const {
+  inst = meta = 0;
+  if (cls.category) {
+    inst = readPointer(cls.addr + CAT_INST_METHODS);
+    meta = readPointer(cls.addr + CAT_CLASS_METHODS);
+    return;
+  }
+
+  quint64 ro = readPointer(cls.addr + CLASS_DATA) & FAST_DATA_MASK;
+  inst = readPointer(ro + RO_METHODS);
+
+  // Class methods are the instance methods of the metaclass.
+  bool ok;
+  quint64 metaCls = readPointer(cls.addr, &ok);
+  if (ok && metaCls) {
+    quint64 metaRo = readPointer(metaCls + CLASS_DATA) & FAST_DATA_MASK;
+    meta = readPointer(metaRo + RO_METHODS);
+  }
+}
+
+bool ObjcIndex::readListHeader(quint64 list, quint32 &count,
+                               quint32 &entSize, bool &relative) const {
+  bool ok;
+  quint32 flags = readUInt32(list, &ok);
+  count = readUInt32(list + 4);
+  if (!ok || list == 0 || count > MAX_METHODS) {
+    return false;
+  }
+
+  // Relative lists hold offsets to a selector reference, the types and
+  // the implementation, each relative to the field itself.
+  relative = (flags & SMALL_METHOD_LIST);
+  entSize = (flags & 0xFFFC);
+  return entSize >= (relative ? 12u : 24u);
+}
+
+void ObjcIndex::readMethods(quint64 list, bool classMethod,
+                            QVector<Method> &methods) {
+  quint32 count, entSize;
+  bool relative, ok;
+  if (!readListHeader(list, count, entSize, relative)) {
+    return;
+  }
+
+  for (quint32 i = 0; i < count; i++) {
+    quint64 entry = list + 8 + (quint64) i * entSize;
+    Method method;
+    method.classMethod = classMethod;
+    if (relative) {
+      qint32 nameOff = readUInt32(entry, &ok);
+      qint32 impOff = readUInt32(entry + 8);
+      if (!ok) break;
+      method.selector = readString(readPointer(entry + nameOff));
+      method.imp = (impOff == 0 ? 0 : entry + 8 + impOff);
+    }
+    else {
+      method.selector = readString(readPointer(entry, &ok));
+      method.imp = readPointer(entry + 16);
+      if (!ok) break;
+    }
+    methods << method;
+  }
+}
+
+void ObjcIndex::readImps(quint64 list, QVector<quint64> &imps) const {
+  quint32 count, entSize;
+  bool relative;
+  if (!readListHeader(list, count, entSize, relative)) {
+    return;
+  }
+
+  // The entries are read at once, a truncated list keeps those available.
+  QByteArray data = space->read(list + 8, (quint64) count * entSize);
+  const auto *ptr = (const uchar*) data.constData();
+  count = qMin(count, quint32(data.size() / entSize));
+  for (quint32 i = 0; i < count; i++) {
+    const auto *entry = ptr + (quint64) i * entSize;
+    if (relative) {
+      qint32 impOff = qFromLittleEndian<qint32>(entry + 8);
+      if (impOff != 0) {
+        imps << list + 8 + (quint64) i * entSize + 8 + impOff;
+      }
+    }
+    else {
+      imps << fixPointer(qFromLittleEndian<quint64>(entry + 16));
+    }
+  }
+}
+
+quint64 ObjcIndex::readPointer(quint64 addr, bool *ok) const {
+  QByteArray data = space->read(addr, 8);
+  if (data.size() < 8) {
+    if (ok) *ok = false;
+    return 0;
+  }
+  if (ok) *ok = true;
+  return fixPointer(qFromLittleEndian<quint64>(
+                      (const uchar*) data.constData()));
+}
+
+quint64 ObjcIndex::fixPointer(quint64 ptr) const {
+  // Pointers of chained fixups keep the target in the low 36 bits, as
+  // an address or as an offset from the image base.
+  if (ptr != 0 && space->findMapping(ptr) == -1) {
+    ptr &= 0xFFFFFFFFFULL;
+    if (ptr < base) {
+      ptr += base;
+    }
+  }
+  return ptr;
+}
+
+quint32 ObjcIndex::readUInt32(quint64 addr, bool *ok) const {
+  QByteArray data = space->read(addr, 4);
+  if (data.size() < 4) {
+    if (ok) *ok = false;
+    return 0;
+  }
+  if (ok) *ok = true;
+  return qFromLittleEndian<quint32>((const uchar*) data.constData());
+}
+
+QString ObjcIndex::readString(quint64 addr) const {
+  QByteArray data = space->read(addr, 1024);
+  return QString::fromUtf8(data.constData(),
+                           qstrnlen(data.constData(), data.size()));
+}
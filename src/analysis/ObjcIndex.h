@@ -0,0 +1,89 @@
+#ifndef BMOD_OBJC_INDEX_H
+#define BMOD_OBJC_INDEX_H
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <QString>
+
+#include <memory>
+
+#include "../BinaryObject.h"
+
+class ObjcIndex;
+typedef std::shared_ptr<ObjcIndex> ObjcIndexPtr;
+
+/**
+ * Objective-C classes, categories and selector references of a 64-bit
+ * Mach-O binary, read through the address space of the object.
+ *
+ * Only the class and category lists are read when built. A class is
+ * decoded the first time it is requested. The first implementation lookup
+ * only reads the implementation addresses of the method lists, and names
+ * are decoded for the class that is found.
+ */
+class ObjcIndex {
+public:
+  struct Method {
+    QString selector;
+    quint64 imp;
+    bool classMethod;
+  };
+
+  /**
+   * Index of the object, or null if it has no Objective-C metadata.
+   */
+  static ObjcIndexPtr build(BinaryObjectPtr obj);
+
+  /**
+   * Classes and categories, in the order of their lists.
+   */
+  int getClassCount() const { return classes.size(); }
+  QString getClassName(int idx);
+  QVector<Method> getMethods(int idx);
+
+  /**
+   * Name like "-[Class selector]" of the method implemented at the
+   * address.
+   */
+  bool getImplementationName(quint64 addr, QString &name);
+
+  /**
+   * Selector referenced by the selector reference at the address.
+   */
+  bool getSelector(quint64 ref, QString &sel);
+
+private:
+  struct Class {
+    quint64 addr;
+    bool category, decoded;
+    QString name;
+    QVector<Method> methods;
+  };
+
+  ObjcIndex(BinaryObjectPtr obj);
+
+  void decode(Class &cls);
+  void getMethodLists(const Class &cls, quint64 &inst, quint64 &meta) const;
+  bool readListHeader(quint64 list, quint32 &count, quint32 &entSize,
+                      bool &relative) const;
+  void readMethods(quint64 list, bool classMethod, QVector<Method> &methods);
+  void readImps(quint64 list, QVector<quint64> &imps) const;
+  quint64 readPointer(quint64 addr, bool *ok = nullptr) const;
+  quint64 fixPointer(quint64 ptr) const;
+  quint32 readUInt32(quint64 addr, bool *ok = nullptr) const;
+  QString readString(quint64 addr) const;
+
+  AddressSpacePtr space;
+  quint64 base; // Address of the first segment with file contents.
+
+  QMutex mutex;
+  QVector<Class> classes;
+  QHash<quint64, int> impClasses; // Implementation -> class index
+  bool impsIndexed;
+  QHash<quint64, QString> selectors; // Selector reference -> selector
+  SectionPtr selRefs;
+  bool selsIndexed;
+};
+
+#endif // BMOD_OBJC_INDEX_H
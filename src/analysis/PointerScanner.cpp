@@ -0,0 +1,267 @@
+#include <QtEndian>
+#include <QtConcurrentMap>
+
+#include <cstring>
+#include <algorithm>
+
+#include "PointerScanner.h"
+#include "XrefIndex.h"
+#include "../AddressSpace.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BMOD_POINTER_SCAN_SIMD
+#include <nmmintrin.h>
+#endif
+
+namespace {
+  // Segments are split so large ones are scanned on several threads.
+  const quint64 CHUNK_SIZE{4 << 20};
+
+  // VM protection bit of executable segments.
+  const quint32 VM_PROT_EXECUTE{4};
+
+  struct Range {
+    quint64 lo, hi;
+    bool code;
+  };
+
+  struct Job {
+    quint64 addr;
+    QByteArray data;
+    QVector<Reference> refs;
+  };
+
+  /**
+   * Range containing the value, or null. Ranges are sorted and disjoint.
+   */
+  const Range *findRange(const QVector<Range> &ranges, quint64 value) {
+    auto it = std::upper_bound(ranges.constBegin(), ranges.constEnd(), value,
+                               [](quint64 value, const Range &range) {
+                                 return value < range.lo;
+                               });
+    if (it == ranges.constBegin()) {
+      return nullptr;
+    }
+    --it;
+    return (value < it->hi ? it : nullptr);
+  }
+
+  /**
+   * Indices of the words in [lo, lo + span) as unsigned values, tested
+   * one at a time.
+   */
+  template <typename T>
+  void filterScalar(const uchar *data, quint64 count, quint64 lo,
+                    quint64 span, bool littleEndian, QVector<quint64> &hits) {
+    for (quint64 i = 0; i < count; i++) {
+      T value;
+      memcpy(&value, data + i * sizeof(T), sizeof(T));
+      value = (littleEndian ? qFromLittleEndian(value) : qFromBigEndian(value));
+      if (quint64(value) - lo < span) {
+        hits << i;
+      }
+    }
+  }
+
+#ifdef BMOD_POINTER_SCAN_SIMD
+  // Unsigned "x - lo < span" is done as a signed compare with the sign
+  // bits flipped.
+
+  void filter32Sse2(const uchar *data, quint64 count, quint32 lo, quint32 span,
+                    QVector<quint64> &hits) {
+    const __m128i bias = _mm_set1_epi32((int) 0x80000000);
+    const __m128i vlo = _mm_set1_epi32((int) lo);
+    const __m128i vspan = _mm_xor_si128(_mm_set1_epi32((int) span), bias);
+    quint64 i{0};
+    for (; i + 4 <= count; i += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i*) (data + i * 4));
+      v = _mm_xor_si128(_mm_sub_epi32(v, vlo), bias);
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(vspan, v)));
+      while (mask) {
+        hits << i + __builtin_ctz(mask);
+        mask &= mask - 1;
+      }
+    }
+    if (i < count) {
+      QVector<quint64> rest;
+      filterScalar<quint32>(data + i * 4, count - i, lo, span, true, rest);
+      foreach (quint64 idx, rest) {
+        hits << i + idx;
+      }
+    }
+  }
+
+  __attribute__((target("sse4.2")))
+  void filter64Sse42(const uchar *data, quint64 count, quint64 lo, quint64 span,
+                     QVector<quint64> &hits) {
+    const __m128i bias = _mm_set1_epi64x((qint64) 0x8000000000000000ULL);
+    const __m128i vlo = _mm_set1_epi64x((qint64) lo);
+    const __m128i vspan = _mm_xor_si128(_mm_set1_epi64x((qint64) span), bias);
+    quint64 i{0};
+    for (; i + 4 <= count; i += 4) {
+      __m128i a = _mm_loadu_si128((const __m128i*) (data + i * 8)),
+        b = _mm_loadu_si128((const __m128i*) (data + i * 8 + 16));
+      a = _mm_xor_si128(_mm_sub_epi64(a, vlo), bias);
+      b = _mm_xor_si128(_mm_sub_epi64(b, vlo), bias);
+      int mask =
+        _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(vspan, a))) |
+        (_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(vspan, b))) << 2);
+      while (mask) {
+        hits << i + __builtin_ctz(mask);
+        mask &= mask - 1;
+      }
+    }
+    if (i < count) {
+      QVector<quint64> rest;
+      filterScalar<quint64>(data + i * 8, count - i, lo, span, true, rest);
+      foreach (quint64 idx, rest) {
+        hits << i + idx;
+      }
+    }
+  }
+#endif
+
+  void scanJob(Job &job, const QVector<Range> &ranges, int wordSize,
+               bool littleEndian) {
+    // Words are aligned by address.
+    quint64 skip = (wordSize - job.addr % wordSize) % wordSize;
+    if ((quint64) job.data.size() <= skip) {
+      return;
+    }
+    const auto *data = (const uchar*) job.data.constData() + skip;
+    quint64 count = (job.data.size() - skip) / wordSize;
+    quint64 addr = job.addr + skip;
+
+    quint64 lo = ranges.first().lo, span = ranges.last().hi - lo;
+    QVector<quint64> hits;
+    if (wordSize == 8) {
+#ifdef BMOD_POINTER_SCAN_SIMD
+      static const bool sse42 = __builtin_cpu_supports("sse4.2");
+      if (littleEndian && sse42) {
+        filter64Sse42(data, count, lo, span, hits);
+      }
+      else
+#endif
+      filterScalar<quint64>(data, count, lo, span, littleEndian, hits);
+    }
+    else {
+      // Addresses of 32-bit objects are below 4 GiB.
+      span = qMin(span, quint64(0x100000000ULL) - qMin(lo, quint64(0x100000000ULL)));
+#ifdef BMOD_POINTER_SCAN_SIMD
+      if (littleEndian) {
+        filter32Sse2(data, count, lo, span, hits);
+      }
+      else
+#endif
+      filterScalar<quint32>(data, count, lo, span, littleEndian, hits);
+    }
+
+    foreach (quint64 idx, hits) {
+      quint64 value;
+      if (wordSize == 8) {
+        quint64 word;
+        memcpy(&word, data + idx * 8, 8);
+        value = (littleEndian ? qFromLittleEndian(word) : qFromBigEndian(word));
+      }
+      else {
+        quint32 word;
+        memcpy(&word, data + idx * 4, 4);
+        value = (littleEndian ? qFromLittleEndian(word) : qFromBigEndian(word));
+      }
+      const auto *range = findRange(ranges, value);
+      if (range) {
+        job.refs << Reference(addr + idx * wordSize, value, range->code ?
+                              Reference::Type::CodePointer :
+                              Reference::Type::DataPointer);
+      }
+    }
+    std::sort(job.refs.begin(), job.refs.end(), XrefIndex::lessByTarget);
+  }
+}
+
+QVector<Reference> PointerScanner::scan(BinaryObjectPtr obj) {
+  QVector<Reference> refs;
+  auto space = obj->getAddressSpace();
+  if (!space) {
+    return refs;
+  }
+
+  // Targets are the code sections and the rest of the mapped memory,
+  // split so the ranges are disjoint.
+  QVector<Range> code;
+  foreach (const auto sec, obj->getSections()) {
+    auto type = sec->getType();
+    if ((type == SectionType::Text || type == SectionType::SymbolStubs) &&
+        sec->getSize() > 0) {
+      code << Range{sec->getAddress(), sec->getAddress() + sec->getSize(), true};
+    }
+  }
+  std::sort(code.begin(), code.end(), [](const Range &a, const Range &b) {
+      return a.lo < b.lo;
+    });
+
+  QVector<Range> ranges;
+  int next{0};
+  foreach (const auto &mapping, space->getMappings()) {
+    quint64 pos = mapping.addr, end = mapping.addr + mapping.size;
+    while (next < code.size() && code[next].hi <= pos) next++;
+    for (int i = next; i < code.size() && code[i].lo < end; i++) {
+      if (code[i].lo > pos) {
+        ranges << Range{pos, code[i].lo, false};
+      }
+      ranges << Range{qMax(pos, code[i].lo), qMin(end, code[i].hi), true};
+      pos = qMin(end, code[i].hi);
+    }
+    if (pos < end) {
+      ranges << Range{pos, end, false};
+    }
+  }
+  if (ranges.isEmpty()) {
+    return refs;
+  }
+
+  // Symbol tables and other link edit data are not pointers.
+  QVector<Job> jobs;
+  foreach (const auto &mapping, space->getMappings()) {
+    if ((mapping.prot & VM_PROT_EXECUTE) || mapping.name == "__LINKEDIT" ||
+        mapping.fileSize == 0) {
+      continue;
+    }
+    quint64 size = qMin(mapping.size, mapping.fileSize);
+    for (quint64 pos = 0; pos < size; pos += CHUNK_SIZE) {
+      Job job;
+      job.addr = mapping.addr + pos;
+      job.data = space->read(job.addr, qMin(CHUNK_SIZE, size - pos));
+      jobs << job;
+    }
+  }
+
+  int wordSize = obj->getSystemBits() / 8;
+  bool littleEndian = obj->isLittleEndian();
+  QtConcurrent::blockingMap(jobs, [&ranges, wordSize, littleEndian](Job &job) {
+      scanJob(job, ranges, wordSize, littleEndian);
+    });
+
+  // Merge the sorted runs pairwise so each reference moves log(jobs)
+  // times.
+  QVector<int> runs;
+  foreach (const auto &job, jobs) {
+    runs << refs.size();
+    refs += job.refs;
+  }
+  runs << refs.size();
+  while (runs.size() > 2) {
+    QVector<int> merged;
+    for (int i = 0; i + 2 < runs.size(); i += 2) {
+      std::inplace_merge(refs.begin() + runs[i], refs.begin() + runs[i + 1],
+                         refs.begin() + runs[i + 2], XrefIndex::lessByTarget);
+      merged << runs[i];
+    }
+    if (runs.size() % 2 == 0) {
+      merged << runs[runs.size() - 2];
+    }
+    merged << runs.last();
+    runs = merged;
+  }
+  return refs;
+}
@@ -0,0 +1,27 @@
+#ifndef BMOD_POINTER_SCANNER_H
+#define BMOD_POINTER_SCANNER_H
+
+#include <QVector>
+
+#include "../BinaryObject.h"
+#include "../asm/Disassembler.h"
+
+/**
+ * Finds pointers stored in data, like function pointer tables, vtables
+ * and stray code references.
+ *
+ * Every aligned pointer-sized word of the non-executable segments is a
+ * candidate. Words are first tested against the range spanned by all
+ * segments several at a time, and only those inside are looked up in the
+ * sorted segment and code ranges.
+ */
+class PointerScanner {
+public:
+  /**
+   * References from the words to code (CodePointer) or other mapped
+   * memory (DataPointer). Empty if the object has no address space.
+   */
+  static QVector<Reference> scan(BinaryObjectPtr obj);
+};
+
+#endif // BMOD_POINTER_SCANNER_H
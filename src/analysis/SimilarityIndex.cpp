@@ -0,0 +1,239 @@
+#include <QFile>
+#include <QDataStream>
+#include <QtConcurrentMap>
+
+#include "../Util.h"
+#include "SimilarityIndex.h"
+#include "ControlFlowGraph.h"
+#include "../asm/Disassembler.h"
+
+namespace {
+  const quint32 MAGIC{0x424D5349}; // "BMSI"
+  const quint32 VERSION{1};
+
+  struct Job {
+    quint64 addr;
+    quint32 firstBlock, blockCount;
+    SectionPtr sec;
+    QVector<quint32> sig;
+  };
+
+  struct MatchJob {
+    int func;
+    bool found;
+    SimilarityIndex::Match match;
+  };
+}
+
+SimilarityIndexPtr SimilarityIndex::build(BinaryObjectPtr obj) {
+  QList<SectionPtr> secs;
+  foreach (auto sec, obj->getSections()) {
+    auto type = sec->getType();
+    if (type == SectionType::Text || type == SectionType::SymbolStubs) {
+      secs << sec;
+    }
+  }
+
+  auto cfg = obj->getControlFlowGraph();
+  QVector<Job> jobs;
+  foreach (const auto &func, cfg->getFunctions()) {
+    foreach (auto sec, secs) {
+      quint64 addr = sec->getAddress();
+      if (func.addr >= addr && func.addr < addr + sec->getSize()) {
+        Job job;
+        job.addr = func.addr;
+        job.firstBlock = func.firstBlock;
+        job.blockCount = func.blockCount;
+        job.sec = sec;
+        jobs << job;
+        break;
+      }
+    }
+  }
+
+  const auto &blocks = cfg->getBlocks();
+  QtConcurrent::blockingMap(jobs, [obj, &blocks](Job &job) {
+      // Blocks of a function are stored in address order. They are
+      // decoded in the section so relocations apply as in the graph.
+      Disassembler dis(obj);
+      quint64 secAddr = job.sec->getAddress();
+      QList<quint32> shapes;
+      for (quint32 i = 0; i < job.blockCount; i++) {
+        const auto &block = blocks[job.firstBlock + i];
+        Disassembly result;
+        if (dis.disassemble(job.sec, block.addr - secAddr, block.size,
+                            result)) {
+          shapes += result.shapes;
+        }
+      }
+      if (shapes.size() < MinInstructions) {
+        return;
+      }
+
+      // Each slot keeps the minimum of its own hash over all shingles.
+      job.sig.fill(0xFFFFFFFF, SignatureSize);
+      for (int i = 0; i + ShingleSize <= shapes.size(); i++) {
+        quint32 shingle{0};
+        for (int j = 0; j < ShingleSize; j++) {
+          shingle = mix(shingle ^ shapes[i + j]);
+        }
+        for (int k = 0; k < SignatureSize; k++) {
+          quint32 value = mix(shingle + k * 0x9E3779B9u);
+          if (value < job.sig[k]) {
+            job.sig[k] = value;
+          }
+        }
+      }
+    });
+
+  auto index = SimilarityIndexPtr(new SimilarityIndex);
+  foreach (const auto &job, jobs) {
+    if (!job.sig.isEmpty()) {
+      index->addFunction(job.addr, Util::functionName(obj, job.addr), job.sig);
+    }
+  }
+  return index;
+}
+
+SimilarityIndexPtr SimilarityIndex::load(const QString &file) {
+  QFile f(file);
+  if (!f.open(QIODevice::ReadOnly)) {
+    return nullptr;
+  }
+
+  QDataStream stream(&f);
+  stream.setVersion(QDataStream::Qt_5_0);
+  quint32 magic, version, sigSize, count;
+  stream >> magic >> version >> sigSize >> count;
+  if (stream.status() != QDataStream::Ok || magic != MAGIC ||
+      version != VERSION || sigSize != SignatureSize) {
+    return nullptr;
+  }
+
+  auto index = SimilarityIndexPtr(new SimilarityIndex);
+  QVector<quint32> sig(SignatureSize);
+  for (quint32 i = 0; i < count; i++) {
+    quint64 addr;
+    QString name;
+    stream >> addr >> name;
+    for (int k = 0; k < SignatureSize; k++) {
+      stream >> sig[k];
+    }
+    if (stream.status() != QDataStream::Ok) {
+      return nullptr;
+    }
+    index->addFunction(addr, name, sig);
+  }
+  return index;
+}
+
+bool SimilarityIndex::save(const QString &file) const {
+  QFile f(file);
+  if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+
+  QDataStream stream(&f);
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << MAGIC << VERSION << (quint32) SignatureSize
+         << (quint32) addrs.size();
+  for (int i = 0; i < addrs.size(); i++) {
+    stream << addrs[i] << names[i];
+    const quint32 *sig = getSignature(i);
+    for (int k = 0; k < SignatureSize; k++) {
+      stream << sig[k];
+    }
+  }
+  return stream.status() == QDataStream::Ok;
+}
+
+QList<SimilarityIndex::Match>
+SimilarityIndex::match(const SimilarityIndex &other,
+                       float minSimilarity) const {
+  QVector<MatchJob> jobs(addrs.size());
+  for (int i = 0; i < jobs.size(); i++) {
+    jobs[i].func = i;
+    jobs[i].found = false;
+  }
+
+  QtConcurrent::blockingMap(jobs, [this, &other, minSimilarity](MatchJob &job) {
+      float similarity;
+      int best = other.findBest(getSignature(job.func), similarity);
+      if (best == -1 || similarity < minSimilarity) {
+        return;
+      }
+      job.found = true;
+      job.match.addr = addrs[job.func];
+      job.match.name = names[job.func];
+      job.match.other = other.addrs[best];
+      job.match.otherName = other.names[best];
+      job.match.similarity = similarity;
+    });
+
+  QList<Match> res;
+  foreach (const auto &job, jobs) {
+    if (job.found) {
+      res << job.match;
+    }
+  }
+  return res;
+}
+
+void SimilarityIndex::addFunction(quint64 addr, const QString &name,
+                                  const QVector<quint32> &sig) {
+  quint32 func = addrs.size();
+  addrs << addr;
+  names << name;
+  sigs += sig;
+  for (int band = 0; band < Bands; band++) {
+    buckets[bandKey(band, sig.constData())] << func;
+  }
+}
+
+const quint32 *SimilarityIndex::getSignature(int func) const {
+  return sigs.constData() + func * SignatureSize;
+}
+
+int SimilarityIndex::findBest(const quint32 *sig, float &similarity) const {
+  // Only functions sharing at least one band are compared.
+  QHash<quint32, bool> seen;
+  int best{-1}, bestEqual{0};
+  for (int band = 0; band < Bands; band++) {
+    auto it = buckets.constFind(bandKey(band, sig));
+    if (it == buckets.constEnd()) continue;
+    foreach (quint32 func, it.value()) {
+      if (seen.contains(func)) continue;
+      seen.insert(func, true);
+
+      const quint32 *sig2 = getSignature(func);
+      int equal{0};
+      for (int k = 0; k < SignatureSize; k++) {
+        if (sig[k] == sig2[k]) equal++;
+      }
+      if (equal > bestEqual) {
+        bestEqual = equal;
+        best = func;
+      }
+    }
+  }
+  similarity = (float) bestEqual / (float) SignatureSize;
+  return best;
+}
+
+quint32 SimilarityIndex::mix(quint32 value) {
+  // Finalizer of MurmurHash3.
+  value ^= value >> 16;
+  value *= 0x85EBCA6Bu;
+  value ^= value >> 13;
+  value *= 0xC2B2AE35u;
+  value ^= value >> 16;
+  return value;
+}
+
+quint64 SimilarityIndex::bandKey(int band, const quint32 *sig) {
+  quint32 hash = band;
+  for (int r = 0; r < BandRows; r++) {
+    hash = mix(hash ^ sig[band * BandRows + r]);
+  }
+  return (quint64) band << 32 | hash;
+}
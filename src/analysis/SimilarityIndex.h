@@ -0,0 +1,83 @@
+#ifndef BMOD_SIMILARITY_INDEX_H
+#define BMOD_SIMILARITY_INDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+#include "../BinaryObject.h"
+
+class SimilarityIndex;
+typedef std::shared_ptr<SimilarityIndex> SimilarityIndexPtr;
+
+/**
+ * Function fingerprints for finding the same functions in another build.
+ *
+ * Each function is reduced to its instruction shapes (see
+ * Disassembly::shapes) in address order. Runs of three consecutive
+ * shapes are hashed into a MinHash signature whose slots estimate the
+ * Jaccard similarity of two functions. Signatures are split into bands
+ * and functions sharing any band end up in the same bucket, so only
+ * those are compared when matching (locality-sensitive hashing).
+ */
+class SimilarityIndex {
+public:
+  enum {
+    SignatureSize = 64,
+    Bands = 16,
+    BandRows = SignatureSize / Bands,
+    ShingleSize = 3,
+
+    // Functions with fewer instructions are too generic to match.
+    MinInstructions = 6
+  };
+
+  struct Match {
+    quint64 addr; // In this index.
+    quint64 other; // In the other index.
+    QString name, otherName;
+    float similarity; // Estimated Jaccard similarity in [0, 1].
+  };
+
+  /**
+   * Fingerprint the recovered functions of the object in parallel.
+   */
+  static SimilarityIndexPtr build(BinaryObjectPtr obj);
+
+  /**
+   * Load an index saved with save(). Returns nullptr on failure.
+   */
+  static SimilarityIndexPtr load(const QString &file);
+  bool save(const QString &file) const;
+
+  int getCount() const { return addrs.size(); }
+  quint64 getAddress(int func) const { return addrs[func]; }
+  const QString &getName(int func) const { return names[func]; }
+
+  /**
+   * Find the best match in other for each function of this index with
+   * at least minSimilarity estimated similarity. Ordered by address.
+   */
+  QList<Match> match(const SimilarityIndex &other,
+                     float minSimilarity = 0.5) const;
+
+private:
+  void addFunction(quint64 addr, const QString &name,
+                   const QVector<quint32> &sig);
+  const quint32 *getSignature(int func) const;
+  int findBest(const quint32 *sig, float &similarity) const;
+
+  static quint32 mix(quint32 value);
+  static quint64 bandKey(int band, const quint32 *sig);
+
+  QVector<quint64> addrs;
+  QStringList names;
+  QVector<quint32> sigs; // SignatureSize values per function.
+  QHash<quint64, QVector<quint32>> buckets; // band key -> functions
+};
+
+#endif // BMOD_SIMILARITY_INDEX_H
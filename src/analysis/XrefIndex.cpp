@@ -0,0 +1,102 @@
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+#include "XrefIndex.h"
+#include "PointerScanner.h"
+
+namespace {
+  struct Job {
+    SectionPtr sec;
+    QVector<Reference> refs;
+  };
+}
+
+XrefIndex::XrefIndex(QVector<Reference> refs, bool sorted) {
+  if (!sorted) {
+    std::sort(refs.begin(), refs.end(), lessByTarget);
+  }
+
+  int size = refs.size();
+  sources.reserve(size);
+  types.reserve(size);
+  for (int i = 0; i < size; i++) {
+    const auto &ref = refs[i];
+    if (i == 0 || ref.to != refs[i - 1].to) {
+      lookup.insert(ref.to, targets.size());
+      targets << ref.to;
+      offsets << i;
+    }
+    sources << ref.from;
+    types << ref.type;
+  }
+  offsets << size;
+}
+
+XrefIndexPtr XrefIndex::build(BinaryObjectPtr obj) {
+  QVector<Job> jobs;
+  foreach (auto sec, obj->getSections()) {
+    auto type = sec->getType();
+    if (type == SectionType::Text || type == SectionType::SymbolStubs) {
+      Job job;
+      job.sec = sec;
+      jobs << job;
+    }
+  }
+
+  // Each section is disassembled and sorted on its own thread.
+  QtConcurrent::blockingMap(jobs, [obj](Job &job) {
+      Disassembler dis(obj);
+      Disassembly result;
+      if (!dis.disassemble(job.sec, result)) {
+        return;
+      }
+      job.refs.reserve(result.references.size());
+      foreach (const auto &ref, result.references) {
+        job.refs << ref;
+      }
+      std::sort(job.refs.begin(), job.refs.end(), lessByTarget);
+    });
+
+  QVector<Reference> refs;
+  foreach (const auto &job, jobs) {
+    int mid = refs.size();
+    refs += job.refs;
+    std::inplace_merge(refs.begin(), refs.begin() + mid, refs.end(),
+                       lessByTarget);
+  }
+
+  // Pointers stored in the data segments.
+  int mid = refs.size();
+  refs += PointerScanner::scan(obj);
+  std::inplace_merge(refs.begin(), refs.begin() + mid, refs.end(),
+                     lessByTarget);
+
+  return XrefIndexPtr(new XrefIndex(refs, true));
+}
+
+int XrefIndex::getCount(quint64 addr) const {
+  auto it = lookup.constFind(addr);
+  if (it == lookup.constEnd()) {
+    return 0;
+  }
+  quint32 row = it.value();
+  return offsets[row + 1] - offsets[row];
+}
+
+QVector<Reference> XrefIndex::getReferences(quint64 addr) const {
+  QVector<Reference> res;
+  auto it = lookup.constFind(addr);
+  if (it == lookup.constEnd()) {
+    return res;
+  }
+  quint32 row = it.value();
+  for (quint32 i = offsets[row]; i < offsets[row + 1]; i++) {
+    res << Reference(sources[i], addr, types[i]);
+  }
+  return res;
+}
+
+bool XrefIndex::lessByTarget(const Reference &a, const Reference &b) {
+  return a.to < b.to || (a.to == b.to && a.from < b.from);
+}
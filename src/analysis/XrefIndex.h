@@ -0,0 +1,55 @@
+#ifndef BMOD_XREF_INDEX_H
+#define BMOD_XREF_INDEX_H
+
+#include <QHash>
+#include <QVector>
+
+#include <memory>
+
+#include "../BinaryObject.h"
+#include "../asm/Disassembler.h"
+
+class XrefIndex;
+typedef std::shared_ptr<XrefIndex> XrefIndexPtr;
+
+/**
+ * Cross-reference index mapping referenced addresses to the
+ * instructions and data words referring to them.
+ *
+ * Stored in compressed sparse row form: the referrers of target i are
+ * sources[offsets[i]] to sources[offsets[i + 1] - 1].
+ */
+class XrefIndex {
+public:
+  XrefIndex(QVector<Reference> refs, bool sorted = false);
+
+  /**
+   * Disassemble the code sections of the object in parallel and index
+   * all references found, along with the pointers in its data.
+   */
+  static XrefIndexPtr build(BinaryObjectPtr obj);
+
+  /**
+   * Number of references to the address.
+   */
+  int getCount(quint64 addr) const;
+
+  /**
+   * References to the address ordered by referring address.
+   */
+  QVector<Reference> getReferences(quint64 addr) const;
+
+  int getTargetCount() const { return targets.size(); }
+  int getReferenceCount() const { return sources.size(); }
+
+  static bool lessByTarget(const Reference &a, const Reference &b);
+
+private:
+  QVector<quint64> targets;
+  QVector<quint32> offsets;
+  QVector<quint64> sources;
+  QVector<Reference::Type> types;
+  QHash<quint64, quint32> lookup; // target -> row
+};
+
+#endif // BMOD_XREF_INDEX_H
@@ -8,6 +8,10 @@ class Asm {
 public:
   virtual ~Asm() { }
   virtual bool disassemble(SectionPtr sec, Disassembly &result) =0;
+  virtual bool disassemble(SectionPtr sec, qint64 pos, qint64 len,
+                           Disassembly &result) =0;
+  virtual bool disassembleRun(SectionPtr sec, qint64 pos,
+                              Disassembly &result) =0;
 };
 
 #endif // BMOD_ASM_H
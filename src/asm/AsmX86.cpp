@@ -19,7 +19,8 @@
 #include "../Section.h"
 
 namespace {
-  QString Instruction::toString(BinaryObjectPtr obj) const {
+  QString Instruction::toString(BinaryObjectPtr obj,
+                                const QString &relocSymbol) const {
     QString str(mnemonic);
     switch (dataType) {
     case DataType::None:
@@ -46,11 +47,12 @@ namespace {
     // Annotate calls with symbols if present.
     if (call && dispDst) {
       str += " " + getDispString();
-      quint64 addr = disp + offset;
+      quint64 addr = (rel ? getTarget() : disp + offset);
       const auto &symTable = obj->getSymbolTable();
       const auto &dynsymTable = obj->getDynSymbolTable();
-      QString name;
-      if (symTable.getString(addr, name) || dynsymTable.getString(addr, name)) {
+      QString name{relocSymbol};
+      if (!name.isEmpty() || symTable.getString(addr, name) ||
+          dynsymTable.getString(addr, name)) {
         str += " (" + name + ")";
       }
       return str;
@@ -130,6 +132,9 @@ namespace {
       if (!str.endsWith(" ")) str += " ";
       str += getImmString();
     }
+    if (!relocSymbol.isEmpty()) {
+      str += " (" + relocSymbol + ")";
+    }
     return str;
   }
 
@@ -206,9 +211,36 @@ namespace {
   }
 
   QString Instruction::getDispString() const {
+    if (rel) {
+      return formatHex(getTarget(), dispBytes * 2);
+    }
     return formatHex(disp + offset, dispBytes * 2);
   }
 
+  quint64 Instruction::getTarget() const {
+    // Displacements of relative branches are signed.
+    qint64 delta = (dispBytes == 1 ? (qint64) (qint8) disp
+                    : (qint64) (qint32) disp);
+    return offset + delta;
+  }
+
+  quint32 Instruction::getShape() const {
+    quint32 shape = qHash(mnemonic);
+    auto mix = [&shape](quint32 value) {
+      shape = (shape ^ value) * 16777619u; // FNV-1a prime
+    };
+    mix((quint32) dataType);
+    mix(srcRegSet ? srcReg : 0xFF);
+    mix(dstRegSet ? dstReg : 0xFF);
+    mix((quint32) srcRegType << 8 | (quint32) dstRegType);
+    if (sipSrc || sipDst) {
+      mix(scale << 16 | index << 8 | base);
+    }
+    mix(sipSrc | sipDst << 1 | dispSrc << 2 | dispDst << 3 | immSrc << 4 |
+        immDst << 5);
+    return shape;
+  }
+
   QString Instruction::getImmString() const {
     return "$" + formatHex(imm + offset, immBytes * 2);
   }
@@ -216,15 +248,46 @@ namespace {
   QString Instruction::formatHex(quint64 num, int len) const {
     return "0x" + Util::padString(QString::number(num, 16).toUpper(), len);
   }
+
+  /**
+   * Mnemonic of the conditional jump with condition code cc, the low
+   * nibble of the Jcc opcode.
+   */
+  QString condJump(unsigned char cc) {
+    static const char *names[] = {"jo", "jno", "jb", "jae", "je", "jne",
+                                  "jbe", "ja", "js", "jns", "jp", "jnp",
+                                  "jl", "jge", "jle", "jg"};
+    return names[cc & 0xF];
+  }
 }
 
-AsmX86::AsmX86(BinaryObjectPtr obj) : obj{obj}, reader{nullptr} { }
+AsmX86::AsmX86(BinaryObjectPtr obj) : obj{obj}, reader{nullptr}, secAddr{0} { }
 
 bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
+  return disassemble(sec, 0, -1, false, result);
+}
+
+bool AsmX86::disassemble(SectionPtr sec, qint64 pos, qint64 len,
+                         Disassembly &result) {
+  return disassemble(sec, pos, pos + len, false, result);
+}
+
+bool AsmX86::disassembleRun(SectionPtr sec, qint64 pos, Disassembly &result) {
+  return disassemble(sec, pos, -1, true, result);
+}
+
+bool AsmX86::disassemble(SectionPtr sec, qint64 start, qint64 end, bool run,
+                         Disassembly &result) {
+  auto snap = sec->getSnapshot();
   QBuffer buf;
-  buf.setData(sec->getData());
+  buf.setData(snap.data);
   buf.open(QIODevice::ReadOnly);
   reader.reset(new Reader(buf));
+  secAddr = sec->getAddress();
+  relocs = sec->getRelocations();
+  if (!reader->seek(start)) {
+    return false;
+  }
 
   // Address of main()
   quint64 funcAddr = sec->getAddress();
@@ -234,7 +297,18 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
   qint64 pos{0};
   Instruction inst;
   const bool _64 = (obj->getSystemBits() == 64);
-  while (!reader->atEnd()) {
+  const int firstFlow = result.flows.size();
+  while (!reader->atEnd() && (end == -1 || reader->pos() < end)) {
+    // A run ends at the first instruction that does not fall through.
+    if (run && result.flows.size() > firstFlow) {
+      auto flow = result.flows.last();
+      if (flow == FlowType::Jump || flow == FlowType::IndirectJump ||
+          flow == FlowType::Return || flow == FlowType::Stop ||
+          flow == FlowType::Invalid) {
+        break;
+      }
+    }
+
     // Handle special NOP sequences.
     if (handleNops(result)) {
       continue;
@@ -396,6 +470,14 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       addResult(inst, pos, result);
     }
 
+    // CMP (r/m16/32  r16/32) (reverse of 0x3B)
+    else if (ch == 0x39 && peek) {
+      inst.mnemonic = "cmp";
+      processModRegRM(inst);
+      inst.reverse();
+      addResult(inst, pos, result);
+    }
+
     // CMP (r16/32 r/m16/32)
     else if (ch == 0x3B && peek) {
       inst.mnemonic = "cmp";
@@ -457,14 +539,15 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       addResult(inst, pos, result);
     }
 
-    // JNZ (rel8) or JNE (rel8)
-    // Short jump
-    else if (ch == 0x75 && peek) {
-      inst.mnemonic = "jne";
-      inst.disp = pos - (255 - (int) reader->getUChar()) + 1;
+    // Jcc (rel8)
+    // Short conditional jump
+    else if (ch >= 0x70 && ch <= 0x7F && peek) {
+      inst.mnemonic = condJump(ch);
+      inst.disp = reader->getUChar();
       inst.dispBytes = 1;
       inst.dispDst = true;
-      inst.offset = funcAddr;
+      inst.offset = funcAddr + reader->pos();
+      inst.rel = inst.cond = true;
       inst.dataType = DataType::None;
       addResult(inst, pos, result);
     }
@@ -730,7 +813,7 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
 
     // RETN
     else if (ch == 0xC3) {
-      addResult("ret", pos, result);
+      addResult("ret", pos, result, FlowType::Return);
     }
 
     // MOV (r/m8  imm8)
@@ -761,6 +844,17 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       addResult(inst, pos, result);
     }
 
+    // LEAVE
+    else if (ch == 0xC9) {
+      addResult("leave", pos, result);
+    }
+
+    // INT3 (breakpoint trap, also used as padding after calls that do not
+    // return)
+    else if (ch == 0xCC) {
+      addResult("int3", pos, result, FlowType::Stop);
+    }
+
     // Call (relative function address)
     else if (ch == 0xE8) {
       inst.mnemonic = "call";
@@ -768,7 +862,7 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       inst.dispBytes = 4;
       inst.dispDst = true;
       inst.offset = funcAddr + reader->pos();
-      inst.call = true;
+      inst.call = inst.rel = true;
       if (_64) inst.dataType = DataType::Quadword;
       addResult(inst, pos, result);
     }
@@ -781,6 +875,7 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       inst.dispBytes = 4;
       inst.dispDst = true;
       inst.offset = funcAddr + reader->pos();
+      inst.rel = true;
       addResult(inst, pos, result);
     }
 
@@ -792,12 +887,13 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       inst.dispBytes = 1;
       inst.dispDst = true;
       inst.offset = funcAddr + reader->pos();
+      inst.rel = true;
       addResult(inst, pos, result);
     }
 
     // HLT
     else if (ch == 0xF4) {
-      addResult("hlt", pos, result);
+      addResult("hlt", pos, result, FlowType::Stop);
     }
 
     // INC, DEC, CALL, CALLF, JMP, JMPF, PUSH
@@ -817,20 +913,22 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
       }
       else if (inst.dstReg == 2) {
         inst.mnemonic = "call *";
-        inst.call = true;
+        inst.call = inst.indirect = true;
         inst.dataType = DataType::None;
       }
       else if (inst.dstReg == 3) {
         inst.mnemonic = "callf";
-        inst.call = true;
+        inst.call = inst.indirect = true;
         inst.dataType = DataType::None;
       }
       else if (inst.dstReg == 4) {
         inst.mnemonic = "jmp *";
+        inst.indirect = true;
         inst.dataType = DataType::None;
       }
       else if (inst.dstReg == 5) {
         inst.mnemonic = "jmpf";
+        inst.indirect = true;
         inst.dataType = DataType::None;
       }
       else if (inst.dstReg == 6) {
@@ -856,82 +954,14 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
         addResult(inst, pos, result);
       }
 
-      // JNB (rel16/32), JAE (rel16/32), or JNC (rel16/32).
-      else if (ch == 0x83) {
-        inst.mnemonic = "jae";
-        inst.disp = reader->getUInt32();
-        inst.dispBytes = 4;
-        inst.dispDst = true;
-        inst.offset = funcAddr + reader->pos();
-        inst.dataType = DataType::None;
-        addResult(inst, pos, result);
-      }
-
-      // JZ (rel16/32) or JE (rel16/32), same functionality different
-      // name. Relative function address.
-      else if (ch == 0x84) {
-        inst.mnemonic = "je";
-        inst.disp = reader->getUInt32();
-        inst.dispBytes = 4;
-        inst.dispDst = true;
-        inst.offset = funcAddr + reader->pos();
-        inst.dataType = DataType::None;
-        addResult(inst, pos, result);
-      }
-
-      // JNZ (rel16/32) or JNE (rel16/32), same functionality
-      // different name. Relative function address.
-      else if (ch == 0x85) {
-        inst.mnemonic = "jne";
-        inst.disp = reader->getUInt32();
-        inst.dispBytes = 4;
-        inst.dispDst = true;
-        inst.offset = funcAddr + reader->pos();
-        inst.dataType = DataType::None;
-        addResult(inst, pos, result);
-      }
-
-      // JA (rel16/32) or JNBE (rel16/32)
-      else if (ch == 0x87) {
-        inst.mnemonic = "ja";
-        inst.disp = reader->getUInt32();
-        inst.dispBytes = 4;
-        inst.dispDst = true;
-        inst.offset = funcAddr + reader->pos();
-        inst.dataType = DataType::None;
-        addResult(inst, pos, result);
-      }
-
-      // JNL (rel16/32) or JGE (rel16/32).
-      else if (ch == 0x8D) {
-        inst.mnemonic = "jge";
-        inst.disp = reader->getUInt32();
-        inst.dispBytes = 4;
-        inst.dispDst = true;
-        inst.offset = funcAddr + reader->pos();
-        inst.dataType = DataType::None;
-        addResult(inst, pos, result);
-      }
-
-      // JLE (rel16/32) or JNG (rel16/32), same functionality
-      // different name. Relative function address.
-      else if (ch == 0x8E) {
-        inst.mnemonic = "jle";
-        inst.disp = reader->getUInt32();
-        inst.dispBytes = 4;
-        inst.dispDst = true;
-        inst.offset = funcAddr + reader->pos();
-        inst.dataType = DataType::None;
-        addResult(inst, pos, result);
-      }
-
-      // JNLE (rel16/32) or JG (rel16/32).
-      else if (ch == 0x8F) {
-        inst.mnemonic = "jg";
+      // Jcc (rel16/32) (relative function address)
+      else if (ch >= 0x80 && ch <= 0x8F) {
+        inst.mnemonic = condJump(ch);
         inst.disp = reader->getUInt32();
         inst.dispBytes = 4;
         inst.dispDst = true;
         inst.offset = funcAddr + reader->pos();
+        inst.rel = inst.cond = true;
         inst.dataType = DataType::None;
         addResult(inst, pos, result);
       }
@@ -969,18 +999,41 @@ bool AsmX86::disassemble(SectionPtr sec, Disassembly &result) {
         processModRegRM(inst);
         addResult(inst, pos, result);
       }
+
+      // Unsupported
+      else {
+        addResult("Unsupported: 0F " + QString::number(ch, 16).toUpper(),
+                  pos, result, FlowType::Invalid);
+      }
     }
 
     // Unsupported
     else {
       addResult("Unsupported: " + QString::number(ch, 16).toUpper(),
-                pos, result);
+                pos, result, FlowType::Invalid);
     }
   }
 
   return !result.asmLines.isEmpty();
 }
 
+const QList<AsmX86::NopForm> &AsmX86::getNopForms() {
+  static const QList<NopForm> forms{
+    {QByteArray("\x66\x2e\x0f\x1f\x84\x00\x00\x00\x00\x00", 10),
+        "nopw %cs:0L(%eax,%eax,1)"},
+    {QByteArray("\x66\x0f\x1f\x84\x00\x00\x00\x00\x00", 9),
+        "nopw 0L(%eax,%eax,1)"},
+    {QByteArray("\x0f\x1f\x84\x00\x00\x00\x00\x00", 8),
+        "nopl 0L(%eax,%eax,1)"},
+    {QByteArray("\x0f\x1f\x80\x00\x00\x00\x00", 7), "nopl 0L(%eax)"},
+    {QByteArray("\x66\x0f\x1f\x44\x00\x00", 6), "nopw 0x0(%eax,%eax,1)"},
+    {QByteArray("\x0f\x1f\x44\x00\x00", 5), "nopl 0x0(%eax,%eax,1)"},
+    {QByteArray("\x0f\x1f\x00", 3), "nopl 0x0(%eax)"},
+    {QByteArray("\x66\x90", 2), "xchg %ax,%ax"}
+  };
+  return forms;
+}
+
 bool AsmX86::handleNops(Disassembly &result) {
   qint64 pos = reader->pos();
 
@@ -989,53 +1042,87 @@ bool AsmX86::handleNops(Disassembly &result) {
     reader->read(1);
   }
 
-  if (reader->peekList({0x66, 0x2e, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00})) {
-    reader->read(10);
-    addResult("nopw %cs:0L(%eax,%eax,1)", pos, result);
-  }
-  else if (reader->peekList({0x66, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00})) {
-    reader->read(9);
-    addResult("nopw 0L(%eax,%eax,1)", pos, result);
-  }
-  else if (reader->peekList({0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00})) {
-    reader->read(8);
-    addResult("nopl 0L(%eax,%eax,1)", pos, result);
+  foreach (const auto &form, getNopForms()) {
+    if (reader->peekList(form.bytes)) {
+      reader->read(form.bytes.size());
+      addResult(form.mnemonic, pos, result);
+      return true;
+    }
   }
-  else if (reader->peekList({0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00})) {
-    reader->read(7);
-    addResult("nopl 0L(%eax)", pos, result);
+  return false;
+}
+
+void AsmX86::addResult(const Instruction &inst, qint64 pos,
+                       Disassembly &result) {
+  QString relocSymbol;
+  if (relocs) {
+    auto *reloc = relocs->find(pos, reader->pos());
+    if (reloc) {
+      relocSymbol = reloc->symbol;
+    }
   }
-  else if (reader->peekList({0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00})) {
-    reader->read(6);
-    addResult("nopw 0x0(%eax,%eax,1)", pos, result);
+  addLine(inst.toString(obj, relocSymbol), pos, getFlow(inst),
+          inst.getShape(), result);
+  addReference(inst, pos, result);
+}
+
+FlowType AsmX86::getFlow(const Instruction &inst) const {
+  if (inst.indirect) {
+    return (inst.call ? FlowType::IndirectCall : FlowType::IndirectJump);
   }
-  else if (reader->peekList({0x0f, 0x1f, 0x44, 0x00, 0x00})) {
-    reader->read(5);
-    addResult("nopl 0x0(%eax,%eax,1)", pos, result);
+  if (!inst.rel) {
+    return FlowType::Next;
   }
-  else if (reader->peekList({0x0f, 0x1f, 0x00})) {
-    reader->read(3);
-    addResult("nopl 0x0(%eax)", pos, result);
+  if (inst.call) {
+    return FlowType::Call;
   }
-  else if (reader->peekList({0x66, 0x90})) {
-    reader->read(2);
-    addResult("xchg %ax,%ax", pos, result);
+  return (inst.cond ? FlowType::CondJump : FlowType::Jump);
+}
+
+void AsmX86::addReference(const Instruction &inst, qint64 pos,
+                          Disassembly &result) {
+  quint64 from = secAddr + pos;
+  if (inst.rel) {
+    // Branches to symbols of object files hold no real displacement until
+    // linked, so the target is that of the relocation if it is known.
+    quint64 to = inst.getTarget();
+    const auto *reloc = (relocs ? relocs->find(pos, reader->pos()) : nullptr);
+    if (reloc && (reloc->external || reloc->scattered)) {
+      if (!reloc->resolved) return;
+      to = reloc->value;
+    }
+
+    auto type = Reference::Type::Jump;
+    if (inst.call) {
+      type = Reference::Type::Call;
+    }
+    else if (inst.cond) {
+      type = Reference::Type::CondJump;
+    }
+    result.references << Reference(from, to, type);
   }
-  else {
-    return false;
+  else if (inst.ripRel) {
+    // RIP points to the next instruction. On 32-bit the displacement
+    // is an absolute address.
+    quint64 to = inst.disp;
+    if (obj->getSystemBits() == 64) {
+      to = secAddr + reader->pos() + (qint32) inst.disp;
+    }
+    result.references << Reference(from, to, Reference::Type::Data);
   }
-  return true;
 }
 
-void AsmX86::addResult(const Instruction &inst, qint64 pos,
-                       Disassembly &result) {
-  addResult(inst.toString(obj), pos, result);
+void AsmX86::addResult(const QString &line, qint64 pos,
+                       Disassembly &result, FlowType flow) {
+  addLine(line, pos, flow, qHash(line), result);
 }
 
-void AsmX86::addResult(const QString &line, qint64 pos,
-                       Disassembly &result) {
+void AsmX86::addLine(const QString &line, qint64 pos, FlowType flow,
+                     quint32 shape, Disassembly &result) {
   result.asmLines << line;
   result.bytesConsumed << reader->pos() - pos;
+  result.flows << flow;
+  result.shapes << shape;
 }
 
 void AsmX86::splitByte(unsigned char num, unsigned char &mod, unsigned char &op1,
@@ -1085,6 +1172,7 @@ void AsmX86::processModRegRM(Instruction &inst, bool noSip) {
       inst.dispSrc = true;
       inst.srcReg = 16; // RIP/EIP
       inst.srcRegSet = true;
+      inst.ripRel = true;
     }
     else {
       inst.srcReg = op2 + (inst.rexB ? 8 : 0);
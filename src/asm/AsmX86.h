@@ -32,13 +32,26 @@ namespace {
       dstRegSet{false}, srcRegType{RegType::R32}, dstRegType{RegType::R32},
       scale{0}, index{0}, base{0}, sipSrc{false}, sipDst{false}, disp{0},
       imm{0}, dispSrc{false}, dispDst{false}, immSrc{false}, immDst{false},
-      dispBytes{1}, immBytes{1}, offset{0}, call{false}, rexW{false},
-      rexR{false}, rexX{false}, rexB{false}
+      dispBytes{1}, immBytes{1}, offset{0}, call{false}, rel{false},
+      cond{false}, ripRel{false}, indirect{false}, rexW{false}, rexR{false}, rexX{false},
+      rexB{false}
     { }
 
-    QString toString(BinaryObjectPtr obj) const;
+    /**
+     * The symbol of a relocated operand, if any, is shown instead of
+     * looking up the target.
+     */
+    QString toString(BinaryObjectPtr obj,
+                     const QString &relocSymbol = QString()) const;
     void reverse();
 
+    // Absolute target of a relative branch (rel=true).
+    quint64 getTarget() const;
+
+    // Hash of mnemonic, registers and operand kinds but not of the
+    // immediate or displacement values.
+    quint32 getShape() const;
+
   private:
     QString getRegString(int reg, RegType type,
                          RegType type2 = RegType::SREG) const;
@@ -60,19 +73,47 @@ namespace {
     char dispBytes, immBytes;
     quint64 offset;
     bool call;
+    bool rel; // Relative branch: target is offset + signed disp.
+    bool cond; // Conditional branch.
+    bool ripRel; // Memory operand is relative to RIP (absolute on 32-bit).
+    bool indirect; // Branch through register or memory.
     bool rexW, rexR, rexX, rexB;
   };
 }
 
 class AsmX86 : public Asm {
 public:
+  struct NopForm {
+    QByteArray bytes;
+    QString mnemonic;
+  };
+
   AsmX86(BinaryObjectPtr obj);
   bool disassemble(SectionPtr sec, Disassembly &result);
+  bool disassemble(SectionPtr sec, qint64 pos, qint64 len,
+                   Disassembly &result);
+  bool disassembleRun(SectionPtr sec, qint64 pos, Disassembly &result);
+
+  /**
+   * Multi-byte NOP forms used for padding, longest first. Any of them
+   * may have extra 0x66 prefixes.
+   */
+  static const QList<NopForm> &getNopForms();
 
 private:
+  /**
+   * Decode from start until end, or the end of the section if -1.
+   */
+  bool disassemble(SectionPtr sec, qint64 start, qint64 end, bool run,
+                   Disassembly &result);
   bool handleNops(Disassembly &result);
   void addResult(const Instruction &inst, qint64 pos, Disassembly &result);
-  void addResult(const QString &inst, qint64 pos, Disassembly &result);
+  void addReference(const Instruction &inst, qint64 pos, Disassembly &result);
+  void addResult(const QString &inst, qint64 pos, Disassembly &result,
+                 FlowType flow = FlowType::Next);
+  void addLine(const QString &line, qint64 pos, FlowType flow,
+               quint32 shape, Disassembly &result);
+  FlowType getFlow(const Instruction &inst) const;
 
   // Split byte into [2][3][3] bits.
   void splitByte(unsigned char num, unsigned char &mod, unsigned char &op1,
@@ -94,6 +135,8 @@ private:
 
   BinaryObjectPtr obj;
   ReaderPtr reader;
+  quint64 secAddr;
+  RelocationTablePtr relocs;
 };
 
 #endif // BMOD_ASM_X86_H
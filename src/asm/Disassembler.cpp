@@ -28,6 +28,18 @@ bool Disassembler::disassemble(SectionPtr sec, Disassembly &result) {
   return asm_->disassemble(sec, result);
 }
 
+bool Disassembler::disassemble(SectionPtr sec, qint64 pos, qint64 len,
+                               Disassembly &result) {
+  if (!asm_) return false;
+  return asm_->disassemble(sec, pos, len, result);
+}
+
+bool Disassembler::disassembleRun(SectionPtr sec, qint64 pos,
+                                  Disassembly &result) {
+  if (!asm_) return false;
+  return asm_->disassembleRun(sec, pos, result);
+}
+
 bool Disassembler::disassemble(const QByteArray &data, Disassembly &result,
                                quint64 offset) {
   int size = data.size();
@@ -9,12 +9,53 @@
 class Asm;
 class QByteArray;
 
+struct Reference {
+  enum class Type : char {
+    Call, // Direct call.
+    Jump, // Unconditional direct jump.
+    CondJump, // Conditional direct jump.
+    Data, // RIP-relative (or absolute) memory operand.
+    CodePointer, // Word in data holding a code address.
+    DataPointer // Word in data holding another mapped address.
+  };
+
+  Reference(quint64 from = 0, quint64 to = 0, Type type = Type::Data)
+    : from{from}, to{to}, type{type}
+  { }
+
+  quint64 from, to; // Address of instruction and the referenced address.
+  Type type;
+};
+
+// How execution continues after an instruction.
+enum class FlowType : char {
+  Next, // Falls through to the next instruction.
+  Call, // Direct call, returns to the next instruction.
+  IndirectCall, // Call through register or memory.
+  Jump, // Unconditional direct jump.
+  CondJump, // Conditional direct jump, otherwise falls through.
+  IndirectJump, // Jump through register or memory.
+  Return,
+  Stop, // Halt or trap.
+  Invalid // Undecodable bytes.
+};
+
 struct Disassembly {
   // Machine code to assembly language.
   QStringList asmLines;
 
   // Bytes consumed per ASM line produced.
   QList<short> bytesConsumed;
+
+  // Control flow per ASM line produced.
+  QList<FlowType> flows;
+
+  // Hash per ASM line of the mnemonic and operand kinds with immediates
+  // and displacements masked out, for comparing code across builds.
+  QList<quint32> shapes;
+
+  // Code and data references of the decoded instructions.
+  QList<Reference> references;
 };
 
 class Disassembler {
@@ -23,11 +64,26 @@ public:
   ~Disassembler();
 
   bool disassemble(SectionPtr sec, Disassembly &result);
+
+  /**
+   * Decode len bytes from position pos of the section. Unlike decoding a
+   * copy of the bytes this uses the relocations of the section.
+   */
+  bool disassemble(SectionPtr sec, qint64 pos, qint64 len,
+                   Disassembly &result);
+
   bool disassemble(const QByteArray &data, Disassembly &result,
                    quint64 offset = 0);
   bool disassemble(const QString &data, Disassembly &result,
                    quint64 offset = 0);
 
+  /**
+   * Decode from position pos of the section until the first instruction
+   * that does not fall through (jmp, ret etc.). Conditional jumps and
+   * calls do not end the run.
+   */
+  bool disassembleRun(SectionPtr sec, qint64 pos, Disassembly &result);
+
 private:
   Asm *asm_;
 };
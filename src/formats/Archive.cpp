@@ -0,0 +1,202 @@
+#include <QVector>
+#include <QtEndian>
+#include <QtConcurrentMap>
+
+#include "MachO.h"
+#include "Archive.h"
+
+namespace {
+  const char MAGIC[] = "!<arch>\n";
+  const int MAGIC_SIZE{8}, HEADER_SIZE{60};
+
+  struct Job {
+    quint64 offset, size;
+    BinaryObjectPtr obj;
+  };
+
+  QByteArray field(const uchar *header, int pos, int len) {
+    return QByteArray((const char*) header + pos, len).trimmed();
+  }
+}
+
+Archive::Archive(const QString &file) : Format(FormatType::Archive), file{file}
+{ }
+
+bool Archive::detect() {
+  QFile f{file};
+  if (!f.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  return f.read(MAGIC_SIZE) == MAGIC;
+}
+
+bool Archive::parse() {
+  mapped = getMappedFile();
+  if (!mapped || !indexMembers()) {
+    return false;
+  }
+
+  // Each member is parsed by its own reader so they can run in parallel.
+  QVector<Job> jobs;
+  foreach (const auto &member, members) {
+    Job job;
+    job.offset = member.offset;
+    job.size = member.size;
+    jobs << job;
+  }
+
+  QtConcurrent::blockingMap(jobs, [this](Job &job) {
+      QFile f{file};
+      MachO macho{file};
+      if (f.open(QIODevice::ReadOnly) &&
+          macho.parseObject(f, job.offset, job.size, mapped) &&
+          !macho.getObjects().isEmpty()) {
+        job.obj = macho.getObjects().first();
+      }
+    });
+
+  // Members that are not Mach-O objects, like sources of other formats,
+  // are left out.
+  for (int i = 0; i < jobs.size(); i++) {
+    if (jobs[i].obj) {
+      objects << jobs[i].obj;
+      objectMembers[jobs[i].obj.get()] = i;
+    }
+  }
+
+  foreach (const auto &symdef, symdefs) {
+    parseSymdef(symdef);
+  }
+  if (symbols.isEmpty()) {
+    foreach (const auto obj, objects) {
+      foreach (const auto &symbol, obj->getSymbolTable().getSymbols()) {
+        const auto &name = symbol.getString();
+        if (!name.isEmpty() && !symbols.contains(name)) {
+          symbols[name] = objectMembers[obj.get()];
+        }
+      }
+    }
+  }
+  return !objects.isEmpty();
+}
+
+QString Archive::getMemberName(BinaryObjectPtr obj) const {
+  int idx = objectMembers.value(obj.get(), -1);
+  if (idx == -1) {
+    return QString();
+  }
+  return members[idx].name;
+}
+
+bool Archive::indexMembers() {
+  const uchar *data = mapped->getPointer();
+  const quint64 size = mapped->getSize();
+  if (!mapped->contains(0, MAGIC_SIZE)) {
+    return false;
+  }
+
+  QByteArray longNames; // GNU long name table.
+  quint64 pos = MAGIC_SIZE;
+  while (mapped->contains(pos, HEADER_SIZE)) {
+    const uchar *header = data + pos;
+    if (header[58] != '`' || header[59] != '\n') {
+      return false;
+    }
+
+    bool ok;
+    QByteArray name = field(header, 0, 16);
+    quint64 len = field(header, 48, 10).toULongLong(&ok);
+    if (!ok || !mapped->contains(pos + HEADER_SIZE, len)) {
+      return false;
+    }
+
+    Member member;
+    member.header = pos;
+    member.offset = pos + HEADER_SIZE;
+    member.size = len;
+
+    // BSD long names precede the data.
+    if (name.startsWith("#1/")) {
+      quint64 nameLen = name.mid(3).toULongLong(&ok);
+      if (!ok || nameLen > len) {
+        return false;
+      }
+      const char *str = (const char*) data + member.offset;
+      name = QByteArray(str, qstrnlen(str, nameLen));
+      member.offset += nameLen;
+      member.size -= nameLen;
+    }
+
+    // GNU long names are offsets into the "//" member.
+    else if (name.startsWith("/") && name.size() > 1 && name[1] != '/' &&
+             name != "/SYM64/") {
+      int idx = name.mid(1).toInt(&ok);
+      if (ok && idx < longNames.size()) {
+        int end = longNames.indexOf('\n', idx);
+        name = longNames.mid(idx, end == -1 ? -1 : end - idx);
+      }
+    }
+    else if (name.endsWith("/") && name != "/" && name != "//") {
+      name.chop(1);
+    }
+    member.name = QString::fromUtf8(name);
+    if (member.name.endsWith("/")) {
+      member.name.chop(1);
+    }
+
+    if (name == "//") {
+      longNames = QByteArray((const char*) data + member.offset, member.size);
+    }
+    else if (name.startsWith("__.SYMDEF")) {
+      symdefs << member;
+    }
+    else if (name != "/" && name != "/SYM64/") {
+      members << member;
+    }
+
+    // Members are aligned to even offsets.
+    pos = pos + HEADER_SIZE + len;
+    pos += (pos & 1);
+    if (pos >= size) break;
+  }
+  return true;
+}
+
+void Archive::parseSymdef(const Member &member) {
+  // Table of ranlib entries (string index, member header offset) followed
+  // by the string table, with 64-bit fields in "__.SYMDEF_64".
+  bool is64 = member.name.startsWith("__.SYMDEF_64");
+  int word = (is64 ? 8 : 4);
+  const uchar *data = mapped->getPointer() + member.offset;
+  auto get = [is64, data](quint64 pos) -> quint64 {
+    return (is64 ? qFromLittleEndian<quint64>(data + pos)
+            : qFromLittleEndian<quint32>(data + pos));
+  };
+
+  if (member.size < (quint64) word) return;
+  quint64 ranlibSize = get(0);
+  quint64 strPos = word + ranlibSize;
+  if (strPos + word > member.size) return;
+  quint64 strSize = get(strPos);
+  strPos += word;
+  if (strPos + strSize > member.size) return;
+
+  QHash<quint64, int> headers;
+  for (int i = 0; i < members.size(); i++) {
+    headers[members[i].header] = i;
+  }
+
+  const char *strs = (const char*) data + strPos;
+  for (quint64 pos = word; pos + 2 * word <= word + ranlibSize;
+       pos += 2 * word) {
+    quint64 strx = get(pos), off = get(pos + word);
+    if (strx >= strSize || !headers.contains(off)) {
+      continue;
+    }
+    QString name =
+      QString::fromUtf8(strs + strx, qstrnlen(strs + strx, strSize - strx));
+    if (!symbols.contains(name)) {
+      symbols[name] = headers[off];
+    }
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef BMOD_ARCHIVE_FORMAT_H
+#define BMOD_ARCHIVE_FORMAT_H
+
+#include <QHash>
+
+#include "Format.h"
+#include "../MappedFile.h"
+
+/**
+ * Static library (ar archive) of Mach-O object files in the BSD or GNU
+ * variant. Members are parsed in parallel and each becomes an object.
+ */
+class Archive : public Format {
+public:
+  struct Member {
+    QString name;
+    quint64 header; // File offset of the member header.
+    quint64 offset, size; // Range of the member data.
+  };
+
+  Archive(const QString &file);
+
+  QString getFile() const { return file; }
+
+  bool detect();
+  bool parse();
+
+  QList<BinaryObjectPtr> getObjects() const { return objects; }
+
+  const QList<Member> &getMembers() const { return members; }
+
+  /**
+   * Name of the member the object was parsed from.
+   */
+  QString getMemberName(BinaryObjectPtr obj) const;
+
+  /**
+   * Symbols defined across all members, mapped to their member index.
+   * The symbol table of the archive is used if present, otherwise the
+   * symbol tables of the members.
+   */
+  const QHash<QString, int> &getSymbolIndex() const { return symbols; }
+
+private:
+  bool indexMembers();
+  void parseSymdef(const Member &member);
+
+  QString file;
+  QList<BinaryObjectPtr> objects;
+  QList<Member> members;
+  QHash<const BinaryObject*, int> objectMembers; // Member index of objects.
+  QHash<QString, int> symbols;
+
+  MappedFilePtr mapped;
+  QList<Member> symdefs;
+};
+
+#endif // BMOD_ARCHIVE_FORMAT_H
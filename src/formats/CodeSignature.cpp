@@ -0,0 +1,227 @@
+#include <QFile>
+#include <QtEndian>
+#include <QCryptographicHash>
+#include <QtConcurrentMap>
+
+#include "CodeSignature.h"
+
+namespace {
+  const quint32 SUPER_BLOB_MAGIC{0xFADE0CC0};
+  const quint32 CODE_DIRECTORY_MAGIC{0xFADE0C02};
+
+  struct Job {
+    QByteArray data, hash;
+  };
+
+  quint32 getUInt32(const QByteArray &data, quint64 pos, bool *ok) {
+    if (pos + 4 > (quint64) data.size()) {
+      *ok = false;
+      return 0;
+    }
+    return qFromBigEndian<quint32>((const uchar*) data.constData() + pos);
+  }
+
+  quint64 getUInt64(const QByteArray &data, quint64 pos, bool *ok) {
+    if (pos + 8 > (quint64) data.size()) {
+      *ok = false;
+      return 0;
+    }
+    return qFromBigEndian<quint64>((const uchar*) data.constData() + pos);
+  }
+
+  bool toAlgorithm(CodeSignature::HashType type,
+                   QCryptographicHash::Algorithm &algo) {
+    switch (type) {
+    case CodeSignature::HashType::Sha1:
+      algo = QCryptographicHash::Sha1;
+      return true;
+
+    case CodeSignature::HashType::Sha256:
+    case CodeSignature::HashType::Sha256Truncated:
+      algo = QCryptographicHash::Sha256;
+      return true;
+
+    case CodeSignature::HashType::Sha384:
+      algo = QCryptographicHash::Sha384;
+      return true;
+
+    default:
+      return false;
+    }
+  }
+}
+
+CodeSignaturePtr CodeSignature::parse(SectionPtr sec) {
+  if (!sec) {
+    return nullptr;
+  }
+
+  bool ok{true};
+  const QByteArray &data = sec->getData();
+  if (getUInt32(data, 0, &ok) != SUPER_BLOB_MAGIC || !ok) {
+    return nullptr;
+  }
+
+  auto sig = CodeSignaturePtr(new CodeSignature(sec));
+  quint32 count = getUInt32(data, 8, &ok);
+  for (quint32 i = 0; i < count && ok; i++) {
+    // Blob index of type and offset.
+    quint32 off = getUInt32(data, 12 + i * 8 + 4, &ok);
+    if (!ok || getUInt32(data, off, &ok) != CODE_DIRECTORY_MAGIC) {
+      continue;
+    }
+
+    Directory dir;
+    dir.offset = off;
+    quint32 len = getUInt32(data, off + 4, &ok);
+    dir.version = getUInt32(data, off + 8, &ok);
+    dir.flags = getUInt32(data, off + 12, &ok);
+    dir.hashOffset = getUInt32(data, off + 16, &ok);
+    quint32 identOff = getUInt32(data, off + 20, &ok);
+    dir.specialSlots = getUInt32(data, off + 24, &ok);
+    dir.codeSlots = getUInt32(data, off + 28, &ok);
+    dir.codeLimit = getUInt32(data, off + 32, &ok);
+    if (!ok || off + 40 > (quint32) data.size()) {
+      break;
+    }
+    dir.hashSize = data[off + 36];
+    dir.hashType = (HashType) data[off + 37];
+    dir.pageSizeLog = data[off + 39];
+
+    // Version 0x20300 added a 64-bit code limit.
+    if (dir.version >= 0x20300 && dir.codeLimit == 0) {
+      dir.codeLimit = getUInt64(data, off + 56, &ok);
+    }
+
+    if (!ok || dir.hashOffset + (quint64) dir.codeSlots * dir.hashSize > len ||
+        off + (quint64) len > (quint64) data.size()) {
+      continue;
+    }
+    if (identOff < len) {
+      dir.ident = QString::fromUtf8(data.constData() + off + identOff);
+    }
+    sig->dirs << dir;
+  }
+
+  if (sig->dirs.isEmpty()) {
+    return nullptr;
+  }
+  return sig;
+}
+
+QByteArray CodeSignature::getHash(const Directory &dir, int slot) const {
+  return sec->getData().mid(dir.offset + dir.hashOffset + slot * dir.hashSize,
+                            dir.hashSize);
+}
+
+QVector<QList<int>> CodeSignature::verify(QFile &file, bool *ok) const {
+  QVector<QList<int>> res;
+  bool okHash{true};
+  foreach (const auto &dir, dirs) {
+    QList<int> pageSlots;
+    for (quint32 i = 0; i < dir.codeSlots; i++) {
+      pageSlots << i;
+    }
+
+    QList<int> mismatches;
+    auto hashes = hashPages(file, dir, pageSlots, &okHash);
+    if (!okHash) break;
+    for (int i = 0; i < hashes.size(); i++) {
+      if (hashes[i] != getHash(dir, pageSlots[i])) {
+        mismatches << pageSlots[i];
+      }
+    }
+    res << mismatches;
+  }
+
+  if (ok) *ok = okHash;
+  return res;
+}
+
+int CodeSignature::rehash(QFile &file, const IntervalSet &dirty) {
+  int changed{0};
+  quint64 base = getBase();
+  foreach (const auto &dir, dirs) {
+    quint64 pageSize = dir.getPageSize();
+    if (pageSize == 0) continue;
+
+    QList<int> pageSlots;
+    for (quint32 i = 0; i < dir.codeSlots; i++) {
+      quint64 start = i * pageSize;
+      if (start >= dir.codeLimit) break;
+      if (dirty.intersects(base + start, qMin(pageSize, dir.codeLimit - start))) {
+        pageSlots << i;
+      }
+    }
+    if (pageSlots.isEmpty()) continue;
+
+    bool ok;
+    auto hashes = hashPages(file, dir, pageSlots, &ok);
+    if (!ok) {
+      return -1;
+    }
+    for (int i = 0; i < hashes.size(); i++) {
+      int slot = pageSlots[i];
+      if (hashes[i] == getHash(dir, slot)) continue;
+      sec->setSubData(hashes[i], dir.offset + dir.hashOffset +
+                      slot * dir.hashSize);
+      changed++;
+    }
+  }
+  return changed;
+}
+
+QVector<QByteArray> CodeSignature::hashPages(QFile &file, const Directory &dir,
+                                             const QList<int> &pageSlots,
+                                             bool *ok) const {
+  QVector<QByteArray> res;
+  *ok = true;
+
+  // Unknown hash types are left alone.
+  QCryptographicHash::Algorithm algo;
+  if (!toAlgorithm(dir.hashType, algo)) {
+    return res;
+  }
+
+  // Mapping the file avoids copying the pages. Otherwise read them first
+  // since the file can't be accessed concurrently.
+  quint64 base = getBase(), pageSize = dir.getPageSize(), size = file.size();
+  uchar *map = file.map(0, size);
+  QVector<Job> jobs;
+  foreach (int slot, pageSlots) {
+    quint64 start = base + slot * pageSize,
+      len = qMin(pageSize, dir.codeLimit - slot * pageSize);
+    if (slot * pageSize >= dir.codeLimit || start + len > size) {
+      *ok = false;
+      break;
+    }
+
+    Job job;
+    if (map) {
+      job.data = QByteArray::fromRawData((const char*) map + start, len);
+    }
+    else if (file.seek(start)) {
+      job.data = file.read(len);
+    }
+    else {
+      *ok = false;
+      break;
+    }
+    jobs << job;
+  }
+
+  if (*ok) {
+    int hashSize = dir.hashSize;
+    QtConcurrent::blockingMap(jobs, [algo, hashSize](Job &job) {
+        job.hash = QCryptographicHash::hash(job.data, algo).left(hashSize);
+      });
+    foreach (const auto &job, jobs) {
+      res << job.hash;
+    }
+  }
+
+  if (map) {
+    file.unmap(map);
+  }
+  return res;
+}
@@ -0,0 +1,93 @@
+#ifndef BMOD_CODE_SIGNATURE_H
+#define BMOD_CODE_SIGNATURE_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+#include <memory>
+
+#include "../Section.h"
+#include "../IntervalSet.h"
+
+class QFile;
+
+class CodeSignature;
+typedef std::shared_ptr<CodeSignature> CodeSignaturePtr;
+
+/**
+ * Mach-O code signature (LC_CODE_SIGNATURE) with its code directories.
+ *
+ * Each code directory holds one hash per page of the object up to its
+ * code limit. Pages are relative to the start of the object in the file,
+ * which matters for fat binaries.
+ */
+class CodeSignature {
+public:
+  enum class HashType : quint8 {
+    None,
+    Sha1,
+    Sha256,
+    Sha256Truncated,
+    Sha384
+  };
+
+  struct Directory {
+    quint32 offset; // Offset of the code directory in the signature.
+    quint32 version, flags, hashOffset, specialSlots, codeSlots;
+    quint64 codeLimit;
+    quint8 hashSize, pageSizeLog;
+    HashType hashType;
+    QString ident;
+
+    /**
+     * Size of each page, where zero means one page up to the code limit.
+     */
+    quint64 getPageSize() const {
+      return (pageSizeLog == 0 ? codeLimit : (quint64) 1 << pageSizeLog);
+    }
+  };
+
+  /**
+   * Parse the signature blob of the section, or null if it is invalid.
+   */
+  static CodeSignaturePtr parse(SectionPtr sec);
+
+  SectionPtr getSection() const { return sec; }
+  const QList<Directory> &getDirectories() const { return dirs; }
+
+  /**
+   * File offset of the object the pages are relative to.
+   */
+  quint64 getBase() const { return sec->getOffset() - sec->getAddress(); }
+
+  QByteArray getHash(const Directory &dir, int slot) const;
+
+  /**
+   * Slots of each directory whose hash does not match the file. Pages are
+   * hashed in parallel.
+   */
+  QVector<QList<int>> verify(QFile &file, bool *ok = nullptr) const;
+
+  /**
+   * Recompute the hashes of the pages intersecting the dirty file ranges
+   * and store the changed ones in the section. Returns the number of slots
+   * changed, or -1 if the file could not be read.
+   */
+  int rehash(QFile &file, const IntervalSet &dirty);
+
+private:
+  CodeSignature(SectionPtr sec) : sec{sec} { }
+
+  /**
+   * Current hashes of the slots of the directory computed from the file.
+   */
+  QVector<QByteArray> hashPages(QFile &file, const Directory &dir,
+                                const QList<int> &pageSlots, bool *ok) const;
+
+  SectionPtr sec;
+  QList<Directory> dirs;
+};
+
+#endif // BMOD_CODE_SIGNATURE_H
@@ -0,0 +1,869 @@
+#include <QtEndian>
+
+#include <climits>
+#include <algorithm>
+
+#include "DwarfLineTable.h"
+
+namespace {
+  const quint64 NONE{~quint64(0)};
+
+  // Attributes and forms needed to find the line program and the address
+  // ranges of a unit.
+  const quint64 DW_AT_stmt_list{0x10}, DW_AT_low_pc{0x11},
+    DW_AT_high_pc{0x12}, DW_AT_ranges{0x55}, DW_AT_addr_base{0x73},
+    DW_AT_rnglists_base{0x74};
+  const quint64 DW_FORM_addr{0x01}, DW_FORM_string{0x08},
+    DW_FORM_strp{0x0E}, DW_FORM_line_strp{0x1F}, DW_FORM_indirect{0x16},
+    DW_FORM_implicit_const{0x21}, DW_FORM_rnglistx{0x23};
+
+  // Unit types (DWARF 5).
+  const quint8 DW_UT_compile{1}, DW_UT_partial{3}, DW_UT_skeleton{4},
+    DW_UT_split_compile{5};
+
+  // Range list entries (DWARF 5).
+  const quint8 DW_RLE_end_of_list{0}, DW_RLE_base_addressx{1},
+    DW_RLE_startx_endx{2}, DW_RLE_startx_length{3}, DW_RLE_offset_pair{4},
+    DW_RLE_base_address{5}, DW_RLE_start_end{6}, DW_RLE_start_length{7};
+
+  // Line number program content types (DWARF 5).
+  const quint64 DW_LNCT_path{1}, DW_LNCT_directory_index{2};
+
+  /**
+   * Bounds checked reading of a debug section. Reading past the end
+   * yields zeros and clears the ok flag.
+   */
+  class Cursor {
+  public:
+    Cursor(const DwarfLineTable::Data &data, quint64 pos, bool littleEndian)
+      : data{data.ptr}, size{data.size}, pos{pos}, ok{pos <= size},
+      littleEndian{littleEndian}
+    { }
+
+    template <typename T>
+    T get() {
+      if (!ok || size - pos < sizeof(T)) {
+        ok = false;
+        return 0;
+      }
+      T value = (littleEndian ? qFromLittleEndian<T>(data + pos)
+                 : qFromBigEndian<T>(data + pos));
+      pos += sizeof(T);
+      return value;
+    }
+
+    quint64 getSized(int bytes) {
+      switch (bytes) {
+      case 1: return get<quint8>();
+      case 2: return get<quint16>();
+      case 4: return get<quint32>();
+      case 8: return get<quint64>();
+      default:
+        skip(bytes);
+        return 0;
+      }
+    }
+
+    quint64 getULEB() {
+      quint64 value{0};
+      int shift{0};
+      while (true) {
+        quint8 ch = get<quint8>();
+        if (!ok) return 0;
+        if (shift < 64) value |= quint64(ch & 0x7F) << shift;
+        shift += 7;
+        if (!(ch & 0x80)) break;
+      }
+      return value;
+    }
+
+    qint64 getSLEB() {
+      qint64 value{0};
+      int shift{0};
+      quint8 ch;
+      do {
+        ch = get<quint8>();
+        if (!ok) return 0;
+        if (shift < 64) value |= qint64(ch & 0x7F) << shift;
+        shift += 7;
+      } while (ch & 0x80);
+      if (shift < 64 && (ch & 0x40)) {
+        value |= -(qint64(1) << shift);
+      }
+      return value;
+    }
+
+    QString getString() {
+      if (!ok || pos >= size) {
+        ok = false;
+        return QString();
+      }
+      const char *str = (const char*) data + pos;
+      int len = qstrnlen(str, qMin(size - pos, (quint64) INT_MAX));
+      pos += len + 1;
+      return QString::fromUtf8(str, len);
+    }
+
+    /**
+     * Length of a unit, setting the size of offsets to 4 or 8 bytes.
+     */
+    quint64 getUnitLength(int &offSize) {
+      quint64 len = get<quint32>();
+      offSize = 4;
+      if (len == 0xFFFFFFFF) {
+        len = get<quint64>();
+        offSize = 8;
+      }
+      return len;
+    }
+
+    void skip(quint64 len) {
+      if (!ok || size - pos < len) {
+        ok = false;
+        return;
+      }
+      pos += len;
+    }
+
+    const uchar *data;
+    quint64 size, pos;
+    bool ok, littleEndian;
+  };
+
+  /**
+   * Read or skip an attribute value of the form. Constants and offsets
+   * are returned, other values are skipped.
+   */
+  quint64 readForm(Cursor &c, quint64 form, int addrSize, int offSize,
+                   int version) {
+    switch (form) {
+    case 0x01: return c.getSized(addrSize); // addr
+    case 0x03: c.skip(c.get<quint16>()); return 0; // block2
+    case 0x04: c.skip(c.get<quint32>()); return 0; // block4
+    case 0x05: return c.get<quint16>(); // data2
+    case 0x06: return c.get<quint32>(); // data4
+    case 0x07: return c.get<quint64>(); // data8
+    case 0x08: c.getString(); return 0; // string
+    case 0x09: c.skip(c.getULEB()); return 0; // block
+    case 0x0A: c.skip(c.get<quint8>()); return 0; // block1
+    case 0x0B: return c.get<quint8>(); // data1
+    case 0x0C: return c.get<quint8>(); // flag
+    case 0x0D: return c.getSLEB(); // sdata
+    case 0x0E: return c.getSized(offSize); // strp
+    case 0x0F: return c.getULEB(); // udata
+    case 0x10: return c.getSized(version <= 2 ? addrSize : offSize); // ref_addr
+    case 0x11: return c.get<quint8>(); // ref1
+    case 0x12: return c.get<quint16>(); // ref2
+    case 0x13: return c.get<quint32>(); // ref4
+    case 0x14: return c.get<quint64>(); // ref8
+    case 0x15: return c.getULEB(); // ref_udata
+    case 0x16: // indirect
+      return readForm(c, c.getULEB(), addrSize, offSize, version);
+    case 0x17: return c.getSized(offSize); // sec_offset
+    case 0x18: c.skip(c.getULEB()); return 0; // exprloc
+    case 0x19: return 1; // flag_present
+    case 0x1A: return c.getULEB(); // strx
+    case 0x1B: return c.getULEB(); // addrx
+    case 0x1C: return c.get<quint32>(); // ref_sup4
+    case 0x1D: return c.getSized(offSize); // strp_sup
+    case 0x1E: c.skip(16); return 0; // data16
+    case 0x1F: return c.getSized(offSize); // line_strp
+    case 0x20: return c.get<quint64>(); // ref_sig8
+    case 0x21: return 0; // implicit_const, stored in the abbreviation
+    case 0x22: return c.getULEB(); // loclistx
+    case 0x23: return c.getULEB(); // rnglistx
+    case 0x24: return c.get<quint64>(); // ref_sup8
+    case 0x25: return c.get<quint8>(); // strx1
+    case 0x26: return c.get<quint16>(); // strx2
+    case 0x27: c.skip(3); return 0; // strx3
+    case 0x28: return c.get<quint32>(); // strx4
+    case 0x29: return c.get<quint8>(); // addrx1
+    case 0x2A: return c.get<quint16>(); // addrx2
+    case 0x2B: c.skip(3); return 0; // addrx3
+    case 0x2C: return c.get<quint32>(); // addrx4
+    default:
+      c.ok = false;
+      return 0;
+    }
+  }
+
+  bool isAddrIndexForm(quint64 form) {
+    return form == 0x1B || (form >= 0x29 && form <= 0x2C); // addrx*
+  }
+
+  /**
+   * Attributes of the first entry of a compilation unit. Forms are 0 for
+   * absent attributes.
+   */
+  struct UnitEntry {
+    int version, addrSize, offSize;
+    quint64 next; // Offset of the following unit.
+    quint64 stmtList, lowPc, highPc, ranges, addrBase, rnglistsBase;
+    quint64 stmtForm, lowForm, highForm, rangesForm;
+  };
+
+  /**
+   * Read the header and the first entry of the unit at the offset. Type
+   * units yield no attributes.
+   */
+  bool readUnitEntry(const DwarfLineTable::Data &info,
+                     const DwarfLineTable::Data &abbrev,
+                     quint64 offset, bool littleEndian, UnitEntry &entry) {
+    entry.stmtForm = entry.lowForm = entry.highForm = entry.rangesForm = 0;
+    entry.stmtList = entry.lowPc = entry.highPc = entry.ranges = 0;
+    entry.addrBase = entry.rnglistsBase = 0;
+
+    Cursor c(info, offset, littleEndian);
+    quint64 len = c.getUnitLength(entry.offSize);
+    entry.next = c.pos + len;
+    entry.version = c.get<quint16>();
+    if (!c.ok || len == 0 || entry.next > c.size) {
+      return false;
+    }
+    quint64 abbrevOffset;
+    if (entry.version >= 5) {
+      quint8 type = c.get<quint8>();
+      entry.addrSize = c.get<quint8>();
+      abbrevOffset = c.getSized(entry.offSize);
+      if (type == DW_UT_skeleton || type == DW_UT_split_compile) {
+        c.skip(8); // Unit id.
+      }
+      else if (type != DW_UT_compile && type != DW_UT_partial) {
+        return c.ok;
+      }
+    }
+    else {
+      abbrevOffset = c.getSized(entry.offSize);
+      entry.addrSize = c.get<quint8>();
+    }
+    quint64 code = c.getULEB();
+    if (!c.ok || code == 0) {
+      return c.ok;
+    }
+
+    // Find the abbreviation of the unit entry.
+    Cursor a(abbrev, abbrevOffset, littleEndian);
+    while (a.ok) {
+      quint64 abbrevCode = a.getULEB();
+      if (abbrevCode == 0) {
+        return false;
+      }
+      a.getULEB(); // Tag.
+      a.get<quint8>(); // Has children.
+      while (a.ok) {
+        quint64 attr = a.getULEB(), form = a.getULEB();
+        qint64 implicit{0};
+        if (form == DW_FORM_implicit_const) {
+          implicit = a.getSLEB();
+        }
+        if (attr == 0 && form == 0) break;
+        if (abbrevCode != code) continue;
+
+        // Read the values of the entry along with its abbreviation.
+        if (form == DW_FORM_indirect) {
+          form = c.getULEB();
+        }
+        quint64 value = (form == DW_FORM_implicit_const ? implicit
+                         : readForm(c, form, entry.addrSize, entry.offSize,
+                                    entry.version));
+        if (!c.ok) {
+          return false;
+        }
+        switch (attr) {
+        case DW_AT_stmt_list:
+          entry.stmtList = value;
+          entry.stmtForm = form;
+          break;
+        case DW_AT_low_pc:
+          entry.lowPc = value;
+          entry.lowForm = form;
+          break;
+        case DW_AT_high_pc:
+          entry.highPc = value;
+          entry.highForm = form;
+          break;
+        case DW_AT_ranges:
+          entry.ranges = value;
+          entry.rangesForm = form;
+          break;
+        case DW_AT_addr_base:
+          entry.addrBase = value;
+          break;
+        case DW_AT_rnglists_base:
+          entry.rnglistsBase = value;
+          break;
+        }
+      }
+      if (abbrevCode == code) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  QString sectionKey(const QString &name) {
+    QString key{name};
+    while (key.startsWith("_") || key.startsWith(".")) {
+      key = key.mid(1);
+    }
+    return key;
+  }
+}
+
+DwarfLineTablePtr DwarfLineTable::build(const QList<SectionPtr> &sections,
+                                        bool littleEndian) {
+  auto table = DwarfLineTablePtr(new DwarfLineTable(littleEndian));
+  foreach (const auto sec, sections) {
+    // Sections too large for a QByteArray are read from the mapping.
+    auto snap = sec->getSnapshot();
+    Data data;
+    if ((quint64) snap.data.size() == sec->getSize()) {
+      data.ptr = (const uchar*) snap.data.constData();
+      data.size = snap.data.size();
+    }
+    else if (snap.file && snap.file->contains(sec->getOffset(),
+                                              sec->getSize())) {
+      data.ptr = snap.file->getPointer() + sec->getOffset();
+      data.size = sec->getSize();
+    }
+    table->snaps << snap;
+
+    QString key = sectionKey(sec->getName());
+    if (key == "debug_line") table->lineData = data;
+    else if (key == "debug_info") table->infoData = data;
+    else if (key == "debug_abbrev") table->abbrevData = data;
+    else if (key == "debug_aranges") table->arangesData = data;
+    else if (key == "debug_str") table->strData = data;
+    else if (key == "debug_line_str") table->lineStrData = data;
+    else if (key == "debug_addr") table->addrData = data;
+    else if (key == "debug_ranges") table->rangesData = data;
+    else if (key == "debug_rnglists") table->rnglistsData = data;
+  }
+  if (table->lineData.size == 0) {
+    return nullptr;
+  }
+
+  table->readRanges();
+  if (table->units.isEmpty()) {
+    table->readUnitRanges();
+  }
+  if (table->units.isEmpty()) {
+    table->readLinePrograms();
+  }
+  table->sortRanges();
+  return table;
+}
+
+DwarfLineTable::DwarfLineTable(bool littleEndian)
+  : littleEndian{littleEndian}, allLoaded{false}, loaded{0}
+{ }
+
+bool DwarfLineTable::lookup(quint64 addr, QString &file, int &line) {
+  int idx = findUnit(addr);
+  if (idx == -1 && !allLoaded) {
+    allLoaded = true;
+    for (int i = 0; i < units.size(); i++) {
+      if (!units[i].loaded && !units[i].ranged) {
+        loadUnit(units[i]);
+        addRanges(i);
+      }
+    }
+    sortRanges();
+    idx = findUnit(addr);
+  }
+  if (idx == -1) {
+    return false;
+  }
+
+  auto &unit = units[idx];
+  if (!unit.loaded) {
+    loadUnit(unit);
+  }
+
+  // Last row at or before the address.
+  const auto &rows = unit.rows;
+  auto it = std::upper_bound(rows.constBegin(), rows.constEnd(), addr,
+                             [](quint64 value, const Row &row) {
+                               return value < row.addr;
+                             });
+  if (it == rows.constBegin()) {
+    return false;
+  }
+  --it;
+  if (it->end || it->file >= (quint32) unit.files.size()) {
+    return false;
+  }
+  file = unit.files[it->file];
+  line = it->line;
+  return true;
+}
+
+void DwarfLineTable::readRanges() {
+  QHash<quint64, int> unitIdx; // .debug_info offset -> unit
+  Cursor c(arangesData, 0, littleEndian);
+  while (c.ok && c.pos < c.size) {
+    quint64 start = c.pos;
+    int offSize;
+    quint64 len = c.getUnitLength(offSize);
+    quint64 end = c.pos + len;
+    c.get<quint16>(); // Version.
+    quint64 infoOffset = c.getSized(offSize);
+    int addrSize = c.get<quint8>();
+    c.get<quint8>(); // Segment selector size.
+    if (!c.ok || end > c.size || (addrSize != 4 && addrSize != 8)) {
+      break;
+    }
+
+    int idx = unitIdx.value(infoOffset, -1);
+    if (idx == -1) {
+      Unit unit;
+      unit.infoOffset = infoOffset;
+      unit.lineOffset = NONE;
+      unit.loaded = false;
+      unit.ranged = true;
+      idx = units.size();
+      units << unit;
+      unitIdx[infoOffset] = idx;
+    }
+
+    // Tuples are aligned to twice the address size from the unit start.
+    quint64 tuple = 2 * addrSize;
+    c.pos = start + ((c.pos - start + tuple - 1) / tuple) * tuple;
+    while (c.ok && c.pos + tuple <= end) {
+      quint64 lo = c.getSized(addrSize), size = c.getSized(addrSize);
+      if (lo == 0 && size == 0) break;
+      Range range;
+      range.lo = lo;
+      range.hi = lo + size;
+      range.unit = idx;
+      ranges << range;
+    }
+    c.pos = end;
+  }
+}
+
+void DwarfLineTable::readUnitRanges() {
+  quint64 offset{0};
+  while (offset < infoData.size) {
+    UnitEntry entry;
+    if (!readUnitEntry(infoData, abbrevData, offset, littleEndian, entry)) {
+      break;
+    }
+    quint64 infoOffset = offset;
+    offset = entry.next;
+    if (entry.stmtForm == 0) continue;
+
+    Unit unit;
+    unit.infoOffset = infoOffset;
+    unit.lineOffset = entry.stmtList;
+    unit.loaded = false;
+    unit.ranged = false;
+    int idx = units.size();
+    units << unit;
+
+    // Addresses may be indices into .debug_addr (DWARF 5).
+    int addrSize = entry.addrSize;
+    quint64 addrBase = (entry.addrBase ? entry.addrBase
+                        : (entry.offSize == 8 ? 16 : 8));
+    auto address = [&](quint64 value, quint64 form, bool &ok) -> quint64 {
+      if (!isAddrIndexForm(form)) {
+        return value;
+      }
+      Cursor a(addrData, addrBase + value * addrSize, littleEndian);
+      quint64 addr = a.getSized(addrSize);
+      ok = ok && a.ok;
+      return addr;
+    };
+    auto add = [&](quint64 lo, quint64 hi) {
+      // Code removed by the linker is left at address 0.
+      if (lo == 0 || hi <= lo) return;
+      Range range;
+      range.lo = lo;
+      range.hi = hi;
+      range.unit = idx;
+      ranges << range;
+      units[idx].ranged = true;
+    };
+
+    bool ok{true};
+    quint64 base = (entry.lowForm ? address(entry.lowPc, entry.lowForm, ok)
+                    : 0);
+    if (entry.rangesForm) {
+      if (entry.version < 5) {
+        // Pairs of start and end relative to the base, where a start of
+        // all ones selects a new base.
+        quint64 maxAddr = (addrSize == 4 ? 0xFFFFFFFF : ~quint64(0));
+        Cursor r(rangesData, entry.ranges, littleEndian);
+        while (r.ok) {
+          quint64 lo = r.getSized(addrSize), hi = r.getSized(addrSize);
+          if (!r.ok || (lo == 0 && hi == 0)) break;
+          if (lo == maxAddr) {
+            base = hi;
+            continue;
+          }
+          add(base + lo, base + hi);
+        }
+        continue;
+      }
+
+      quint64 listOffset = entry.ranges;
+      if (entry.rangesForm == DW_FORM_rnglistx) {
+        // Offsets from the base follow the header of the lists.
+        quint64 listBase = (entry.rnglistsBase ? entry.rnglistsBase
+                            : (entry.offSize == 8 ? 20 : 12));
+        Cursor r(rnglistsData, listBase + entry.ranges * entry.offSize,
+                 littleEndian);
+        listOffset = listBase + r.getSized(entry.offSize);
+        if (!r.ok) continue;
+      }
+      Cursor r(rnglistsData, listOffset, littleEndian);
+      while (r.ok && ok) {
+        quint8 kind = r.get<quint8>();
+        if (!r.ok || kind == DW_RLE_end_of_list) break;
+        quint64 lo, hi;
+        switch (kind) {
+        case DW_RLE_base_addressx:
+          base = address(r.getULEB(), 0x1B, ok);
+          continue;
+        case DW_RLE_startx_endx:
+          lo = address(r.getULEB(), 0x1B, ok);
+          hi = address(r.getULEB(), 0x1B, ok);
+          break;
+        case DW_RLE_startx_length:
+          lo = address(r.getULEB(), 0x1B, ok);
+          hi = lo + r.getULEB();
+          break;
+        case DW_RLE_offset_pair:
+          lo = base + r.getULEB();
+          hi = base + r.getULEB();
+          break;
+        case DW_RLE_base_address:
+          base = r.getSized(addrSize);
+          continue;
+        case DW_RLE_start_end:
+          lo = r.getSized(addrSize);
+          hi = r.getSized(addrSize);
+          break;
+        case DW_RLE_start_length:
+          lo = r.getSized(addrSize);
+          hi = lo + r.getULEB();
+          break;
+        default:
+          r.ok = false;
+          continue;
+        }
+        if (r.ok && ok) {
+          add(lo, hi);
+        }
+      }
+      continue;
+    }
+
+    if (entry.lowForm && entry.highForm && ok) {
+      // The end is an address or an offset from the start (DWARF 4).
+      quint64 hi = (entry.highForm == DW_FORM_addr ||
+                    isAddrIndexForm(entry.highForm)
+                    ? address(entry.highPc, entry.highForm, ok)
+                    : base + entry.highPc);
+      if (ok) {
+        add(base, hi);
+      }
+    }
+  }
+}
+
+void DwarfLineTable::readLinePrograms() {
+  // Only the unit lengths are read to find the start of each program.
+  Cursor c(lineData, 0, littleEndian);
+  while (c.ok && c.pos < c.size) {
+    quint64 start = c.pos;
+    int offSize;
+    quint64 len = c.getUnitLength(offSize);
+    if (!c.ok || len == 0) break;
+
+    Unit unit;
+    unit.infoOffset = NONE;
+    unit.lineOffset = start;
+    unit.loaded = false;
+    unit.ranged = false;
+    units << unit;
+    c.skip(len);
+  }
+}
+
+int DwarfLineTable::findUnit(quint64 addr) const {
+  auto it = std::upper_bound(ranges.constBegin(), ranges.constEnd(), addr,
+                             [](quint64 value, const Range &range) {
+                               return value < range.lo;
+                             });
+
+  // Ranges of units may nest, so earlier ones are checked until none of
+  // them reach the address.
+  for (int i = it - ranges.constBegin() - 1; i >= 0 && maxEnds[i] > addr;
+       i--) {
+    if (addr < ranges[i].hi) {
+      return ranges[i].unit;
+    }
+  }
+  return -1;
+}
+
+void DwarfLineTable::loadUnit(Unit &unit) {
+  unit.loaded = true;
+  loaded++;
+  if (unit.lineOffset == NONE && unit.infoOffset != NONE) {
+    unit.lineOffset = findStmtList(unit.infoOffset);
+  }
+  if (unit.lineOffset == NONE || !decode(unit.lineOffset, unit)) {
+    unit.rows.clear();
+    return;
+  }
+
+  // Sequences are not ordered. At equal addresses the end of a sequence
+  // comes before the start of the next one.
+  std::stable_sort(unit.rows.begin(), unit.rows.end(),
+                   [](const Row &a, const Row &b) {
+                     if (a.addr != b.addr) return a.addr < b.addr;
+                     return a.end && !b.end;
+                   });
+}
+
+void DwarfLineTable::addRanges(int idx) {
+  const auto &rows = units[idx].rows;
+  if (rows.isEmpty()) return;
+
+  // Each run of rows up to an end row is one sequence.
+  quint64 lo = rows.first().addr;
+  bool open{false};
+  foreach (const auto &row, rows) {
+    if (!open) {
+      lo = row.addr;
+      open = !row.end;
+    }
+    else if (row.end) {
+      Range range;
+      range.lo = lo;
+      range.hi = row.addr;
+      range.unit = idx;
+      ranges << range;
+      open = false;
+    }
+  }
+}
+
+void DwarfLineTable::sortRanges() {
+  std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) {
+      return a.lo < b.lo;
+    });
+  maxEnds.resize(ranges.size());
+  quint64 maxEnd{0};
+  for (int i = 0; i < ranges.size(); i++) {
+    maxEnd = qMax(maxEnd, ranges[i].hi);
+    maxEnds[i] = maxEnd;
+  }
+}
+
+quint64 DwarfLineTable::findStmtList(quint64 infoOffset) const {
+  UnitEntry entry;
+  if (!readUnitEntry(infoData, abbrevData, infoOffset, littleEndian, entry) ||
+      entry.stmtForm == 0) {
+    return NONE;
+  }
+  return entry.stmtList;
+}
+
+bool DwarfLineTable::decode(quint64 offset, Unit &unit) const {
+  Cursor c(lineData, offset, littleEndian);
+  int offSize;
+  quint64 len = c.getUnitLength(offSize);
+  quint64 end = c.pos + len;
+  int version = c.get<quint16>();
+  if (!c.ok || end > c.size || version < 2 || version > 5) {
+    return false;
+  }
+
+  int addrSize{8};
+  if (version >= 5) {
+    addrSize = c.get<quint8>();
+    c.get<quint8>(); // Segment selector size.
+  }
+  quint64 headerLen = c.getSized(offSize);
+  quint64 program = c.pos + headerLen;
+  quint8 minInstLen = c.get<quint8>();
+  if (version >= 4) {
+    c.get<quint8>(); // Maximum operations per instruction.
+  }
+  bool defaultIsStmt = c.get<quint8>();
+  Q_UNUSED(defaultIsStmt);
+  qint8 lineBase = c.get<qint8>();
+  quint8 lineRange = c.get<quint8>();
+  quint8 opcodeBase = c.get<quint8>();
+  QVector<quint8> opcodeLens;
+  for (int i = 1; i < opcodeBase; i++) {
+    opcodeLens << c.get<quint8>();
+  }
+  if (!c.ok || lineRange == 0 || opcodeBase == 0) {
+    return false;
+  }
+
+  QStringList dirs;
+  if (version >= 5) {
+    auto readEntries = [&](QStringList &paths, QStringList *dirsOf) {
+      QList<QPair<quint64, quint64>> formats;
+      int formatCount = c.get<quint8>();
+      for (int i = 0; i < formatCount; i++) {
+        quint64 type = c.getULEB(), form = c.getULEB();
+        formats << qMakePair(type, form);
+      }
+      quint64 count = c.getULEB();
+      for (quint64 i = 0; i < count && c.ok; i++) {
+        QString path;
+        quint64 dir{0};
+        foreach (const auto &format, formats) {
+          quint64 form = format.second;
+          if (form == DW_FORM_indirect) {
+            form = c.getULEB();
+          }
+          QString str;
+          quint64 value{0};
+          if (form == DW_FORM_string) {
+            str = c.getString();
+          }
+          else {
+            value = readForm(c, form, addrSize, offSize, version);
+            if (form == DW_FORM_line_strp) {
+              str = getString(lineStrData, value);
+            }
+            else if (form == DW_FORM_strp) {
+              str = getString(strData, value);
+            }
+          }
+          if (format.first == DW_LNCT_path) {
+            path = str;
+          }
+          else if (format.first == DW_LNCT_directory_index) {
+            dir = value;
+          }
+        }
+        if (dirsOf && !path.startsWith("/") && dir < (quint64) dirsOf->size()) {
+          path = dirsOf->at(dir) + "/" + path;
+        }
+        paths << path;
+      }
+    };
+    readEntries(dirs, nullptr);
+    readEntries(unit.files, &dirs);
+  }
+  else {
+    // Directory 0 and file 0 are implicit before version 5.
+    dirs << QString();
+    while (c.ok) {
+      QString dir = c.getString();
+      if (dir.isEmpty()) break;
+      dirs << dir;
+    }
+    unit.files << QString();
+    while (c.ok) {
+      QString path = c.getString();
+      if (path.isEmpty()) break;
+      quint64 dir = c.getULEB();
+      c.getULEB(); // Modification time.
+      c.getULEB(); // Length.
+      if (!path.startsWith("/") && dir > 0 && dir < (quint64) dirs.size()) {
+        path = dirs[dir] + "/" + path;
+      }
+      unit.files << path;
+    }
+  }
+  if (!c.ok) {
+    return false;
+  }
+
+  // Run the line number program.
+  c.pos = program;
+  quint64 addr{0};
+  quint32 file{1}, line{1};
+  auto emitRow = [&](bool endSeq) {
+    Row row;
+    row.addr = addr;
+    row.file = file;
+    row.line = line;
+    row.end = endSeq;
+    unit.rows << row;
+  };
+
+  while (c.ok && c.pos < end) {
+    quint8 op = c.get<quint8>();
+    if (op >= opcodeBase) {
+      int adj = op - opcodeBase;
+      addr += (adj / lineRange) * minInstLen;
+      line += lineBase + (adj % lineRange);
+      emitRow(false);
+      continue;
+    }
+
+    switch (op) {
+    case 0: { // Extended opcode.
+      quint64 extLen = c.getULEB();
+      quint64 next = c.pos + extLen;
+      if (extLen == 0) break;
+      quint8 sub = c.get<quint8>();
+      if (sub == 1) { // DW_LNE_end_sequence
+        emitRow(true);
+        addr = 0;
+        file = 1;
+        line = 1;
+      }
+      else if (sub == 2) { // DW_LNE_set_address
+        addr = c.getSized(extLen - 1);
+      }
+      else if (sub == 3) { // DW_LNE_define_file
+        unit.files << c.getString();
+      }
+      c.pos = next;
+      break;
+    }
+
+    case 1: // DW_LNS_copy
+      emitRow(false);
+      break;
+
+    case 2: // DW_LNS_advance_pc
+      addr += c.getULEB() * minInstLen;
+      break;
+
+    case 3: // DW_LNS_advance_line
+      line += c.getSLEB();
+      break;
+
+    case 4: // DW_LNS_set_file
+      file = c.getULEB();
+      break;
+
+    case 8: // DW_LNS_const_add_pc
+      addr += ((255 - opcodeBase) / lineRange) * minInstLen;
+      break;
+
+    case 9: // DW_LNS_fixed_advance_pc
+      addr += c.get<quint16>();
+      break;
+
+    default:
+      // Skip the operands of other standard opcodes.
+      for (int i = 0; i < opcodeLens[op - 1]; i++) {
+        c.getULEB();
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+QString DwarfLineTable::getString(const Data &data, quint64 offset) const {
+  if (offset >= data.size) {
+    return QString();
+  }
+  const char *str = (const char*) data.ptr + offset;
+  return QString::fromUtf8(str, qstrnlen(str, qMin(data.size - offset,
+                                                   (quint64) INT_MAX)));
+}
@@ -0,0 +1,96 @@
+#ifndef BMOD_DWARF_LINE_TABLE_H
+#define BMOD_DWARF_LINE_TABLE_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+#include "../Section.h"
+
+class DwarfLineTable;
+typedef std::shared_ptr<DwarfLineTable> DwarfLineTablePtr;
+
+/**
+ * Address to source line lookups from the DWARF line programs
+ * (.debug_line) of versions 2 to 5.
+ *
+ * Only the address ranges of the compilation units are read up front,
+ * from .debug_aranges or else from the unit entries of .debug_info. The
+ * line program of a unit is decoded into rows sorted by address the first
+ * time one of its addresses is looked up. Units without known ranges are
+ * all decoded on the first lookup that misses the others.
+ */
+class DwarfLineTable {
+public:
+  /**
+   * Table of the debug sections, named like "__debug_line" or
+   * ".debug_line", or null if there is no line information.
+   */
+  static DwarfLineTablePtr build(const QList<SectionPtr> &sections,
+                                 bool littleEndian);
+
+  /**
+   * Source file and line of the address.
+   */
+  bool lookup(quint64 addr, QString &file, int &line);
+
+  int getUnitCount() const { return units.size(); }
+  int getLoadedCount() const { return loaded; }
+
+  /**
+   * Bytes of a debug section, which may be larger than a QByteArray.
+   */
+  struct Data {
+    Data() : ptr{nullptr}, size{0} { }
+    const uchar *ptr;
+    quint64 size;
+  };
+
+private:
+  struct Row {
+    quint64 addr;
+    quint32 file, line;
+    bool end; // First address after a sequence.
+  };
+
+  struct Unit {
+    quint64 infoOffset, lineOffset; // ~0 if unknown.
+    bool loaded, ranged;
+    QVector<Row> rows;
+    QStringList files;
+  };
+
+  struct Range {
+    quint64 lo, hi;
+    int unit;
+  };
+
+  DwarfLineTable(bool littleEndian);
+
+  void readRanges();
+  void readUnitRanges();
+  void readLinePrograms();
+  int findUnit(quint64 addr) const;
+  void loadUnit(Unit &unit);
+  void addRanges(int idx);
+  void sortRanges();
+  quint64 findStmtList(quint64 infoOffset) const;
+  bool decode(quint64 offset, Unit &unit) const;
+  QString getString(const Data &data, quint64 offset) const;
+
+  bool littleEndian;
+  QList<Section::Snapshot> snaps; // Keeps the data below alive.
+  Data lineData, infoData, abbrevData, arangesData, strData, lineStrData,
+    addrData, rangesData, rnglistsData;
+
+  QVector<Unit> units;
+  QVector<Range> ranges; // Sorted by start.
+  QVector<quint64> maxEnds; // Highest end of the ranges up to each one.
+  bool allLoaded;
+  int loaded;
+};
+
+#endif // BMOD_DWARF_LINE_TABLE_H
@@ -0,0 +1,362 @@
+#include <QtEndian>
+#include <QFileInfo>
+
+#include "DyldCache.h"
+
+namespace {
+  // Load commands.
+  const quint32 LC_SEGMENT{0x1}, LC_SYMTAB{0x2}, LC_SEGMENT_64{0x19},
+    LC_FUNCTION_STARTS{0x26};
+
+  // Newer caches keep the image list here instead of the old fields.
+  const quint32 IMAGES_OFFSET{0x1C0}, IMAGES_COUNT{0x1C4};
+
+  // Headers reaching this field have local symbol entries with 64-bit
+  // image offsets from the cache base address instead of file offsets.
+  const quint32 SYMBOL_FILE_UUID{0x190};
+
+  CpuType toCpuType(quint32 cputype) {
+    switch (cputype) {
+    default:
+    case 7: // CPU_TYPE_X86
+      return CpuType::X86;
+
+    case 7 + 0x01000000: // CPU_TYPE_X86_64
+      return CpuType::X86_64;
+
+    case 12: // CPU_TYPE_ARM
+    case 12 + 0x01000000: // CPU_TYPE_ARM64
+    case 12 + 0x02000000: // CPU_TYPE_ARM64_32
+      return CpuType::ARM;
+    }
+  }
+}
+
+DyldCache::DyldCache(const QString &file)
+  : Format(FormatType::DyldCache), file{file}, localSymOff{0},
+  localSymSize{0}, localsIndexed{false}
+{ }
+
+bool DyldCache::detect() {
+  QFile f{file};
+  if (!f.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  return f.read(7) == "dyld_v1";
+}
+
+bool DyldCache::parse() {
+  mapped = getMappedFile();
+  if (!mapped || !mapped->contains(0, 0x60)) {
+    return false;
+  }
+
+  quint32 mappingOff = get<quint32>(0x10), mappingCount = get<quint32>(0x14);
+  quint32 imagesOff = get<quint32>(0x18), imagesCount = get<quint32>(0x1C);
+  if (mappingOff >= IMAGES_COUNT + 4) {
+    imagesOff = get<quint32>(IMAGES_OFFSET);
+    imagesCount = get<quint32>(IMAGES_COUNT);
+  }
+  localSymOff = get<quint64>(0x48);
+  localSymSize = get<quint64>(0x50);
+
+  if (!mapped->contains(mappingOff, (quint64) mappingCount * 32) ||
+      !mapped->contains(imagesOff, (quint64) imagesCount * 32)) {
+    return false;
+  }
+
+  // Mappings translate addresses of the images to file offsets.
+  space = AddressSpacePtr(new AddressSpace(mapped));
+  for (quint32 i = 0; i < mappingCount; i++) {
+    quint64 off = mappingOff + i * 32;
+    AddressSpace::Mapping mapping;
+    mapping.addr = get<quint64>(off);
+    mapping.size = get<quint64>(off + 8);
+    mapping.offset = get<quint64>(off + 16);
+    mapping.fileSize = mapping.size;
+    mapping.prot = get<quint32>(off + 28);
+    mapping.sectionsEnd = 0;
+    if (mapped->contains(mapping.offset, mapping.size)) {
+      space->addMapping(mapping);
+    }
+  }
+
+  for (quint32 i = 0; i < imagesCount; i++) {
+    quint64 off = imagesOff + i * 32;
+    Image image;
+    image.addr = get<quint64>(off);
+    image.path = getString(get<quint32>(off + 24));
+    images << image;
+  }
+  return !images.isEmpty();
+}
+
+int DyldCache::findImage(const QString &path) const {
+  for (int i = 0; i < images.size(); i++) {
+    const auto &imgPath = images[i].path;
+    if (imgPath == path || QFileInfo(imgPath).fileName() == path) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+BinaryObjectPtr DyldCache::loadImage(int idx) {
+  if (idx < 0 || idx >= images.size()) {
+    return nullptr;
+  }
+  if (loaded.contains(idx)) {
+    return loaded[idx];
+  }
+
+  // Images in other files of split caches are not reachable from here.
+  quint64 offset;
+  if (!space->toOffset(images[idx].addr, offset)) {
+    return nullptr;
+  }
+
+  BinaryObjectPtr obj(new BinaryObject);
+  if (!parseImage(offset, obj)) {
+    return nullptr;
+  }
+  loaded[idx] = obj;
+  objects << obj;
+  return obj;
+}
+
+template <typename T>
+T DyldCache::get(quint64 offset) const {
+  if (!mapped->contains(offset, sizeof(T))) {
+    return 0;
+  }
+  return qFromLittleEndian<T>(mapped->getPointer() + offset);
+}
+
+QString DyldCache::getString(quint64 offset) const {
+  if (!mapped->contains(offset, 1)) {
+    return QString();
+  }
+  const char *str = (const char*) mapped->getPointer() + offset;
+  return QString::fromUtf8(str, qstrnlen(str, mapped->getSize() - offset));
+}
+
+bool DyldCache::parseImage(quint64 offset, BinaryObjectPtr obj) {
+  quint32 magic = get<quint32>(offset);
+  bool is64;
+  if (magic == 0xFEEDFACF) {
+    is64 = true;
+  }
+  else if (magic == 0xFEEDFACE) {
+    is64 = false;
+  }
+  else {
+    return false;
+  }
+
+  CpuType cpuType = toCpuType(get<quint32>(offset + 4));
+  obj->setCpuType(cpuType);
+  obj->setCpuSubType(cpuType);
+  obj->setSystemBits(is64 ? 64 : 32);
+  obj->setLittleEndian(true);
+  obj->setFileType(FileType::Dylib);
+
+  quint32 ncmds = get<quint32>(offset + 16),
+    sizeofcmds = get<quint32>(offset + 20);
+  quint64 cmd = offset + (is64 ? 32 : 28), end = cmd + sizeofcmds;
+  if (!mapped->contains(cmd, sizeofcmds)) {
+    return false;
+  }
+
+  quint64 textAddr{0}, textSize{0}, funcStartsOff{0}, funcStartsSize{0};
+  quint64 symOff{0}, strOff{0};
+  quint32 symCount{0}, strSize{0};
+  for (quint32 i = 0; i < ncmds && cmd + 8 <= end; i++) {
+    quint32 type = get<quint32>(cmd), cmdsize = get<quint32>(cmd + 4);
+    if (cmdsize < 8) {
+      return false;
+    }
+
+    if (type == LC_SEGMENT || type == LC_SEGMENT_64) {
+      bool seg64 = (type == LC_SEGMENT_64);
+      QString segname = getString(cmd + 8).left(16);
+      quint64 vmaddr = (seg64 ? get<quint64>(cmd + 24) : get<quint32>(cmd + 24));
+      quint64 filesize = (seg64 ? get<quint64>(cmd + 48) : get<quint32>(cmd + 36));
+      quint32 nsects = get<quint32>(cmd + (seg64 ? 64 : 48));
+      if (segname == "__TEXT") {
+        textAddr = vmaddr;
+        textSize = filesize;
+      }
+
+      // Section offsets are found through their addresses since the
+      // segments of an image are spread across the cache.
+      quint64 sect = cmd + (seg64 ? 72 : 56);
+      for (quint32 j = 0; j < nsects; j++, sect += (seg64 ? 80 : 68)) {
+        QString secname = getString(sect).left(16),
+          secseg = getString(sect + 16).left(16);
+        quint64 addr = (seg64 ? get<quint64>(sect + 32) : get<quint32>(sect + 32));
+        quint64 size = (seg64 ? get<quint64>(sect + 40) : get<quint32>(sect + 36));
+
+        SectionType secType;
+        if (secseg != "__TEXT") continue;
+        if (secname == "__text") {
+          secType = SectionType::Text;
+        }
+        else if (secname == "__stubs" || secname == "__symbol_stub") {
+          secType = SectionType::SymbolStubs;
+        }
+        else if (secname == "__cstring" || secname == "__objc_methname") {
+          secType = SectionType::CString;
+        }
+        else {
+          continue;
+        }
+
+        quint64 secOff;
+        if (!space->toOffset(addr, secOff) || !mapped->contains(secOff, size)) {
+          continue;
+        }
+        obj->addSection(SectionPtr(new Section(secType, secname, addr, size,
+                                               secOff)));
+      }
+    }
+
+    else if (type == LC_SYMTAB) {
+      symOff = get<quint32>(cmd + 8);
+      symCount = get<quint32>(cmd + 12);
+      strOff = get<quint32>(cmd + 16);
+      strSize = get<quint32>(cmd + 20);
+    }
+
+    else if (type == LC_FUNCTION_STARTS) {
+      funcStartsOff = get<quint32>(cmd + 8);
+      funcStartsSize = get<quint32>(cmd + 12);
+    }
+
+    cmd += cmdsize;
+  }
+
+  quint64 textOff;
+  if (!space->toOffset(textAddr, textOff)) {
+    textOff = offset;
+  }
+  obj->setFileRange(textOff, textSize);
+
+  // Symbols of all images share the string table of the cache.
+  SymbolTable symTable;
+  quint32 nlistSize = (is64 ? 16 : 12);
+  if (symCount > 0 && mapped->contains(symOff, (quint64) symCount * nlistSize)) {
+    symTable = parseSymbols(symOff, symCount, strOff, strSize, is64);
+    obj->addSection(SectionPtr(new Section(SectionType::Symbols,
+                                           QObject::tr("Symbol Table"), 0,
+                                           symCount * nlistSize, symOff)));
+  }
+
+  indexLocalSymbols();
+  if (localEntries.contains(offset)) {
+    quint64 info = localSymOff;
+    auto entry = localEntries[offset];
+    quint64 nlistOff = info + get<quint32>(info),
+      stringsOff = info + get<quint32>(info + 8);
+    quint32 stringsSize = get<quint32>(info + 12);
+    auto locals = parseSymbols(nlistOff + (quint64) entry.first * nlistSize,
+                               entry.second, stringsOff, stringsSize, is64);
+    symTable.getSymbols().append(locals.getSymbols());
+  }
+  obj->setSymbolTable(symTable);
+
+  if (funcStartsSize > 0 && mapped->contains(funcStartsOff, funcStartsSize)) {
+    obj->addSection(SectionPtr(new Section(SectionType::FuncStarts,
+                                           QObject::tr("Function Starts"), 0,
+                                           funcStartsSize, funcStartsOff)));
+  }
+
+  foreach (auto sec, obj->getSections()) {
+    sec->setMappedData(mapped);
+  }
+
+  // Function starts are ULEB128 deltas from the start of __TEXT.
+  auto funcStarts = obj->getSection(SectionType::FuncStarts);
+  if (funcStarts) {
+    const QByteArray &data = funcStarts->getData();
+    QList<quint64> starts;
+    quint64 addr{textAddr}, delta{0};
+    int shift{0};
+    for (int i = 0; i < data.size(); i++) {
+      unsigned char ch = data[i];
+      if (shift > 63) break;
+      delta |= quint64(ch & 0x7F) << shift;
+      shift += 7;
+      if (ch & 0x80) continue;
+      if (delta == 0) break;
+      addr += delta;
+      starts << addr;
+      delta = 0;
+      shift = 0;
+    }
+    obj->setFunctionStarts(starts);
+  }
+  return true;
+}
+
+SymbolTable DyldCache::parseSymbols(quint64 symOff, quint32 count,
+                                    quint64 strOff, quint32 strSize,
+                                    bool is64) const {
+  SymbolTable table;
+  quint32 nlistSize = (is64 ? 16 : 12);
+  if (!mapped->contains(symOff, (quint64) count * nlistSize) ||
+      !mapped->contains(strOff, strSize)) {
+    return table;
+  }
+
+  const char *strs = (const char*) mapped->getPointer() + strOff;
+  for (quint32 i = 0; i < count; i++) {
+    quint64 sym = symOff + (quint64) i * nlistSize;
+    quint32 index = get<quint32>(sym);
+    quint8 type = get<quint8>(sym + 4);
+    quint64 value = (is64 ? get<quint64>(sym + 8) : get<quint32>(sym + 8));
+
+    // Debugging (stab) entries are skipped.
+    if (index == 0 || index >= strSize || (type & 0xE0)) {
+      continue;
+    }
+    QString name = QString::fromUtf8(strs + index,
+                                     qstrnlen(strs + index, strSize - index));
+    table.addSymbol(SymbolEntry(index, value, name));
+  }
+  return table;
+}
+
+void DyldCache::indexLocalSymbols() {
+  if (localsIndexed) return;
+  localsIndexed = true;
+
+  quint64 info = localSymOff;
+  if (info == 0 || !mapped->contains(info, 24) ||
+      !mapped->contains(info, localSymSize)) {
+    return;
+  }
+
+  quint32 mappingOff = get<quint32>(0x10);
+  bool wide = (mappingOff >= SYMBOL_FILE_UUID);
+  quint32 entrySize = (wide ? 16 : 12);
+  quint64 base = get<quint64>(mappingOff); // Address of the first mapping.
+
+  quint64 entriesOff = info + get<quint32>(info + 16);
+  quint32 entriesCount = get<quint32>(info + 20);
+  if (!mapped->contains(entriesOff, (quint64) entriesCount * entrySize)) {
+    return;
+  }
+  for (quint32 i = 0; i < entriesCount; i++) {
+    quint64 entry = entriesOff + (quint64) i * entrySize;
+    quint64 offset = get<quint32>(entry);
+    if (wide) {
+      // Images outside the mappings of this file are skipped.
+      if (!space->toOffset(base + get<quint64>(entry), offset)) {
+        continue;
+      }
+      entry += 4;
+    }
+    localEntries[offset] =
+      QPair<quint32, quint32>(get<quint32>(entry + 4), get<quint32>(entry + 8));
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef BMOD_DYLD_CACHE_FORMAT_H
+#define BMOD_DYLD_CACHE_FORMAT_H
+
+#include <QHash>
+#include <QPair>
+
+#include "Format.h"
+#include "../MappedFile.h"
+#include "../AddressSpace.h"
+
+/**
+ * dyld shared cache holding the system libraries of macOS and iOS. The
+ * cache is mapped and only its mappings and image list are indexed when
+ * parsed. Images become binary objects on request, with sections
+ * referring to the mapping.
+ */
+class DyldCache : public Format {
+public:
+  struct Image {
+    QString path;
+    quint64 addr;
+  };
+
+  DyldCache(const QString &file);
+
+  QString getFile() const { return file; }
+
+  bool detect();
+  bool parse();
+
+  /**
+   * Objects of the images loaded so far.
+   */
+  QList<BinaryObjectPtr> getObjects() const { return objects; }
+
+  const QList<Image> &getImages() const { return images; }
+
+  /**
+   * Index of the image with the path, or file name, or -1.
+   */
+  int findImage(const QString &path) const;
+
+  /**
+   * Object of the image, parsing it the first time.
+   */
+  BinaryObjectPtr loadImage(int idx);
+
+private:
+  template <typename T>
+  T get(quint64 offset) const;
+
+  QString getString(quint64 offset) const;
+
+  bool parseImage(quint64 offset, BinaryObjectPtr obj);
+
+  SymbolTable parseSymbols(quint64 symOff, quint32 count, quint64 strOff,
+                           quint32 strSize, bool is64) const;
+
+  /**
+   * Local symbols stripped from the images are kept in one table for the
+   * whole cache. Its index per image is only read when first needed.
+   */
+  void indexLocalSymbols();
+
+  QString file;
+  QList<BinaryObjectPtr> objects;
+  QList<Image> images;
+  QHash<int, BinaryObjectPtr> loaded;
+
+  MappedFilePtr mapped;
+  AddressSpacePtr space;
+
+  quint64 localSymOff, localSymSize;
+  bool localsIndexed;
+
+  // Image file offset -> (first nlist, count) of its local symbols.
+  QHash<quint64, QPair<quint32, quint32>> localEntries;
+};
+
+#endif // BMOD_DYLD_CACHE_FORMAT_H
@@ -0,0 +1,323 @@
+#include <QtEndian>
+
+#include "ELF.h"
+
+namespace {
+  // Section header types.
+  const quint32 SHT_PROGBITS{1}, SHT_SYMTAB{2}, SHT_STRTAB{3}, SHT_DYNSYM{11};
+
+  // Section header flags.
+  const quint64 SHF_ALLOC{0x2}, SHF_EXECINSTR{0x4}, SHF_STRINGS{0x20},
+    SHF_COMPRESSED{0x800};
+
+  // Program header types and flags.
+  const quint32 PT_LOAD{1}, PT_INTERP{3}, PF_X{0x1};
+
+  // Symbol types that do not name code or data.
+  const quint8 STT_SECTION{3}, STT_FILE{4};
+
+  struct SectionHeader {
+    QString name;
+    quint32 type, link;
+    quint64 flags, addr, offset, size, entSize;
+  };
+}
+
+ELF::ELF(const QString &file)
+  : Format(FormatType::ELF), file{file}, is64{false}, littleEndian{true}
+{ }
+
+bool ELF::detect() {
+  QFile f{file};
+  if (!f.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QByteArray ident = f.read(6);
+  return ident.size() == 6 && ident.startsWith("\x7F" "ELF") &&
+    (ident[4] == 1 || ident[4] == 2) && // 32-bit or 64-bit
+    (ident[5] == 1 || ident[5] == 2); // Little or big endian
+}
+
+bool ELF::parse() {
+  mapped = getMappedFile();
+  if (!mapped || !mapped->contains(0, 16)) {
+    return false;
+  }
+
+  const uchar *ident = mapped->getPointer();
+  is64 = (ident[4] == 2);
+  littleEndian = (ident[5] == 1);
+  if (!mapped->contains(0, is64 ? 64 : 52)) {
+    return false;
+  }
+
+  BinaryObjectPtr binaryObject(new BinaryObject);
+  binaryObject->setSystemBits(is64 ? 64 : 32);
+  binaryObject->setLittleEndian(littleEndian);
+
+  quint16 type = get<quint16>(16), machine = get<quint16>(18);
+  switch (machine) {
+  case 3: // EM_386
+    binaryObject->setCpuType(CpuType::X86);
+    binaryObject->setCpuSubType(CpuType::I386);
+    break;
+
+  case 62: // EM_X86_64
+    binaryObject->setCpuType(CpuType::X86_64);
+    binaryObject->setCpuSubType(CpuType::X86_64);
+    break;
+
+  case 40: // EM_ARM
+  case 183: // EM_AARCH64
+    binaryObject->setCpuType(CpuType::ARM);
+    binaryObject->setCpuSubType(CpuType::ARM);
+    break;
+
+  case 2: // EM_SPARC
+  case 43: // EM_SPARCV9
+    binaryObject->setCpuType(CpuType::SPARC);
+    binaryObject->setCpuSubType(CpuType::SPARC);
+    break;
+
+  case 20: // EM_PPC
+    binaryObject->setCpuType(CpuType::PowerPC);
+    binaryObject->setCpuSubType(CpuType::PowerPC);
+    break;
+
+  case 21: // EM_PPC64
+    binaryObject->setCpuType(CpuType::PowerPC_64);
+    binaryObject->setCpuSubType(CpuType::PowerPC_64);
+    break;
+
+  case 15: // EM_PARISC
+    binaryObject->setCpuType(CpuType::HPPA);
+    binaryObject->setCpuSubType(CpuType::HPPA);
+    break;
+
+  case 7: // EM_860
+    binaryObject->setCpuType(CpuType::I860);
+    binaryObject->setCpuSubType(CpuType::I860);
+    break;
+
+  default:
+    break;
+  }
+
+  quint64 entry = getWord(24),
+    phoff = getWord(is64 ? 32 : 28),
+    shoff = getWord(is64 ? 40 : 32);
+  quint64 flagsOff = (is64 ? 48 : 36);
+  quint16 phentsize = get<quint16>(flagsOff + 6),
+    phnum = get<quint16>(flagsOff + 8),
+    shentsize = get<quint16>(flagsOff + 10);
+  quint32 shnum = get<quint16>(flagsOff + 12),
+    shstrndx = get<quint16>(flagsOff + 14);
+
+  // Program headers.
+  bool interp{false};
+  QList<SectionPtr> loadSecs;
+  if (phoff > 0 && mapped->contains(phoff, (quint64) phnum * phentsize)) {
+    for (quint16 i = 0; i < phnum; i++) {
+      quint64 ph = phoff + (quint64) i * phentsize;
+      quint32 ptype = get<quint32>(ph);
+      quint32 pflags = get<quint32>(ph + (is64 ? 4 : 24));
+      quint64 poffset = getWord(ph + (is64 ? 8 : 4)),
+        pvaddr = getWord(ph + (is64 ? 16 : 8)),
+        pfilesz = getWord(ph + (is64 ? 32 : 16));
+
+      if (ptype == PT_INTERP) {
+        interp = true;
+      }
+
+      // Executable segments stand in for the code if there are no
+      // section headers, like in stripped binaries.
+      else if (ptype == PT_LOAD && (pflags & PF_X) && pfilesz > 0 &&
+               mapped->contains(poffset, pfilesz)) {
+        loadSecs << SectionPtr(new Section(SectionType::Text,
+                                           QObject::tr("Executable Segment"),
+                                           pvaddr, pfilesz, poffset));
+      }
+    }
+  }
+
+  switch (type) {
+  case 1: // ET_REL
+    binaryObject->setFileType(FileType::Object);
+    break;
+
+  default:
+  case 2: // ET_EXEC
+    binaryObject->setFileType(FileType::Execute);
+    break;
+
+  case 3: // ET_DYN, which is also used for position independent executables.
+    binaryObject->setFileType(interp ? FileType::Execute : FileType::Dylib);
+    break;
+
+  case 4: // ET_CORE
+    binaryObject->setFileType(FileType::Core);
+    break;
+  }
+
+  // Section headers. The real count and string table index are stored in
+  // the first header if they don't fit.
+  QList<SectionHeader> headers;
+  quint64 shSize = (is64 ? 64 : 40);
+  if (shoff > 0 && shentsize >= shSize && mapped->contains(shoff, shentsize)) {
+    if (shnum == 0) {
+      shnum = getWord(shoff + (is64 ? 32 : 20));
+    }
+    if (shstrndx == 0xFFFF) {
+      shstrndx = get<quint32>(shoff + (is64 ? 40 : 24));
+    }
+    if (!mapped->contains(shoff, (quint64) shnum * shentsize)) {
+      shnum = 0;
+    }
+
+    for (quint32 i = 0; i < shnum; i++) {
+      quint64 sh = shoff + (quint64) i * shentsize;
+      SectionHeader header;
+      header.type = get<quint32>(sh + 4);
+      header.flags = getWord(sh + 8);
+      header.addr = getWord(sh + (is64 ? 16 : 12));
+      header.offset = getWord(sh + (is64 ? 24 : 16));
+      header.size = getWord(sh + (is64 ? 32 : 20));
+      header.link = get<quint32>(sh + (is64 ? 40 : 24));
+      header.entSize = getWord(sh + (is64 ? 56 : 36));
+      headers << header;
+    }
+
+    // Resolve names from the section name string table.
+    if (shstrndx < (quint32) headers.size()) {
+      const auto &strtab = headers[shstrndx];
+      for (quint32 i = 0; i < shnum; i++) {
+        quint32 name = get<quint32>(shoff + (quint64) i * shentsize);
+        headers[i].name = getString(strtab.offset, strtab.size, name);
+      }
+    }
+  }
+
+  for (int i = 0; i < headers.size(); i++) {
+    const auto &header = headers[i];
+    if (header.size == 0 || !mapped->contains(header.offset, header.size)) {
+      continue;
+    }
+
+    // Sections not loaded in memory are addressed by file offset.
+    quint64 addr = ((header.flags & SHF_ALLOC) ? header.addr : header.offset);
+    SectionPtr sec;
+
+    if (header.type == SHT_PROGBITS && (header.flags & SHF_EXECINSTR)) {
+      if (header.name == ".text") {
+        sec = SectionPtr(new Section(SectionType::Text, header.name, addr,
+                                     header.size, header.offset));
+      }
+      else if (header.name.startsWith(".plt")) {
+        sec = SectionPtr(new Section(SectionType::SymbolStubs, header.name,
+                                     addr, header.size, header.offset));
+      }
+    }
+
+    // Compressed debug sections are not supported.
+    else if (header.type == SHT_PROGBITS && header.name.startsWith(".debug_")) {
+      if (!(header.flags & SHF_COMPRESSED)) {
+        auto debugSec = SectionPtr(new Section(SectionType::Debug, header.name,
+                                               addr, header.size,
+                                               header.offset));
+        debugSec->setMappedData(mapped);
+        binaryObject->addDebugSection(debugSec);
+      }
+    }
+
+    else if (header.type == SHT_PROGBITS && (header.flags & SHF_STRINGS)) {
+      sec = SectionPtr(new Section(SectionType::CString, header.name, addr,
+                                   header.size, header.offset));
+    }
+
+    else if ((header.type == SHT_SYMTAB || header.type == SHT_DYNSYM) &&
+             header.link < (quint32) headers.size()) {
+      const auto &strtab = headers[header.link];
+      auto table = parseSymbols(header.offset, header.size, header.entSize,
+                                strtab.offset, strtab.size);
+      if (header.type == SHT_SYMTAB) {
+        binaryObject->setSymbolTable(table);
+        sec = SectionPtr(new Section(SectionType::Symbols, header.name, addr,
+                                     header.size, header.offset));
+      }
+      else {
+        binaryObject->setDynSymbolTable(table);
+        sec = SectionPtr(new Section(SectionType::DynSymbols, header.name,
+                                     addr, header.size, header.offset));
+      }
+    }
+
+    else if (header.type == SHT_STRTAB && header.name == ".strtab") {
+      sec = SectionPtr(new Section(SectionType::String, header.name, addr,
+                                   header.size, header.offset));
+    }
+
+    if (sec) {
+      binaryObject->addSection(sec);
+    }
+  }
+
+  if (!binaryObject->getSection(SectionType::Text)) {
+    foreach (auto sec, loadSecs) {
+      binaryObject->addSection(sec);
+    }
+  }
+
+  // Section bytes refer to the mapping and are paged in when used.
+  foreach (auto sec, binaryObject->getSections()) {
+    sec->setMappedData(mapped);
+  }
+
+  binaryObject->setEntryPoint(entry);
+  objects << binaryObject;
+  return true;
+}
+
+template <typename T>
+T ELF::get(quint64 offset) const {
+  if (!mapped->contains(offset, sizeof(T))) {
+    return 0;
+  }
+  const uchar *ptr = mapped->getPointer() + offset;
+  return (littleEndian ? qFromLittleEndian<T>(ptr) : qFromBigEndian<T>(ptr));
+}
+
+quint64 ELF::getWord(quint64 offset) const {
+  return (is64 ? get<quint64>(offset) : get<quint32>(offset));
+}
+
+QString ELF::getString(quint64 strOff, quint64 strSize, quint32 index) const {
+  if (index >= strSize || !mapped->contains(strOff, strSize)) {
+    return QString();
+  }
+  const char *str = (const char*) mapped->getPointer() + strOff + index;
+  return QString::fromUtf8(str, qstrnlen(str, strSize - index));
+}
+
+SymbolTable ELF::parseSymbols(quint64 off, quint64 size, quint64 entSize,
+                              quint64 strOff, quint64 strSize) const {
+  SymbolTable table;
+  if (entSize < (quint64) (is64 ? 24 : 16)) {
+    return table;
+  }
+
+  quint64 count = size / entSize;
+  for (quint64 i = 0; i < count; i++) {
+    quint64 sym = off + i * entSize;
+    quint32 name = get<quint32>(sym);
+    quint8 info = get<quint8>(sym + (is64 ? 4 : 12));
+    quint64 value = (is64 ? get<quint64>(sym + 8) : get<quint32>(sym + 4));
+
+    quint8 symType = (info & 0xF);
+    if (name == 0 || symType == STT_SECTION || symType == STT_FILE) {
+      continue;
+    }
+    table.addSymbol(SymbolEntry(name, value, getString(strOff, strSize, name)));
+  }
+  return table;
+}
@@ -0,0 +1,44 @@
+#ifndef BMOD_ELF_FORMAT_H
+#define BMOD_ELF_FORMAT_H
+
+#include "Format.h"
+#include "../MappedFile.h"
+
+/**
+ * ELF32 and ELF64 files of either endianness. Everything is parsed
+ * straight from a memory mapping and sections refer to it without
+ * copying.
+ */
+class ELF : public Format {
+public:
+  ELF(const QString &file);
+
+  QString getFile() const { return file; }
+
+  bool detect();
+  bool parse();
+
+  QList<BinaryObjectPtr> getObjects() const { return objects; }
+
+private:
+  template <typename T>
+  T get(quint64 offset) const;
+
+  /**
+   * Word of the file class: 4 bytes for ELF32 and 8 for ELF64.
+   */
+  quint64 getWord(quint64 offset) const;
+
+  QString getString(quint64 strOff, quint64 strSize, quint32 index) const;
+
+  SymbolTable parseSymbols(quint64 off, quint64 size, quint64 entSize,
+                           quint64 strOff, quint64 strSize) const;
+
+  QString file;
+  QList<BinaryObjectPtr> objects;
+
+  MappedFilePtr mapped;
+  bool is64, littleEndian;
+};
+
+#endif // BMOD_ELF_FORMAT_H
@@ -1,3 +1,6 @@
+#include "ELF.h"
+#include "Archive.h"
+#include "DyldCache.h"
 #include "MachO.h"
 #include "Format.h"
 
@@ -8,5 +11,38 @@ FormatPtr Format::detect(const QString &file) {
     return res;
   }
 
+  // ELF
+  res = FormatPtr(new ELF(file));
+  if (res->detect()) {
+    return res;
+  }
+
+  // Static library archive
+  res = FormatPtr(new Archive(file));
+  if (res->detect()) {
+    return res;
+  }
+
+  // dyld shared cache
+  res = FormatPtr(new DyldCache(file));
+  if (res->detect()) {
+    return res;
+  }
+
   return nullptr;
 }
+
+void Format::setPrevious(FormatPtr prev, const IntervalSet &changed) {
+  prevFile = prev->getMappedFile();
+  this->changed = changed;
+}
+
+MappedFilePtr Format::getMappedFile() {
+  if (!mappedFile) {
+    mappedFile = (prevFile && watched
+                  ? MappedFile::reread(prevFile, changed)
+                  : MappedFile::open(getFile(), watched));
+    prevFile.reset();
+  }
+  return mappedFile;
+}
@@ -10,6 +10,8 @@
 #include "../Section.h"
 #include "../CpuType.h"
 #include "../FileType.h"
+#include "../MappedFile.h"
+#include "../IntervalSet.h"
 #include "../BinaryObject.h"
 
 class Format;
@@ -17,10 +19,24 @@ typedef std::shared_ptr<Format> FormatPtr;
 
 class Format {
 public:
-  Format(FormatType type) : type{type} { }
+  Format(FormatType type) : type{type}, watched{false} { }
 
   FormatType getType() const { return type; }
 
+  /**
+   * Watched files are read into memory instead of mapped when parsed, so
+   * they can be rewritten on disk while open. Set it before parsing.
+   */
+  bool isWatched() const { return watched; }
+  void setWatched(bool watched) { this->watched = watched; }
+
+  /**
+   * Parse the file again after it changed on disk. Only the changed file
+   * ranges are read, the rest is taken from the copy of the previous
+   * parse. Set it before parsing.
+   */
+  void setPrevious(FormatPtr prev, const IntervalSet &changed);
+
   virtual QString getFile() const =0;
 
   /**
@@ -45,8 +61,17 @@ public:
    */
   static FormatPtr detect(const QString &file);
 
+  /**
+   * Mapping of the file shared by all objects of the format. It is opened
+   * on first use.
+   */
+  MappedFilePtr getMappedFile();
+
 private:
   FormatType type;
+  bool watched;
+  MappedFilePtr mappedFile, prevFile;
+  IntervalSet changed; // Since the previous file.
 };
 
 #endif // BMOD_FORMAT_H
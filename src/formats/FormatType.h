@@ -2,7 +2,10 @@
 #define BMOD_FORMAT_TYPE_H
 
 enum class FormatType {
-  MachO
+  MachO,
+  ELF,
+  DyldCache,
+  Archive
 };
 
 #endif // BMOD_FORMAT_TYPE_H
@@ -1,4 +1,5 @@
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 
 #include <cmath>
@@ -6,6 +7,91 @@
 #include "MachO.h"
 #include "../Util.h"
 #include "../Reader.h"
+#include "../RelocationTable.h"
+#include "../MappedFile.h"
+
+namespace {
+  /**
+   * Read the states of an LC_THREAD command up to the end of it. Each state
+   * is a flavor and count of 32-bit words followed by the words. Registers
+   * of the known general purpose states are decoded.
+   */
+  bool readThreadState(Reader &r, CpuType cpuType, qint64 end,
+                       ThreadState &thread) {
+    static const QStringList x86_32{"eax", "ebx", "ecx", "edx", "edi", "esi",
+        "ebp", "esp", "ss", "eflags", "eip", "cs", "ds", "es", "fs", "gs"};
+    static const QStringList x86_64{"rax", "rbx", "rcx", "rdx", "rdi", "rsi",
+        "rbp", "rsp", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
+        "rip", "rflags", "cs", "fs", "gs"};
+
+    bool ok;
+    while (r.pos() + 8 <= end) {
+      quint32 flavor = r.getUInt32(&ok);
+      if (!ok) return false;
+
+      quint32 count = r.getUInt32(&ok);
+      if (!ok) return false;
+
+      qint64 stateEnd = r.pos() + (qint64) count * 4;
+      if (stateEnd > end) {
+        return false;
+      }
+
+      // Generic x86_THREAD_STATE has its own flavor and count header.
+      bool x86 = (cpuType == CpuType::X86 || cpuType == CpuType::X86_64);
+      if (x86 && flavor == 7 && count >= 2) {
+        flavor = r.getUInt32(&ok);
+        if (!ok) return false;
+        count = r.getUInt32(&ok);
+        if (!ok) return false;
+      }
+
+      // x86_THREAD_STATE32
+      if (x86 && flavor == 1 && count >= (quint32) x86_32.size()) {
+        foreach (const auto &name, x86_32) {
+          thread.addRegister(name, r.getUInt32());
+        }
+      }
+
+      // x86_THREAD_STATE64
+      else if (x86 && flavor == 4 && count >= (quint32) x86_64.size() * 2) {
+        foreach (const auto &name, x86_64) {
+          thread.addRegister(name, r.getUInt64());
+        }
+      }
+
+      // ARM_THREAD_STATE64
+      else if (cpuType == CpuType::ARM && flavor == 6 && count >= 66) {
+        for (int i = 0; i < 29; i++) {
+          thread.addRegister(QString("x%1").arg(i), r.getUInt64());
+        }
+        thread.addRegister("fp", r.getUInt64());
+        thread.addRegister("lr", r.getUInt64());
+        thread.addRegister("sp", r.getUInt64());
+        thread.addRegister("pc", r.getUInt64());
+        thread.addRegister("cpsr", r.getUInt32());
+      }
+
+      // ARM_THREAD_STATE
+      else if (cpuType == CpuType::ARM && flavor == 1 && count >= 17) {
+        for (int i = 0; i < 13; i++) {
+          thread.addRegister(QString("r%1").arg(i), r.getUInt32());
+        }
+        thread.addRegister("sp", r.getUInt32());
+        thread.addRegister("lr", r.getUInt32());
+        thread.addRegister("pc", r.getUInt32());
+        thread.addRegister("cpsr", r.getUInt32());
+      }
+
+      // Other states, like floating point and exception states, are
+      // skipped.
+      if (!r.seek(stateEnd)) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
 
 MachO::MachO(const QString &file) : Format(FormatType::MachO), file{file} { }
 
@@ -33,6 +119,7 @@ bool MachO::parse() {
   if (!f.open(QIODevice::ReadOnly)) {
     return false;
   }
+  mapped = getMappedFile();
 
   Reader r(f);
   bool ok;
@@ -83,15 +170,53 @@ bool MachO::parse() {
   }
 
   // Otherwise, just parse a single object file.
-  else {
-    return parseHeader(0, 0, r);
+  else if (!parseHeader(0, 0, r)) {
+    return false;
   }
 
+  loadDsym();
   return true;
 }
 
-bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
+void MachO::loadDsym() {
+  bool missing{false};
+  foreach (const auto obj, objects) {
+    missing = missing || obj->getDebugSections().isEmpty();
+  }
+  QString path = QString("%1.dSYM/Contents/Resources/DWARF/%2")
+    .arg(file).arg(QFileInfo(file).fileName());
+  if (!missing || !QFile::exists(path)) {
+    return;
+  }
+
+  MachO dsym(path);
+  if (!dsym.detect() || !dsym.parse()) {
+    return;
+  }
+
+  // Slices of fat binaries are matched by CPU type.
+  foreach (auto obj, objects) {
+    if (!obj->getDebugSections().isEmpty()) continue;
+    foreach (const auto other, dsym.getObjects()) {
+      if (other->getCpuType() != obj->getCpuType()) continue;
+      foreach (auto sec, other->getDebugSections()) {
+        obj->addDebugSection(sec);
+      }
+      break;
+    }
+  }
+}
+
+bool MachO::parseObject(QIODevice &dev, quint64 offset, quint64 size,
+                        MappedFilePtr mapped) {
+  this->mapped = mapped;
+  Reader r(dev);
+  return parseHeader(offset, size, r);
+}
+
+bool MachO::parseHeader(quint64 offset, quint64 size, Reader &r) {
   BinaryObjectPtr binaryObject(new BinaryObject);
+  binaryObject->setFileRange(offset, size);
 
   r.seek(offset);
   r.setLittleEndian(true);
@@ -161,7 +286,8 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
   else if (cputype == 11) { // CPU_TYPE_HPPA
     cpuType = CpuType::HPPA;
   }
-  else if (cputype == 12) { // CPU_TYPE_ARM
+  else if (cputype == 12 || // CPU_TYPE_ARM
+           cputype == 12 + 0x01000000) { // CPU_TYPE_ARM | CPU_ARCH_ABI64
     cpuType = CpuType::ARM;
   }
   else if (cputype == 14) { // CPU_TYPE_SPARC
@@ -279,9 +405,25 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
   // it.
   quint32 indirsymoff{0}, indirsymnum{0};
 
+  // Memory address and file offset of the __TEXT segment.
+  quint64 textAddr{0}, textOff{0};
+
+  // File (__TEXT) offset of main(), if any.
+  quint64 entryOff{0};
+
+  // Memory segments of core dumps.
+  QList<AddressSpace::Mapping> mappings;
+
+  // DWARF sections, if any.
+  QList<SectionPtr> debugSecs;
+
+  // Relocation entries (offset, count) of the code of object files.
+  QList<QPair<SectionPtr, QPair<quint32, quint32>>> relocSecs;
+
   // Parse load commands sequentially. Each consists of the type, size
   // and data.
   for (int i = 0; i < ncmds; i++) {
+    qint64 cmdStart = r.pos();
     quint32 type = r.getUInt32(&ok);
     if (!ok) return false;
 
@@ -336,13 +478,35 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
         if (!ok) return false;
       }
 
+      if (name == "__TEXT") {
+        textAddr = vmaddr;
+        textOff = fileoff;
+      }
+
       // Maximum VM protection.
       r.getUInt32(&ok);
       if (!ok) return false;
 
       // Initial VM protection.
-      r.getUInt32(&ok);
-      if (!ok) return false;
+      quint32 initprot = r.getUInt32(&ok);
+      if (!ok) return false;
+
+      // Segments are mapped to translate addresses to file offsets. Those
+      // of cores are the memory of the crashed process and are only
+      // mapped, never read.
+      bool segMapped{false};
+      if (vmsize > 0 && (filesize > 0 || fileType == FileType::Core)) {
+        segMapped = true;
+        AddressSpace::Mapping mapping;
+        mapping.name = name;
+        mapping.addr = vmaddr;
+        mapping.size = vmsize;
+        mapping.offset = offset + fileoff;
+        mapping.fileSize = filesize;
+        mapping.prot = initprot;
+        mapping.sectionsEnd = 0;
+        mappings << mapping;
+      }
 
       // Number of sections in segment.
       quint32 nsects = r.getUInt32(&ok);
@@ -390,15 +554,15 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
           if (!ok) return false;
 
           // File offset of relocation entries.
-          r.getUInt32(&ok);
+          quint32 reloff = r.getUInt32(&ok);
           if (!ok) return false;
 
           // Number of relocation entries.
-          r.getUInt32(&ok);
+          quint32 nreloc = r.getUInt32(&ok);
           if (!ok) return false;
 
           // Flags.
-          r.getUInt32(&ok);
+          quint32 secflags = r.getUInt32(&ok);
           if (!ok) return false;
 
           // Reserved fields.
@@ -408,6 +572,16 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
             r.getUInt32();
           }
 
+          // End of the section contents in the file, the rest of the
+          // segment is padding. Zero-fill sections have no contents.
+          quint32 sectype = (secflags & 0xFF);
+          bool zerofill = (sectype == 0x1 || sectype == 0xC || sectype == 0x12);
+          if (segMapped && secfileoff > 0 && !zerofill) {
+            auto &mapping = mappings.last();
+            mapping.sectionsEnd =
+              qMax(mapping.sectionsEnd, offset + secfileoff + secsize);
+          }
+
           // Store needed sections.
           if (segname == "__TEXT") {
             if (secname == "__text") {
@@ -415,6 +589,9 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
                                          QObject::tr("Program"),
                                          addr, secsize, offset + secfileoff));
               binaryObject->addSection(sec);
+              if (nreloc > 0) {
+                relocSecs << qMakePair(sec, qMakePair(reloff, nreloc));
+              }
             }
             else if (secname == "__symbol_stub" ||
                      secname == "__stubs") {
@@ -437,6 +614,24 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
             }
           }
 
+          // Objective-C metadata lists.
+          else if (segname.startsWith("__DATA") &&
+                   (secname == "__objc_classlist" ||
+                    secname == "__objc_catlist" ||
+                    secname == "__objc_selrefs")) {
+            SectionPtr sec(new Section(SectionType::ObjC, secname, addr,
+                                       secsize, offset + secfileoff));
+            binaryObject->addSection(sec);
+          }
+
+          // Debug information is mapped instead of read since it can be
+          // huge.
+          else if (segname == "__DWARF" && secsize > 0) {
+            SectionPtr sec(new Section(SectionType::Debug, secname, addr,
+                                       secsize, offset + secfileoff));
+            debugSecs << sec;
+          }
+
         }
       }
     }
@@ -640,7 +835,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
     // LC_MAIN
     else if (type == (0x28 | 0x80000000)) {
       // File (__TEXT) offset of main()
-      r.getUInt64(&ok);
+      entryOff = r.getUInt64(&ok);
       if (!ok) return false;
 
       // Initial stack size if not zero.
@@ -693,14 +888,13 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
 
     // LC_THREAD or LC_UNIXTHREAD
     else if (type == 0x4 || type == 0x5) {
-      quint32 flavor = r.getUInt32(&ok);
-      if (!ok) return false;
-
-      quint32 count = r.getUInt32(&ok);
-      if (!ok) return false;
-
-      // Data.
-      r.read(flavor * count);
+      ThreadState thread;
+      if (!readThreadState(r, cpuType, cmdStart + cmdsize, thread)) {
+        return false;
+      }
+      if (fileType == FileType::Core) {
+        binaryObject->addThread(thread);
+      }
     }
 
     // LC_RPATH
@@ -713,10 +907,26 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
       r.read(cmdsize - off);
     }
 
-    // Temporary: Fail if unknown!
-    else {
-      qDebug() << "what is type:" << type;
-      exit(0);
+    // Skip to the next command which also skips unknown commands.
+    if (!r.seek(cmdStart + cmdsize)) {
+      return false;
+    }
+  }
+
+  // Objects are left out since their metadata is only complete once
+  // relocated.
+  if (fileType != FileType::Object && !mappings.isEmpty()) {
+    if (mapped) {
+      auto space = AddressSpacePtr(new AddressSpace(mapped));
+      foreach (const auto &mapping, mappings) {
+        if (mapped->contains(mapping.offset, mapping.fileSize)) {
+          space->addMapping(mapping);
+        }
+      }
+      binaryObject->setAddressSpace(space);
+    }
+    else if (fileType == FileType::Core) {
+      return false;
     }
   }
 
@@ -724,8 +934,9 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
   // (/usr/include/macho/nlist.h)
   quint32 symsize{0};
   SymbolTable symTable;
+  QVector<bool> symDefined;
   if (symnum > 0) {
-    r.seek(symoff);
+    r.seek(offset + symoff);
     qint64 pos;
     for (int i = 0; i < symnum; i++) {
       pos = r.pos();
@@ -739,7 +950,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
       if (!ok) return false;
 
       // Section number or NO_SECT.
-      r.getUChar(&ok);
+      quint8 sect = r.getUChar(&ok);
       if (!ok) return false;
 
       // Description.
@@ -758,6 +969,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
       }
 
       symTable.addSymbol(SymbolEntry(index, value));
+      symDefined << (sect != 0);
       symsize += (r.pos() - pos);
     }
 
@@ -772,7 +984,7 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
   quint32 dynsymsize{0};
   SymbolTable dynsymTable;
   if (indirsymnum > 0) {
-    r.seek(indirsymoff);
+    r.seek(offset + indirsymoff);
     qint64 pos;
     for (int i = 0; i < indirsymnum; i++) {
       pos = r.pos();
@@ -790,12 +1002,54 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
     binaryObject->addSection(sec);
   }
 
-  // Fill data of stored sections.
+  // Fill data of stored sections. A private copy of the file is used as
+  // is, otherwise they are read.
   foreach (auto sec, binaryObject->getSections()) {
+    if (mapped && mapped->isCopied() &&
+        mapped->contains(sec->getOffset(), sec->getSize())) {
+      sec->setMappedData(mapped);
+      continue;
+    }
     r.seek(sec->getOffset());
     sec->setData(r.read(sec->getSize()));
   }
 
+  if (entryOff > 0) {
+    binaryObject->setEntryPoint(textAddr + entryOff - textOff);
+  }
+
+  if (!debugSecs.isEmpty() && mapped) {
+    foreach (auto sec, debugSecs) {
+      if (mapped->contains(sec->getOffset(), sec->getSize())) {
+        sec->setMappedData(mapped);
+        binaryObject->addDebugSection(sec);
+      }
+    }
+  }
+
+  // Function starts are ULEB128 encoded deltas with the first being
+  // relative to the start of __TEXT. A zero delta terminates.
+  auto funcStarts = binaryObject->getSection(SectionType::FuncStarts);
+  if (funcStarts) {
+    const QByteArray &data = funcStarts->getData();
+    QList<quint64> starts;
+    quint64 addr{textAddr}, delta{0};
+    int shift{0};
+    for (int i = 0; i < data.size(); i++) {
+      unsigned char ch = data[i];
+      if (shift > 63) break; // Malformed.
+      delta |= quint64(ch & 0x7F) << shift;
+      shift += 7;
+      if (ch & 0x80) continue;
+      if (delta == 0) break;
+      addr += delta;
+      starts << addr;
+      delta = 0;
+      shift = 0;
+    }
+    binaryObject->setFunctionStarts(starts);
+  }
+
   // If symbol table loaded then merge string table entries into it.
   if (symnum > 0) {
     auto strTable = binaryObject->getSection(SectionType::String);
@@ -816,6 +1070,62 @@ bool MachO::parseHeader(quint32 offset, quint32 size, Reader &r) {
     binaryObject->setSymbolTable(symTable);
   }
 
+  // Relocation entries (/usr/include/mach-o/reloc.h) of object files
+  // patch fields of the code, like call displacements that are zero
+  // until linked. External ones name a symbol by index.
+  foreach (const auto &relocSec, relocSecs) {
+    auto relocs = RelocationTablePtr(new RelocationTable);
+    quint32 reloff = relocSec.second.first, nreloc = relocSec.second.second;
+    if (!r.seek(offset + reloff)) {
+      return false;
+    }
+    const auto &symbols = symTable.getSymbols();
+    for (quint32 i = 0; i < nreloc; i++) {
+      quint32 address = r.getUInt32(&ok);
+      if (!ok) return false;
+
+      quint32 info = r.getUInt32(&ok);
+      if (!ok) return false;
+
+      RelocationTable::Relocation reloc;
+      reloc.value = 0;
+      reloc.resolved = false;
+      reloc.scattered = (address & 0x80000000);
+      if (reloc.scattered) {
+        // Scattered entries give the target address instead of a symbol.
+        reloc.offset = (address & 0xFFFFFF);
+        reloc.type = (address >> 24) & 0xF;
+        reloc.length = (address >> 28) & 0x3;
+        reloc.pcRel = (address >> 30) & 0x1;
+        reloc.external = false;
+        reloc.symbolNum = 0;
+        reloc.value = info;
+        reloc.resolved = true;
+        symTable.getString(info, reloc.symbol);
+      }
+      else {
+        reloc.offset = address;
+        reloc.symbolNum = (info & 0xFFFFFF);
+        reloc.pcRel = (info >> 24) & 0x1;
+        reloc.length = (info >> 25) & 0x3;
+        reloc.external = (info >> 27) & 0x1;
+        reloc.type = (info >> 28) & 0xF;
+        if (reloc.external && reloc.symbolNum < (quint32) symbols.size()) {
+          reloc.symbol = symbols[reloc.symbolNum].getString();
+
+          // Symbols defined in the object are at their value.
+          if (symDefined[reloc.symbolNum]) {
+            reloc.value = symbols[reloc.symbolNum].getValue();
+            reloc.resolved = true;
+          }
+        }
+      }
+      relocs->addRelocation(reloc);
+    }
+    relocs->sort();
+    relocSec.first->setRelocations(relocs);
+  }
+
   // If dynamic symbol table loaded then merge data from symbol table
   // and symbol stubs into it.
   if (indirsymnum > 0 && symnum > 0) {
@@ -4,6 +4,7 @@
 #include "Format.h"
 
 class Reader;
+class QIODevice;
 
 class MachO : public Format {
 public:
@@ -16,11 +17,26 @@ public:
 
   QList<BinaryObjectPtr> getObjects() const { return objects; }
 
+  /**
+   * Parse a single object embedded in the file at the offset, like a
+   * member of an archive. Mapped data is taken from the mapping of the
+   * containing file.
+   */
+  bool parseObject(QIODevice &dev, quint64 offset, quint64 size,
+                   MappedFilePtr mapped);
+
 private:
-  bool parseHeader(quint32 offset, quint32 size, Reader &reader);
+  bool parseHeader(quint64 offset, quint64 size, Reader &reader);
+
+  /**
+   * Use the debug information of the dSYM bundle next to the file for
+   * objects that have none.
+   */
+  void loadDsym();
 
   QString file;
   QList<BinaryObjectPtr> objects;
+  MappedFilePtr mapped; // Null if the file could not be mapped.
 };
 
 #endif // BMOD_MACHO_FORMAT_H
@@ -1,12 +1,157 @@
 #include <QDebug> //
 #include <QTimer>
 #include <QStringList>
+#include <QTextStream>
 #include <QApplication>
 
+#include "Util.h"
+#include "Patch.h"
 #include "Version.h"
+#include "Checksum.h"
+#include "QueryServer.h"
+#include "formats/Format.h"
 #include "widgets/MainWindow.h"
 
+namespace {
+  /**
+   * Apply a patch without the GUI:
+   *   bmod --apply-patch <patch> <target>..
+   */
+  int applyPatch(const QStringList &args) {
+    QTextStream out(stdout);
+    if (args.size() < 2) {
+      out << "Usage: bmod --apply-patch <patch> <target>..\n";
+      return 1;
+    }
+
+    auto patch = Patch::load(args[0]);
+    if (!patch) {
+      out << "Could not read patch: " << args[0] << "\n";
+      return 1;
+    }
+
+    QStringList targets = args.mid(1);
+    auto results = patch->applyAll(targets);
+    int failed{0};
+    for (int i = 0; i < targets.size(); i++) {
+      auto res = results[i];
+      out << targets[i] << ": " << Util::patchResultString(res) << "\n";
+      if (res == Patch::Result::Mismatch || res == Patch::Result::Error) {
+        failed++;
+      }
+    }
+    return (failed > 0 ? 2 : 0);
+  }
+
+  /**
+   * Print the digests of each slice and section:
+   *   bmod --checksum <file>..
+   */
+  int checksum(const QStringList &files) {
+    QTextStream out(stdout);
+    if (files.isEmpty()) {
+      out << "Usage: bmod --checksum <file>..\n";
+      return 1;
+    }
+
+    int failed{0};
+    foreach (const auto &file, files) {
+      auto fmt = Format::detect(file);
+      if (!fmt || !fmt->parse()) {
+        out << file << ": Could not parse file\n";
+        failed++;
+        continue;
+      }
+
+      // All slices are hashed from one mapping of the file.
+      auto objs = fmt->getObjects();
+      QList<QPair<quint64, quint64>> ranges;
+      foreach (auto obj, objs) {
+        ranges << qMakePair(obj->getFileOffset(), obj->getFileSize());
+      }
+      bool ok;
+      auto slices = Checksum::digestRanges(file, ranges, &ok);
+      if (!ok) {
+        out << file << ": Could not read file\n";
+        failed++;
+        continue;
+      }
+
+      for (int i = 0; i < objs.size(); i++) {
+        auto obj = objs[i];
+        const auto &slice = slices[i];
+        out << file << " (" << Util::cpuTypeString(obj->getCpuType()) << ")"
+            << " crc32c=" << slice.crc32cString()
+            << " xxh64=" << slice.xxh64String()
+            << " sha256=" << slice.sha256String() << "\n";
+
+        auto secs = obj->getSections();
+        auto digests = Checksum::digestSections(secs);
+        for (int j = 0; j < secs.size(); j++) {
+          const auto &digest = digests[j];
+          out << "  " << secs[j]->getName()
+              << " crc32c=" << digest.crc32cString()
+              << " xxh64=" << digest.xxh64String()
+              << " sha256=" << digest.sha256String() << "\n";
+        }
+      }
+    }
+    return (failed > 0 ? 2 : 0);
+  }
+
+  /**
+   * Serve analysis queries on a local socket until killed:
+   *   bmod --daemon <socket> [<memory budget in MiB>]
+   */
+  int serve(QCoreApplication &app, const QStringList &args) {
+    QTextStream out(stdout);
+    if (args.isEmpty()) {
+      out << "Usage: bmod --daemon <socket> [<memory budget in MiB>]\n";
+      return 1;
+    }
+
+    quint64 budget{1024};
+    if (args.size() > 1) {
+      bool ok;
+      budget = args[1].toULongLong(&ok);
+      if (!ok || budget == 0) {
+        out << "Invalid memory budget: " << args[1] << "\n";
+        return 1;
+      }
+    }
+
+    QueryServer server(budget * 1024 * 1024);
+    if (!server.listen(args[0])) {
+      out << "Could not listen on " << args[0] << ": "
+          << server.errorString() << "\n";
+      return 1;
+    }
+    return app.exec();
+  }
+}
+
 int main(int argc, char **argv) {
+  if (argc > 1 && QString::fromUtf8(argv[1]) == "--apply-patch") {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bmod");
+    QCoreApplication::setApplicationVersion(versionString());
+    return applyPatch(app.arguments().mid(2));
+  }
+
+  if (argc > 1 && QString::fromUtf8(argv[1]) == "--checksum") {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bmod");
+    QCoreApplication::setApplicationVersion(versionString());
+    return checksum(app.arguments().mid(2));
+  }
+
+  if (argc > 1 && QString::fromUtf8(argv[1]) == "--daemon") {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bmod");
+    QCoreApplication::setApplicationVersion(versionString());
+    return serve(app, app.arguments().mid(2));
+  }
+
   QApplication app(argc, argv);
   QCoreApplication::setApplicationName("bmod");
   QCoreApplication::setApplicationVersion(versionString());
@@ -1,16 +1,28 @@
 #include <QLabel>
 #include <QGridLayout>
 #include <QVBoxLayout>
+#include <QApplication>
+#include <QProgressDialog>
 
 #include "../Util.h"
 #include "ArchPane.h"
+#include "../Checksum.h"
+#include "../widgets/TreeWidget.h"
 
-ArchPane::ArchPane(FormatType type, BinaryObjectPtr obj)
-  : Pane(Kind::Arch), type{type}, obj{obj}
+ArchPane::ArchPane(FormatType type, const QString &file, BinaryObjectPtr obj)
+  : Pane(Kind::Arch), type{type}, file{file}, obj{obj}, shown{false}
 {
   createLayout();
 }
 
+void ArchPane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    setupDigests();
+  }
+}
+
 void ArchPane::createLayout() {
   auto *gridLayout = new QGridLayout;
   gridLayout->setContentsMargins(0, 0, 0, 0);
@@ -45,11 +57,64 @@ void ArchPane::createLayout() {
   auto *w = new QWidget;
   w->setMaximumWidth(300);
   w->setLayout(gridLayout);
-  
+
+  sliceLabel = new QLabel;
+  sliceLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+  treeWidget = new TreeWidget;
+  treeWidget->setHeaderLabels(QStringList{tr("Section"), tr("Size"),
+        tr("CRC32C"), tr("XXH64"), tr("SHA-256")});
+  treeWidget->setColumnWidth(0, 150);
+  treeWidget->setColumnWidth(1, 70);
+  treeWidget->setColumnWidth(2, 70);
+  treeWidget->setColumnWidth(3, 130);
+
   auto *layout = new QVBoxLayout;
   layout->setContentsMargins(0, 0, 0, 0);
   layout->addWidget(w);
-  layout->addStretch();
+  layout->addWidget(sliceLabel);
+  layout->addWidget(treeWidget);
 
   setLayout(layout);
 }
+
+void ArchPane::setupDigests() {
+  treeWidget->clear();
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Computing checksums.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  bool ok;
+  QList<QPair<quint64, quint64>> ranges;
+  ranges << qMakePair(obj->getFileOffset(), obj->getFileSize());
+  auto slice = Checksum::digestRanges(file, ranges, &ok);
+  if (ok && !slice.isEmpty()) {
+    const auto &digest = slice.first();
+    sliceLabel->setText(tr("Slice CRC32C: %1\nSlice XXH64: %2\n"
+                           "Slice SHA-256: %3")
+                        .arg(digest.crc32cString())
+                        .arg(digest.xxh64String())
+                        .arg(digest.sha256String()));
+  }
+  else {
+    sliceLabel->setText(tr("Could not read file to compute slice checksums!"));
+  }
+
+  auto secs = obj->getSections();
+  auto digests = Checksum::digestSections(secs);
+  for (int i = 0; i < secs.size(); i++) {
+    const auto &digest = digests[i];
+    auto *item = new QTreeWidgetItem;
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setText(0, secs[i]->getName());
+    item->setText(1, Util::formatSize(secs[i]->getData().size()));
+    item->setText(2, digest.crc32cString());
+    item->setText(3, digest.xxh64String());
+    item->setText(4, digest.sha256String());
+    treeWidget->addTopLevelItem(item);
+  }
+}
@@ -5,15 +5,27 @@
 #include "../BinaryObject.h"
 #include "../formats/FormatType.h"
 
+class QLabel;
+class TreeWidget;
+
 class ArchPane : public Pane {
 public:
-  ArchPane(FormatType type, BinaryObjectPtr obj);
+  ArchPane(FormatType type, const QString &file, BinaryObjectPtr obj);
+
+protected:
+  void showEvent(QShowEvent *event);
 
 private:
   void createLayout();
+  void setupDigests();
 
   FormatType type;
+  QString file;
   BinaryObjectPtr obj;
+
+  bool shown;
+  QLabel *sliceLabel;
+  TreeWidget *treeWidget;
 };
 
 #endif // BMOD_ARCH_PANE_H
@@ -0,0 +1,54 @@
+#include <QLabel>
+#include <QVBoxLayout>
+
+#include "ArchivePane.h"
+#include "../widgets/TreeWidget.h"
+
+ArchivePane::ArchivePane(std::shared_ptr<Archive> archive)
+  : Pane(Kind::Archive), archive{archive}, shown{false}
+{
+  createLayout();
+}
+
+void ArchivePane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+}
+
+void ArchivePane::createLayout() {
+  label = new QLabel;
+
+  treeWidget = new TreeWidget;
+  treeWidget->setHeaderLabels(QStringList{tr("Symbol"), tr("Member")});
+  treeWidget->setColumnWidth(0, 300);
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addWidget(label);
+  layout->addWidget(treeWidget);
+
+  setLayout(layout);
+}
+
+void ArchivePane::setup() {
+  const auto &members = archive->getMembers();
+  const auto &symbols = archive->getSymbolIndex();
+
+  QList<QTreeWidgetItem*> items;
+  for (auto it = symbols.constBegin(); it != symbols.constEnd(); ++it) {
+    auto *item = new QTreeWidgetItem;
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setText(0, it.key());
+    item->setText(1, members[it.value()].name);
+    items << item;
+  }
+  treeWidget->addTopLevelItems(items);
+  treeWidget->sortItems(0, Qt::AscendingOrder);
+
+  label->setText(tr("%1 members, %2 objects, %3 symbols")
+                 .arg(members.size()).arg(archive->getObjects().size())
+                 .arg(symbols.size()));
+}
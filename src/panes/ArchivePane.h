@@ -0,0 +1,28 @@
+#ifndef BMOD_ARCHIVE_PANE_H
+#define BMOD_ARCHIVE_PANE_H
+
+#include "Pane.h"
+#include "../formats/Archive.h"
+
+class QLabel;
+class TreeWidget;
+
+class ArchivePane : public Pane {
+public:
+  ArchivePane(std::shared_ptr<Archive> archive);
+
+protected:
+  void showEvent(QShowEvent *event);
+
+private:
+  void createLayout();
+  void setup();
+
+  std::shared_ptr<Archive> archive;
+
+  bool shown;
+  QLabel *label;
+  TreeWidget *treeWidget;
+};
+
+#endif // BMOD_ARCHIVE_PANE_H
@@ -0,0 +1,172 @@
+#include <QMenu>
+#include <QLabel>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QApplication>
+#include <QProgressDialog>
+
+#include "../Util.h"
+#include "CallGraphPane.h"
+#include "../analysis/CallGraph.h"
+#include "../analysis/ControlFlowGraph.h"
+#include "../widgets/TreeWidget.h"
+
+CallGraphPane::CallGraphPane(BinaryObjectPtr obj)
+  : Pane(Kind::CallGraph), obj{obj}, shown{false}
+{
+  createLayout();
+}
+
+void CallGraphPane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+}
+
+void CallGraphPane::onItemDoubleClicked(QTreeWidgetItem *item, int column) {
+  Q_UNUSED(column);
+  auto graph = obj->getCallGraph();
+  quint64 addr = item->text(0).toULongLong(nullptr, 16);
+  int node = graph->findNode(addr);
+  if (node == -1) {
+    return;
+  }
+
+  // Show the jump list of the callers up to the chosen depth.
+  auto callers = graph->getCallersUpTo(node, depthSpin->value());
+  constexpr int max{50};
+  QMenu menu;
+  for (int i = 0; i < callers.size() && i < max; i++) {
+    quint64 caller = graph->getAddress(callers[i].first);
+    auto *action =
+      menu.addAction(tr("%1: %2")
+                     .arg(callers[i].second)
+                     .arg(Util::functionName(obj, caller)));
+    action->setData(caller);
+  }
+  if (callers.isEmpty()) {
+    menu.addAction(tr("No callers"))->setEnabled(false);
+  }
+  else if (callers.size() > max) {
+    menu.addAction(tr("(%1 more)").arg(callers.size() - max))->setEnabled(false);
+  }
+
+  auto *action = menu.exec(QCursor::pos());
+  if (action && action->data().isValid()) {
+    treeWidget->selectAddress(action->data().toULongLong());
+  }
+}
+
+void CallGraphPane::createLayout() {
+  label = new QLabel;
+
+  depthSpin = new QSpinBox;
+  depthSpin->setRange(1, 100);
+  depthSpin->setValue(3);
+
+  auto *topLayout = new QHBoxLayout;
+  topLayout->setContentsMargins(0, 0, 0, 0);
+  topLayout->addWidget(label);
+  topLayout->addStretch();
+  topLayout->addWidget(new QLabel(tr("Callers depth:")));
+  topLayout->addWidget(depthSpin);
+
+  treeWidget = new TreeWidget;
+  treeWidget->setHeaderLabels(QStringList{tr("Address"), tr("Function"),
+        tr("Calls"), tr("Callers"), tr("Recursive"), tr("Reachable")});
+  treeWidget->setColumnWidth(0, obj->getSystemBits() == 64 ? 110 : 70);
+  treeWidget->setColumnWidth(1, 200);
+  treeWidget->setColumnWidth(2, 50);
+  treeWidget->setColumnWidth(3, 50);
+  treeWidget->setColumnWidth(4, 70);
+  treeWidget->setColumnWidth(5, 70);
+  treeWidget->setAddressColumn(0);
+  connect(treeWidget, &QTreeWidget::itemDoubleClicked,
+          this, &CallGraphPane::onItemDoubleClicked);
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addLayout(topLayout);
+  layout->addWidget(treeWidget);
+
+  setLayout(layout);
+}
+
+void CallGraphPane::setup() {
+  treeWidget->clear();
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Building call graph.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  auto cfg = obj->getControlFlowGraph();
+  auto graph = obj->getCallGraph();
+
+  int compCount{0};
+  auto comps = graph->getComponents(&compCount);
+  QVector<int> compSizes(compCount, 0);
+  foreach (quint32 comp, comps) {
+    compSizes[comp]++;
+  }
+
+  // Reachability is from the entry point, or from all symbols if there
+  // is none like for libraries.
+  QList<quint32> roots;
+  int entry = graph->findNode(obj->getEntryPoint());
+  if (entry != -1) {
+    roots << entry;
+  }
+  else {
+    foreach (const auto &symbol, obj->getSymbolTable().getSymbols()) {
+      int node = graph->findNode(symbol.getValue());
+      if (node != -1) {
+        roots << node;
+      }
+    }
+  }
+  auto reached = graph->getReachable(roots);
+
+  int padSize = obj->getSystemBits() / 8, unreached{0};
+  foreach (const auto &func, cfg->getFunctions()) {
+    int node = graph->findNode(func.addr);
+    if (node == -1) continue;
+
+    auto *item = new QTreeWidgetItem;
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setText(0, Util::padString(QString::number(func.addr, 16).toUpper(),
+                                     padSize));
+    item->setText(1, Util::functionName(obj, func.addr));
+
+    auto callees = graph->getCallees(node);
+    item->setText(2, QString::number(callees.size()));
+    item->setText(3, QString::number(graph->getCallers(node).size()));
+
+    int compSize = compSizes[comps[node]];
+    if (compSize > 1) {
+      item->setText(4, tr("Yes (%1)").arg(compSize));
+    }
+    else if (callees.contains(node)) {
+      item->setText(4, tr("Yes"));
+    }
+
+    if (reached[node]) {
+      item->setText(5, tr("Yes"));
+    }
+    else {
+      item->setText(5, tr("No"));
+      unreached++;
+    }
+    treeWidget->addTopLevelItem(item);
+  }
+
+  label->setText(tr("%1 functions, %2 calls, %3 unreachable")
+                 .arg(treeWidget->topLevelItemCount())
+                 .arg(graph->getEdgeCount())
+                 .arg(unreached));
+}
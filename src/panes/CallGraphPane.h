@@ -0,0 +1,37 @@
+#ifndef BMOD_CALL_GRAPH_PANE_H
+#define BMOD_CALL_GRAPH_PANE_H
+
+#include <QTreeWidgetItem>
+
+#include "Pane.h"
+#include "../BinaryObject.h"
+
+class QLabel;
+class QSpinBox;
+class TreeWidget;
+
+class CallGraphPane : public Pane {
+  Q_OBJECT
+
+public:
+  CallGraphPane(BinaryObjectPtr obj);
+
+protected:
+  void showEvent(QShowEvent *event);
+
+private slots:
+  void onItemDoubleClicked(QTreeWidgetItem *item, int column);
+
+private:
+  void createLayout();
+  void setup();
+
+  BinaryObjectPtr obj;
+
+  bool shown;
+  QLabel *label;
+  QSpinBox *depthSpin;
+  TreeWidget *treeWidget;
+};
+
+#endif // BMOD_CALL_GRAPH_PANE_H
@@ -0,0 +1,126 @@
+#include <QSet>
+#include <QFile>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QApplication>
+#include <QProgressDialog>
+
+#include "../Util.h"
+#include "CodeSignaturePane.h"
+#include "../widgets/TreeWidget.h"
+#include "../formats/CodeSignature.h"
+
+CodeSignaturePane::CodeSignaturePane(const QString &file, BinaryObjectPtr obj,
+                                     SectionPtr sec)
+  : Pane(Kind::CodeSignature), file{file}, obj{obj}, sec{sec}, shown{false}
+{
+  createLayout();
+}
+
+void CodeSignaturePane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+  else if (sec->isModified()) {
+    QDateTime mod = sec->modifiedWhen();
+    if (secModified.isNull() || mod != secModified) {
+      secModified = mod;
+      setup();
+    }
+  }
+}
+
+void CodeSignaturePane::createLayout() {
+  label = new QLabel;
+
+  treeWidget = new TreeWidget;
+  treeWidget->setHeaderLabels(QStringList{tr("Slot"), tr("File Offset"),
+        tr("Hash"), tr("Status")});
+  treeWidget->setColumnWidth(0, 200);
+  treeWidget->setColumnWidth(1, obj->getSystemBits() == 64 ? 110 : 70);
+  treeWidget->setColumnWidth(2, 300);
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addWidget(label);
+  layout->addWidget(treeWidget);
+
+  setLayout(layout);
+}
+
+void CodeSignaturePane::setup() {
+  treeWidget->clear();
+
+  auto sig = CodeSignature::parse(sec);
+  if (!sig) {
+    label->setText(tr("No code directory found."));
+    return;
+  }
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Verifying page hashes.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  bool ok{false};
+  QVector<QList<int>> mismatches;
+  QFile f(file);
+  if (f.open(QIODevice::ReadOnly)) {
+    mismatches = sig->verify(f, &ok);
+  }
+  if (!ok) {
+    label->setText(tr("Could not read file to verify page hashes!"));
+    return;
+  }
+
+  int padSize = obj->getSystemBits() / 8, total{0}, invalid{0};
+  const auto &dirs = sig->getDirectories();
+  for (int i = 0; i < dirs.size(); i++) {
+    const auto &dir = dirs[i];
+    auto bad = mismatches[i].toSet();
+    quint64 pageSize = dir.getPageSize();
+
+    auto *dirItem = new QTreeWidgetItem;
+    dirItem->setFlags(Qt::ItemIsEnabled);
+    dirItem->setText(0, dir.ident);
+    dirItem->setText(1, Util::hashTypeString(dir.hashType));
+    dirItem->setText(2, tr("%1 pages of %2")
+                     .arg(dir.codeSlots).arg(Util::formatSize(pageSize)));
+    if (bad.isEmpty()) {
+      dirItem->setText(3, tr("Valid"));
+    }
+    else {
+      dirItem->setText(3, tr("%1 mismatches").arg(bad.size()));
+      Util::setTreeItemMarked(dirItem, 3);
+    }
+
+    for (quint32 slot = 0; slot < dir.codeSlots; slot++) {
+      auto *item = new QTreeWidgetItem;
+      item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+      item->setText(0, QString::number(slot));
+      quint64 off = sig->getBase() + slot * pageSize;
+      item->setText(1, Util::padString(QString::number(off, 16).toUpper(),
+                                       padSize));
+      item->setText(2, QString(sig->getHash(dir, slot).toHex()));
+      if (bad.contains(slot)) {
+        item->setText(3, tr("Mismatch"));
+        Util::setTreeItemMarked(item, 3);
+      }
+      else {
+        item->setText(3, tr("OK"));
+      }
+      dirItem->addChild(item);
+    }
+
+    treeWidget->addTopLevelItem(dirItem);
+    total += dir.codeSlots;
+    invalid += bad.size();
+  }
+
+  label->setText(tr("%1 code directories, %2 of %3 page hashes mismatch")
+                 .arg(dirs.size()).arg(invalid).arg(total));
+}
@@ -0,0 +1,34 @@
+#ifndef BMOD_CODE_SIGNATURE_PANE_H
+#define BMOD_CODE_SIGNATURE_PANE_H
+
+#include <QDateTime>
+
+#include "Pane.h"
+#include "../Section.h"
+#include "../BinaryObject.h"
+
+class QLabel;
+class TreeWidget;
+
+class CodeSignaturePane : public Pane {
+public:
+  CodeSignaturePane(const QString &file, BinaryObjectPtr obj, SectionPtr sec);
+
+protected:
+  void showEvent(QShowEvent *event);
+
+private:
+  void createLayout();
+  void setup();
+
+  QString file;
+  BinaryObjectPtr obj;
+  SectionPtr sec;
+  QDateTime secModified;
+
+  bool shown;
+  QLabel *label;
+  TreeWidget *treeWidget;
+};
+
+#endif // BMOD_CODE_SIGNATURE_PANE_H
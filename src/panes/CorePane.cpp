@@ -0,0 +1,196 @@
+#include <QLabel>
+#include <QLineEdit>
+#include <QSplitter>
+#include <QTabWidget>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QMessageBox>
+
+#include "../Util.h"
+#include "CorePane.h"
+#include "DisassemblyPane.h"
+#include "../widgets/TreeWidget.h"
+#include "../widgets/MachineCodeWidget.h"
+
+namespace {
+  // Size of the memory window shown around an address.
+  const quint64 WINDOW_SIZE{64 * 1024};
+
+  QString protString(quint32 prot) {
+    return QString("%1%2%3")
+      .arg(prot & 1 ? "r" : "-")
+      .arg(prot & 2 ? "w" : "-")
+      .arg(prot & 4 ? "x" : "-");
+  }
+}
+
+CorePane::CorePane(BinaryObjectPtr obj)
+  : Pane(Kind::Core), obj{obj}, space{obj->getAddressSpace()}, shown{false}
+{
+  createLayout();
+}
+
+void CorePane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+}
+
+void CorePane::onAddressEntered() {
+  bool ok;
+  QString text = addrEdit->text().trimmed();
+  if (text.startsWith("0x", Qt::CaseInsensitive)) {
+    text = text.mid(2);
+  }
+  quint64 addr = text.toULongLong(&ok, 16);
+  if (!ok) {
+    QMessageBox::warning(this, "bmod", tr("Invalid address!"));
+    return;
+  }
+  jumpTo(addr);
+}
+
+void CorePane::onItemDoubleClicked(QTreeWidgetItem *item, int column) {
+  Q_UNUSED(column);
+  QVariant data = item->data(0, Qt::UserRole);
+  if (data.isValid()) {
+    jumpTo(data.toULongLong());
+  }
+}
+
+void CorePane::createLayout() {
+  label = new QLabel;
+
+  addrEdit = new QLineEdit;
+  addrEdit->setPlaceholderText(tr("Address (hex)"));
+  connect(addrEdit, &QLineEdit::returnPressed,
+          this, &CorePane::onAddressEntered);
+
+  auto *topLayout = new QHBoxLayout;
+  topLayout->addWidget(label);
+  topLayout->addStretch();
+  topLayout->addWidget(addrEdit);
+
+  threadsWidget = new TreeWidget;
+  threadsWidget->setHeaderLabels(QStringList{tr("Register"), tr("Value")});
+  threadsWidget->setColumnWidth(0, 120);
+  connect(threadsWidget, &TreeWidget::itemDoubleClicked,
+          this, &CorePane::onItemDoubleClicked);
+
+  segmentsWidget = new TreeWidget;
+  segmentsWidget->setHeaderLabels(QStringList{tr("Segment"), tr("Address"),
+        tr("Size"), tr("File Offset"), tr("Protection")});
+  segmentsWidget->setColumnWidth(0, 120);
+  segmentsWidget->setColumnWidth(1, 140);
+  segmentsWidget->setColumnWidth(2, 80);
+  segmentsWidget->setColumnWidth(3, 140);
+  connect(segmentsWidget, &TreeWidget::itemDoubleClicked,
+          this, &CorePane::onItemDoubleClicked);
+
+  viewWidget = new QTabWidget;
+
+  auto *treeSplitter = new QSplitter(Qt::Horizontal);
+  treeSplitter->addWidget(threadsWidget);
+  treeSplitter->addWidget(segmentsWidget);
+
+  auto *splitter = new QSplitter(Qt::Vertical);
+  splitter->addWidget(treeSplitter);
+  splitter->addWidget(viewWidget);
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addLayout(topLayout);
+  layout->addWidget(splitter);
+
+  setLayout(layout);
+}
+
+void CorePane::setup() {
+  int padSize = obj->getSystemBits() / 4;
+
+  const auto &threads = obj->getThreads();
+  for (int i = 0; i < threads.size(); i++) {
+    auto *threadItem = new QTreeWidgetItem;
+    threadItem->setFlags(Qt::ItemIsEnabled);
+    threadItem->setText(0, tr("Thread %1").arg(i));
+    foreach (const auto &reg, threads[i].getRegisters()) {
+      auto *item = new QTreeWidgetItem;
+      item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+      item->setText(0, reg.first);
+      item->setText(1, Util::padString(QString::number(reg.second, 16)
+                                       .toUpper(), padSize));
+      item->setData(0, Qt::UserRole, reg.second);
+      threadItem->addChild(item);
+    }
+    threadsWidget->addTopLevelItem(threadItem);
+  }
+  threadsWidget->expandAll();
+
+  quint64 total{0};
+  foreach (const auto &mapping, space->getMappings()) {
+    auto *item = new QTreeWidgetItem;
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setText(0, mapping.name);
+    item->setText(1, Util::padString(QString::number(mapping.addr, 16)
+                                     .toUpper(), padSize));
+    item->setText(2, Util::formatSize(mapping.size));
+    item->setText(3, QString::number(mapping.offset, 16).toUpper());
+    item->setText(4, protString(mapping.prot));
+    item->setData(0, Qt::UserRole, mapping.addr);
+    segmentsWidget->addTopLevelItem(item);
+    total += mapping.size;
+  }
+
+  label->setText(tr("%1 threads, %2 segments of %3 memory")
+                 .arg(threads.size()).arg(space->getMappings().size())
+                 .arg(Util::formatSize(total)));
+}
+
+void CorePane::jumpTo(quint64 addr) {
+  int idx = space->findMapping(addr);
+  quint64 offset;
+  if (idx == -1 || !space->toOffset(addr, offset)) {
+    QMessageBox::warning(this, "bmod",
+                         tr("Address is not in the dumped memory!"));
+    return;
+  }
+
+  // Reuse the window if the address is in one already shown.
+  for (int i = 0; i < viewWidget->count(); i++) {
+    auto *tabs = viewWidget->widget(i);
+    if (addr >= tabs->property("start").toULongLong() &&
+        addr < tabs->property("end").toULongLong()) {
+      viewWidget->setCurrentIndex(i);
+      return;
+    }
+  }
+
+  // Window of memory aligned to 16 bytes and clipped to the mapping.
+  const auto &mapping = space->getMappings()[idx];
+  quint64 start = qMax(addr & ~quint64(0xF), mapping.addr),
+    end = qMin(start + WINDOW_SIZE, mapping.addr + mapping.fileSize);
+  quint64 startOff = mapping.offset + (start - mapping.addr);
+
+  auto sec = SectionPtr(new Section(SectionType::Memory, mapping.name, start,
+                                    end - start, startOff));
+  sec->setMappedData(space->getFile());
+
+  // Added to the object so commits and searches include it.
+  obj->addSection(sec);
+
+  auto *tabs = new QTabWidget;
+  tabs->setProperty("start", start);
+  tabs->setProperty("end", end);
+  auto *codeWidget = new MachineCodeWidget(obj, sec);
+  connect(codeWidget, SIGNAL(modified()), this, SIGNAL(modified()));
+  tabs->addTab(codeWidget, tr("Memory"));
+  auto *disPane = new DisassemblyPane(obj, sec);
+  connect(disPane, SIGNAL(modified()), this, SIGNAL(modified()));
+  tabs->addTab(disPane, tr("Disassembly"));
+
+  int tab = viewWidget->addTab(tabs, QString("%1 %2").arg(mapping.name)
+                               .arg(QString::number(start, 16).toUpper()));
+  viewWidget->setCurrentIndex(tab);
+}
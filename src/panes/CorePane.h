@@ -0,0 +1,47 @@
+#ifndef BMOD_CORE_PANE_H
+#define BMOD_CORE_PANE_H
+
+#include <QTreeWidgetItem>
+
+#include "Pane.h"
+#include "../Section.h"
+#include "../BinaryObject.h"
+
+class QLabel;
+class QLineEdit;
+class QTabWidget;
+class TreeWidget;
+
+/**
+ * Threads and memory segments of a core dump. Memory is only read in
+ * small windows around the addresses that are jumped to.
+ */
+class CorePane : public Pane {
+  Q_OBJECT
+
+public:
+  CorePane(BinaryObjectPtr obj);
+
+protected:
+  void showEvent(QShowEvent *event);
+
+private slots:
+  void onAddressEntered();
+  void onItemDoubleClicked(QTreeWidgetItem *item, int column);
+
+private:
+  void createLayout();
+  void setup();
+  void jumpTo(quint64 addr);
+
+  BinaryObjectPtr obj;
+  AddressSpacePtr space;
+
+  bool shown;
+  QLabel *label;
+  QLineEdit *addrEdit;
+  TreeWidget *threadsWidget, *segmentsWidget;
+  QTabWidget *viewWidget;
+};
+
+#endif // BMOD_CORE_PANE_H
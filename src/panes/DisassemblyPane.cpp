@@ -1,7 +1,11 @@
+#include <QSet>
+#include <QHash>
+#include <QMenu>
 #include <QDebug>
 #include <QLabel>
 #include <QLineEdit>
-#include <QMessageBox>
+#include <QFileInfo>
+#include <QScrollBar>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -12,14 +16,17 @@
 #include "../Util.h"
 #include "DisassemblyPane.h"
 #include "../asm/Disassembler.h"
+#include "../formats/DwarfLineTable.h"
+#include "../analysis/ObjcIndex.h"
+#include "../analysis/XrefIndex.h"
+#include "../analysis/ControlFlowGraph.h"
 #include "../widgets/TreeWidget.h"
 
 namespace {
   class ItemDelegate : public QStyledItemDelegate {
   public:
-    ItemDelegate(DisassemblyPane *pane, QTreeWidget *tree, BinaryObjectPtr obj,
-                 SectionPtr sec)
-      : pane{pane}, tree{tree}, obj{obj}, sec{sec}
+    ItemDelegate(DisassemblyPane *pane, QTreeWidget *tree, SectionPtr sec)
+      : pane{pane}, tree{tree}, sec{sec}
     { }
 
     QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option,
@@ -58,37 +65,14 @@ namespace {
         if (newStr == oldStr) {
           return;
         }
-        model->setData(index, newStr);
         auto *item = tree->topLevelItem(index.row());
         if (item) {
-          Util::setTreeItemMarked(item, index.column());
-
-          // Change region.
+          // The pane redecodes the affected rows when the section changes.
           quint64 addr = item->text(0).toULongLong(nullptr, 16);
           quint64 pos = addr - sec->getAddress();
           QByteArray data = Util::hexToData(newStr.replace(" ", ""));
           sec->setSubData(data, pos);
 
-          // Update disassembly.
-          auto tmpSec =
-            SectionPtr(new Section(SectionType::Text, QString(), addr, pos));
-          tmpSec->setData(data);
-
-          Disassembler dis(obj);
-          Disassembly result;
-          if (dis.disassemble(tmpSec, result)) {
-            item->setText(2, result.asmLines.join("   "));
-            if (result.asmLines.size() > 1) {
-              pane->showUpdateButton();
-              QMessageBox::information(nullptr, "bmod",
-                                       tr("Changes implied new code lines.") + "\n" +
-                                       tr("Disassemble again for clear representation."));
-            }
-          }
-          else {
-            item->setText(2, tr("Could not disassemble!"));
-          }
-
           emit pane->modified();
         }
       }
@@ -97,15 +81,189 @@ namespace {
   private:
     DisassemblyPane *pane;
     QTreeWidget *tree;
-    BinaryObjectPtr obj;
     SectionPtr sec;
   };
+
+  /**
+   * Upper case hex of len bytes at pos separated by spaces.
+   */
+  QString hexString(const QByteArray &data, int pos, int len) {
+    QString code;
+    for (int j = pos; j < pos + len && j < data.size(); j++) {
+      QString hex =
+        Util::padString(QString::number((unsigned char) data[j], 16), 2);
+      code += hex + " ";
+    }
+    if (code.endsWith(" ")) {
+      code.chop(1);
+    }
+    return code.toUpper();
+  }
+
+  /**
+   * Data line listing len bytes at pos.
+   */
+  QString byteLine(const QByteArray &data, int pos, int len) {
+    QStringList bytes;
+    for (int i = 0; i < len; i++) {
+      bytes << "0x" +
+        Util::padString(QString::number((unsigned char) data[pos + i], 16)
+                        .toUpper(), 2);
+    }
+    return ".byte " + bytes.join(",");
+  }
+
+  /**
+   * Address of an instruction row, or of the function that a header row
+   * precedes.
+   */
+  quint64 rowAddress(QTreeWidgetItem *item) {
+    if (item->text(0).isEmpty()) {
+      return item->data(0, Qt::UserRole).toULongLong();
+    }
+    return item->text(0).toULongLong(nullptr, 16);
+  }
+
+  /**
+   * Selectors loaded from selector references by address of the loading
+   * instruction.
+   */
+  QHash<quint64, QString> selectorLoads(ObjcIndexPtr objc,
+                                        const Disassembly &result) {
+    QHash<quint64, QString> selLoads;
+    if (objc) {
+      foreach (const auto &ref, result.references) {
+        QString sel;
+        if (ref.type == Reference::Type::Data &&
+            objc->getSelector(ref.to, sel)) {
+          selLoads[ref.from] = sel;
+        }
+      }
+    }
+    return selLoads;
+  }
+
+  /**
+   * Show loaded selectors on the loading instruction and on the following
+   * message send.
+   */
+  QString annotateLine(const QString &line, quint64 addr,
+                       const QHash<quint64, QString> &selLoads,
+                       QString &lastSel) {
+    if (selLoads.contains(addr)) {
+      lastSel = selLoads[addr];
+      return line + "  ; @selector(" + lastSel + ")";
+    }
+    if (!lastSel.isEmpty() && line.contains("objc_msgSend")) {
+      QString res = line + "  ; " + lastSel;
+      lastSel.clear();
+      return res;
+    }
+    return line;
+  }
+
+  bool isDataRow(QTreeWidgetItem *item) {
+    return item->text(2).startsWith(".byte");
+  }
+
+  struct Line {
+    QTreeWidgetItem *item;
+    int pos, len;
+  };
+
+  /**
+   * Disassemble the bytes covered by recovered basic blocks and sweep the
+   * remaining bytes linearly. Bytes of instructions that would run into a
+   * block are listed as data. Returns false if no block lies inside the
+   * section.
+   */
+  bool disassembleBlocks(BinaryObjectPtr obj, SectionPtr sec,
+                         ControlFlowGraphPtr cfg, Disassembly &result) {
+    const auto &blocks = cfg->getBlocks();
+    const QByteArray &data = sec->getData();
+    const quint64 secAddr = sec->getAddress();
+    const quint32 size = data.size();
+
+    // Merge adjacent blocks into code regions [start, end). Blocks
+    // overlapping a region are decoded differently and are skipped.
+    QList<QPair<quint32, quint32>> regions;
+    foreach (quint32 idx, cfg->getBlockOrder()) {
+      const auto &block = blocks[idx];
+      if (block.addr < secAddr || block.addr + block.size > secAddr + size) {
+        continue;
+      }
+      quint32 start = block.addr - secAddr, end = start + block.size;
+      if (!regions.isEmpty() && start <= regions.last().second) {
+        if (start == regions.last().second) {
+          regions.last().second = end;
+        }
+        continue;
+      }
+      regions << qMakePair(start, end);
+    }
+    if (regions.isEmpty()) {
+      return false;
+    }
+
+    // Empty region to sweep trailing bytes.
+    regions << qMakePair(size, size);
+
+    Disassembler dis(obj);
+    quint32 pos{0};
+    foreach (const auto &region, regions) {
+      if (pos < region.first) {
+        Disassembly gap;
+        dis.disassemble(sec, pos, region.first - pos, gap);
+        int ref{0};
+        for (int i = 0; i < gap.asmLines.size(); i++) {
+          int len = gap.bytesConsumed[i];
+          if (pos + len > region.first) break;
+          result.asmLines << gap.asmLines[i];
+          result.bytesConsumed << len;
+          result.flows << gap.flows[i];
+          result.shapes << gap.shapes[i];
+          pos += len;
+        }
+        while (ref < gap.references.size() &&
+               gap.references[ref].from < secAddr + pos) {
+          result.references << gap.references[ref++];
+        }
+      }
+
+      // Data is listed in rows of up to 8 bytes.
+      while (pos < region.first) {
+        int len = qMin<quint32>(8, region.first - pos);
+        result.asmLines << byteLine(data, pos, len);
+        result.bytesConsumed << len;
+        result.flows << FlowType::Invalid;
+        result.shapes << 0;
+        pos += len;
+      }
+
+      if (region.second > region.first) {
+        Disassembly code;
+        if (!dis.disassemble(sec, region.first, region.second - region.first,
+                             code)) {
+          return false;
+        }
+        result.asmLines += code.asmLines;
+        result.bytesConsumed += code.bytesConsumed;
+        result.flows += code.flows;
+        result.shapes += code.shapes;
+        result.references += code.references;
+        pos = region.second;
+      }
+    }
+    return true;
+  }
 }
 
 DisassemblyPane::DisassemblyPane(BinaryObjectPtr obj, SectionPtr sec)
   : Pane(Kind::Disassembly), obj{obj}, sec{sec}, shown{false}
 {
   createLayout();
+  connect(sec.get(), &Section::dataChanged,
+          this, &DisassemblyPane::onDataChanged);
 }
 
 void DisassemblyPane::showUpdateButton() {
@@ -118,19 +276,84 @@ void DisassemblyPane::showEvent(QShowEvent *event) {
     shown = true;
     setup();
   }
-  else if (sec->isModified()) {
-    QDateTime mod = sec->modifiedWhen();
-    if (secModified.isNull() || mod != secModified) {
-      secModified = mod;
-      setup();
-    }
+  else if (sec->isDiffed() && sec->diffedWhen() != secDiffed) {
+    // Edits are shown as they happen but differences are not.
+    secDiffed = sec->diffedWhen();
+    invalidateAnalyses();
+    setup();
   }
 }
 
+bool DisassemblyPane::selectAddress(quint64 addr) {
+  quint64 start = sec->getAddress();
+  if (addr < start || addr >= start + sec->getSize()) {
+    return false;
+  }
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+  return treeWidget->selectAddress(addr);
+}
+
 void DisassemblyPane::onUpdateClicked() {
+  invalidateAnalyses();
   setup();
 }
 
+void DisassemblyPane::onItemDoubleClicked(QTreeWidgetItem *item, int column) {
+  if (column != 3 || item->text(3).isEmpty()) {
+    return;
+  }
+
+  // Show the jump list of the referrers.
+  quint64 addr = item->text(0).toULongLong(nullptr, 16);
+  auto refs = obj->getXrefIndex()->getReferences(addr);
+  constexpr int max{50};
+  int padSize = obj->getSystemBits() / 8;
+  QMenu menu;
+  for (int i = 0; i < refs.size() && i < max; i++) {
+    const auto &ref = refs[i];
+    auto *action =
+      menu.addAction(tr("%1 from %2")
+                     .arg(Util::referenceTypeString(ref.type))
+                     .arg(Util::padString(QString::number(ref.from, 16).toUpper(),
+                                          padSize)));
+    action->setData(ref.from);
+  }
+  if (refs.size() > max) {
+    menu.addAction(tr("(%1 more)").arg(refs.size() - max))->setEnabled(false);
+  }
+
+  auto *action = menu.exec(QCursor::pos());
+  if (action && action->data().isValid()) {
+    treeWidget->selectAddress(action->data().toULongLong());
+  }
+}
+
+void DisassemblyPane::updateSources() {
+  if (!lines) return;
+
+  // Only rows in view are looked up so line programs are decoded just
+  // for the units being looked at.
+  int height = treeWidget->viewport()->height();
+  auto *item = treeWidget->itemAt(0, 0);
+  while (item && treeWidget->visualItemRect(item).top() < height) {
+    if (!item->text(0).isEmpty() && !item->data(4, Qt::UserRole).toBool()) {
+      item->setData(4, Qt::UserRole, true);
+      quint64 addr = item->text(0).toULongLong(nullptr, 16);
+      QString file;
+      int line;
+      if (lines->lookup(addr, file, line)) {
+        item->setText(4, QString("%1:%2").arg(QFileInfo(file).fileName())
+                      .arg(line));
+        item->setToolTip(4, file);
+      }
+    }
+    item = treeWidget->itemBelow(item);
+  }
+}
+
 void DisassemblyPane::createLayout() {
   label = new QLabel;
 
@@ -146,11 +369,17 @@ void DisassemblyPane::createLayout() {
   topLayout->addWidget(updateBtn);
 
   treeWidget = new TreeWidget;
-  treeWidget->setHeaderLabels(QStringList{tr("Address"), tr("Data"), tr("Disassembly")});
+  treeWidget->setHeaderLabels(QStringList{tr("Address"), tr("Data"),
+        tr("Disassembly"), tr("Xrefs"), tr("Source")});
   treeWidget->setColumnWidth(0, obj->getSystemBits() == 64 ? 110 : 70);
   treeWidget->setColumnWidth(1, 200);
   treeWidget->setColumnWidth(2, 200);
-  treeWidget->setItemDelegate(new ItemDelegate(this, treeWidget, obj, sec));
+  treeWidget->setColumnWidth(3, 50);
+  connect(treeWidget, &QTreeWidget::itemDoubleClicked,
+          this, &DisassemblyPane::onItemDoubleClicked);
+  connect(treeWidget->verticalScrollBar(), &QScrollBar::valueChanged,
+          this, &DisassemblyPane::updateSources);
+  treeWidget->setItemDelegate(new ItemDelegate(this, treeWidget, sec));
   treeWidget->setMachineCodeColumns(QList<int>{1});
   treeWidget->setCpuType(obj->getCpuType());
   treeWidget->setAddressColumn(0);
@@ -163,10 +392,18 @@ void DisassemblyPane::createLayout() {
   setLayout(layout);
 }
 
+void DisassemblyPane::invalidateAnalyses() {
+  // Rebuilt from the modified code on next request.
+  obj->dropStaleAnalyses();
+}
+
 void DisassemblyPane::setup() {
   updateBtn->hide();
   treeWidget->clear();
 
+  lines = obj->getLineTable();
+  treeWidget->setColumnHidden(4, !lines);
+
   QProgressDialog progDiag(this);
   progDiag.setLabelText(tr("Disassembling data.."));
   progDiag.setCancelButton(nullptr);
@@ -179,50 +416,68 @@ void DisassemblyPane::setup() {
   const QByteArray &data = sec->getData();
 
   const auto &symTable = obj->getSymbolTable();
+  quint64 xrefVersion, cfgVersion;
+  xrefs = obj->getXrefIndex(&xrefVersion);
+  const auto &diffRegs = sec->getDiffRegions();
 
+  // List only code reachable from known functions if any were found,
+  // otherwise do a linear sweep of the whole section.
+  auto cfg = obj->getControlFlowGraph(&cfgVersion);
   Disassembler dis(obj);
   Disassembly result;
-  if (dis.disassemble(sec, result)) {
+  bool blocks = disassembleBlocks(obj, sec, cfg, result);
+  if (blocks || dis.disassemble(sec, result)) {
     int len = result.asmLines.size();
-    label->setText(tr("%1 instructions").arg(len));
+    if (blocks) {
+      int funcs{0};
+      foreach (const auto &func, cfg->getFunctions()) {
+        if (func.addr >= addr && func.addr < addr + size) {
+          funcs++;
+        }
+      }
+      label->setText(tr("%1 lines, %2 functions").arg(len).arg(funcs));
+    }
+    else {
+      label->setText(tr("%1 instructions").arg(len));
+    }
+
+    auto objc = obj->getObjcIndex();
+    auto selLoads = selectorLoads(objc, result);
+    QString lastSel;
+
     for (int i = 0; i < len; i++) {
       const QString &line = result.asmLines[i];
       short bytes = result.bytesConsumed[i];
 
       // Check if this is the beginning of a function.
       QString funcName;
-      if (symTable.getString(addr, funcName)) {
+      if (!symTable.getString(addr, funcName) &&
+          !(objc && objc->getImplementationName(addr, funcName)) &&
+          cfg->findFunction(addr) != -1) {
+        funcName = Util::functionName(obj, addr);
+      }
+      if (!funcName.isEmpty()) {
         auto *item = new QTreeWidgetItem;
         item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+        item->setData(0, Qt::UserRole, addr);
         int col{2};
         item->setText(col, funcName);
         auto font = item->font(col);
         font.setBold(true);
         item->setFont(col, font);
         if (i > 0) {
-          treeWidget->addTopLevelItem(new QTreeWidgetItem);
+          auto *blank = new QTreeWidgetItem;
+          blank->setData(0, Qt::UserRole, addr);
+          treeWidget->addTopLevelItem(blank);
         }
         treeWidget->addTopLevelItem(item);
       }
 
       auto *item = new QTreeWidgetItem;
-      item->setFlags(Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-      item->setText(0, Util::padString(QString::number(addr, 16).toUpper(),
-                                       obj->getSystemBits() / 8));
-
-      QString code;
-      for (int j = pos; j < pos + bytes && j < size; j++) {
-        QString hex =
-          Util::padString(QString::number((unsigned char) data[j], 16), 2);
-        code += hex + " ";
-      }
-      if (code.endsWith(" ")) {
-        code.chop(1);
+      setItemLine(item, pos, bytes, annotateLine(line, addr, selLoads, lastSel));
+      if (diffRegs.intersects(pos, bytes)) {
+        Util::setTreeItemDiffed(item, 1);
       }
-      code = code.toUpper();
-      item->setText(1, code);
-
-      item->setText(2, line);
       treeWidget->addTopLevelItem(item);
 
       addr += bytes;
@@ -271,8 +526,211 @@ void DisassemblyPane::setup() {
     }
 
     treeWidget->setFocus();
+    updateSources();
   }
   else {
     label->setText(tr("Could not disassemble machine code!"));
   }
+
+  // Analyses of the code before edits are shown until updated.
+  quint64 version = obj->getVersion();
+  if (xrefVersion != version || cfgVersion != version) {
+    showUpdateButton();
+  }
+}
+
+void DisassemblyPane::onDataChanged(int pos, int size) {
+  // Rows are made from the current data once shown.
+  if (!shown || size <= 0) return;
+
+  // Rows are in address order with function headers before the
+  // instruction they name, so the row holding the first changed byte is
+  // the last instruction row at or before it.
+  quint64 secAddr = sec->getAddress();
+  int rows = treeWidget->topLevelItemCount(), lo{0}, hi{rows};
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (rowAddress(treeWidget->topLevelItem(mid)) <= secAddr + pos) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  int row = lo - 1;
+  while (row > 0 && treeWidget->topLevelItem(row)->text(0).isEmpty()) {
+    row--;
+  }
+  row = qMax(row, 0);
+
+  const QByteArray &data = sec->getData();
+  int end = pos + size;
+  while (row < treeWidget->topLevelItemCount()) {
+    auto *item = treeWidget->topLevelItem(row);
+    if (item->text(0).isEmpty()) {
+      row++;
+      continue;
+    }
+    int start = item->text(0).toULongLong(nullptr, 16) - secAddr;
+    if (start >= end) break;
+
+    // Data rows keep their sizes.
+    if (isDataRow(item)) {
+      int len = item->text(1).split(" ", QString::SkipEmptyParts).size();
+      if (start + len > pos) {
+        setItemLine(item, start, len, byteLine(data, start, len));
+        Util::setTreeItemMarked(item, 1);
+      }
+      row++;
+      continue;
+    }
+    row = redecode(row, pos, end);
+  }
+}
+
+int DisassemblyPane::redecode(int row, int pos, int end) {
+  // Decode from the instruction of the row until a line ends on an old row
+  // boundary after the change, widening the window until it does. Code is
+  // never decoded into the data rows that follow it.
+  const QByteArray &data = sec->getData();
+  quint64 secAddr = sec->getAddress();
+  int rows = treeWidget->topLevelItemCount(), next{row}, limit = data.size();
+  QList<Line> oldLines;
+  QSet<int> bounds;
+  auto gather = [&](int until) {
+    for (; next < rows; next++) {
+      auto *item = treeWidget->topLevelItem(next);
+      if (item->text(0).isEmpty()) continue;
+      Line line;
+      line.item = item;
+      line.pos = item->text(0).toULongLong(nullptr, 16) - secAddr;
+      if (line.pos > until) break;
+      if (isDataRow(item)) {
+        limit = line.pos;
+        next = rows;
+        break;
+      }
+      line.len = item->text(1).split(" ", QString::SkipEmptyParts).size();
+      oldLines << line;
+      bounds << line.pos << line.pos + line.len;
+    }
+  };
+  int first =
+    treeWidget->topLevelItem(row)->text(0).toULongLong(nullptr, 16) - secAddr;
+  gather(qMax(pos, first));
+
+  int start = oldLines.first().pos, resync{-1};
+  Disassembler dis(obj);
+  Disassembly result;
+  for (int window = end - start + 32;; window *= 2) {
+    int winEnd = qMin(start + window, limit);
+    gather(winEnd);
+    winEnd = qMin(winEnd, limit);
+    int target = qMin(end, limit);
+
+    result = Disassembly();
+    if (!dis.disassemble(sec, start, winEnd - start, result)) {
+      break;
+    }
+    int cur{start};
+    for (int i = 0; i < result.bytesConsumed.size(); i++) {
+      cur += result.bytesConsumed[i];
+      if (cur > limit) break;
+      if (cur >= target && (bounds.contains(cur) || cur == limit)) {
+        resync = cur;
+        while (result.asmLines.size() > i + 1) {
+          result.asmLines.removeLast();
+          result.bytesConsumed.removeLast();
+        }
+        break;
+      }
+    }
+    if (resync != -1 || winEnd >= limit) break;
+  }
+
+  if (resync == -1) {
+    // Show the new bytes and leave the rest to a full update.
+    int last{row};
+    foreach (const auto &line, oldLines) {
+      if (line.pos >= end) break;
+      line.item->setText(1, hexString(data, line.pos, line.len));
+      Util::setTreeItemMarked(line.item, 1);
+      last = treeWidget->indexOfTopLevelItem(line.item);
+    }
+    showUpdateButton();
+    return last + 1;
+  }
+
+  int count{0};
+  while (count < oldLines.size() && oldLines[count].pos < resync) {
+    count++;
+  }
+
+  bool same = (count == result.asmLines.size());
+  for (int i = 0, cur = start; same && i < count; i++) {
+    same = (oldLines[i].pos == cur);
+    cur += result.bytesConsumed[i];
+  }
+
+  if (!same) {
+    for (int i = 0; i < count; i++) {
+      delete oldLines[i].item;
+    }
+  }
+
+  auto selLoads = selectorLoads(obj->getObjcIndex(), result);
+  QString lastSel;
+  for (int i = 0, cur = start; i < result.asmLines.size(); i++) {
+    int len = result.bytesConsumed[i];
+    quint64 addr = secAddr + cur;
+    QTreeWidgetItem *item;
+    if (same) {
+      item = oldLines[i].item;
+      row = treeWidget->indexOfTopLevelItem(item) + 1;
+    }
+    else {
+      // Keep function headers before the instructions they name.
+      item = new QTreeWidgetItem;
+      rows = treeWidget->topLevelItemCount();
+      while (row < rows && rowAddress(treeWidget->topLevelItem(row)) <= addr) {
+        row++;
+      }
+      treeWidget->insertTopLevelItem(row++, item);
+    }
+    setItemLine(item, cur, len,
+                annotateLine(result.asmLines[i], addr, selLoads, lastSel));
+    if (cur < end && cur + len > pos) {
+      Util::setTreeItemMarked(item, 1);
+    }
+    cur += len;
+  }
+
+  if (!same) {
+    showUpdateButton();
+    updateSources();
+  }
+  return row;
+}
+
+void DisassemblyPane::setItemLine(QTreeWidgetItem *item, int pos, int len,
+                                  const QString &line) {
+  const QByteArray &data = sec->getData();
+  quint64 addr = sec->getAddress() + pos;
+  int padSize = obj->getSystemBits() / 8;
+  item->setFlags(Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+  item->setText(0, Util::padString(QString::number(addr, 16).toUpper(),
+                                   padSize));
+  item->setText(1, hexString(data, pos, len));
+  item->setText(2, line);
+
+  int refCnt = xrefs ? xrefs->getCount(addr) : 0;
+  if (refCnt > 0) {
+    item->setText(3, QString::number(refCnt));
+    item->setToolTip(3, Util::referencesString(xrefs->getReferences(addr),
+                                               padSize));
+  }
+  else {
+    item->setText(3, QString());
+    item->setToolTip(3, QString());
+  }
 }
@@ -7,6 +7,7 @@
 #include "Pane.h"
 #include "../Section.h"
 #include "../BinaryObject.h"
+#include "../analysis/XrefIndex.h"
 
 class QLabel;
 class TreeWidget;
@@ -20,20 +21,40 @@ public:
 
   void showUpdateButton();
 
+  bool selectAddress(quint64 addr);
+
 protected:
   void showEvent(QShowEvent *event);
 
 private slots:
   void onUpdateClicked();
+  void onItemDoubleClicked(QTreeWidgetItem *item, int column);
+  void updateSources();
+  void onDataChanged(int pos, int size);
 
 private:
   void createLayout();
   void setup();
+  void invalidateAnalyses();
   void setItemMarked(QTreeWidgetItem *item, int column);
 
+  /**
+   * Decode the code from the instruction row again after the bytes
+   * [pos, end) of the section changed. Returns the row after the rows
+   * that were updated.
+   */
+  int redecode(int row, int pos, int end);
+
+  /**
+   * Show the line decoded from len bytes at pos of the section in the item.
+   */
+  void setItemLine(QTreeWidgetItem *item, int pos, int len, const QString &line);
+
   BinaryObjectPtr obj;
   SectionPtr sec;
-  QDateTime secModified;
+  QDateTime secDiffed;
+  DwarfLineTablePtr lines;
+  XrefIndexPtr xrefs;
 
   bool shown;
   QLabel *label;
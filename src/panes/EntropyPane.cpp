@@ -0,0 +1,177 @@
+#include <QLabel>
+#include <QPainter>
+#include <QComboBox>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QApplication>
+#include <QProgressDialog>
+
+#include "../Util.h"
+#include "EntropyPane.h"
+#include "../MappedFile.h"
+#include "../AddressSpace.h"
+#include "../widgets/EntropyView.h"
+
+/**
+ * Bars of the counts of each byte value of a block.
+ */
+class HistogramView : public QWidget {
+public:
+  HistogramView() {
+    setFixedHeight(80);
+  }
+
+  void setData(const char *data, quint32 len) {
+    EntropyMap::histogram(data, len, counts);
+    max = 0;
+    for (int c = 0; c < 256; c++) {
+      max = qMax(max, counts[c]);
+    }
+    update();
+  }
+
+  void clear() {
+    max = 0;
+    update();
+  }
+
+protected:
+  void paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+    if (max == 0) return;
+
+    int w = width(), h = height();
+    for (int c = 0; c < 256; c++) {
+      int x = c * w / 256, barWidth = qMax(1, (c + 1) * w / 256 - x);
+      int barHeight = (quint64) counts[c] * (h - 1) / max;
+      QColor color = (c == 0 ? Qt::black : c >= 0x80 ? Qt::red :
+                      c >= 0x20 && c < 0x7F ? Qt::darkGreen : Qt::blue);
+      painter.fillRect(x, h - barHeight, barWidth, barHeight, color);
+    }
+  }
+
+private:
+  quint32 counts[256];
+  quint32 max{0};
+};
+
+EntropyPane::EntropyPane(const QString &file, BinaryObjectPtr obj)
+  : Pane(Kind::Entropy), file{file}, obj{obj}, data{nullptr}, shown{false}
+{
+  createLayout();
+}
+
+void EntropyPane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+}
+
+void EntropyPane::onModeChanged(int idx) {
+  view->setMode(idx == 0 ? EntropyView::Mode::Entropy
+                : EntropyView::Mode::Classes);
+}
+
+void EntropyPane::onBlockClicked(int idx) {
+  quint64 pos = (quint64) idx * map->getBlockSize();
+  histView->setData((const char*) data + pos, map->getBlockLength(idx));
+  infoLabel->setText(blockString(idx));
+
+  quint64 addr;
+  if (Util::fileOffsetToAddress(obj, obj->getFileOffset() + pos, addr)) {
+    emit navigate(addr);
+  }
+}
+
+void EntropyPane::onBlockHovered(int idx) {
+  if (idx == -1) {
+    idx = view->getSelected();
+  }
+  infoLabel->setText(idx == -1 ? QString() : blockString(idx));
+}
+
+void EntropyPane::createLayout() {
+  label = new QLabel;
+
+  modeBox = new QComboBox;
+  modeBox->addItem(tr("Entropy"));
+  modeBox->addItem(tr("Byte classes"));
+  connect(modeBox, SIGNAL(currentIndexChanged(int)),
+          this, SLOT(onModeChanged(int)));
+
+  auto *topLayout = new QHBoxLayout;
+  topLayout->addWidget(label);
+  topLayout->addStretch();
+  topLayout->addWidget(new QLabel(tr("Show:")));
+  topLayout->addWidget(modeBox);
+
+  view = new EntropyView;
+  connect(view, &EntropyView::blockClicked, this, &EntropyPane::onBlockClicked);
+  connect(view, &EntropyView::blockHovered, this, &EntropyPane::onBlockHovered);
+
+  infoLabel = new QLabel;
+  histView = new HistogramView;
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addLayout(topLayout);
+  layout->addWidget(view, 1);
+  layout->addWidget(infoLabel);
+  layout->addWidget(histView);
+
+  setLayout(layout);
+}
+
+void EntropyPane::setup() {
+  auto space = obj->getAddressSpace();
+  mapped = (space ? space->getFile() : MappedFile::open(file));
+  if (!mapped) {
+    label->setText(tr("Could not map file!"));
+    return;
+  }
+  quint64 offset = obj->getFileOffset(),
+    size = (obj->getFileSize() > 0 ? obj->getFileSize()
+            : mapped->getSize() - offset);
+  if (!mapped->contains(offset, size)) {
+    label->setText(tr("Object is outside the file!"));
+    return;
+  }
+  data = mapped->getPointer() + offset;
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Computing entropy.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  map = EntropyMap::build(data, size);
+  view->setMap(map);
+  histView->clear();
+  label->setText(tr("%1 in %2 blocks of %3")
+                 .arg(Util::formatSize(size)).arg(map->getBlocks().size())
+                 .arg(Util::formatSize(map->getBlockSize())));
+}
+
+QString EntropyPane::blockString(int idx) const {
+  const auto &block = map->getBlocks()[idx];
+  quint32 len = map->getBlockLength(idx);
+  quint64 offset = obj->getFileOffset() + (quint64) idx * map->getBlockSize();
+  int padSize = obj->getSystemBits() / 8;
+
+  QString str = tr("Offset %1")
+    .arg(Util::padString(QString::number(offset, 16).toUpper(), padSize));
+  quint64 addr;
+  if (Util::fileOffsetToAddress(obj, offset, addr)) {
+    str += tr(", address %1")
+      .arg(Util::padString(QString::number(addr, 16).toUpper(), padSize));
+  }
+  return str + tr(": entropy %1, %2% zero, %3% text, %4% high")
+    .arg(block.entropy, 0, 'f', 2)
+    .arg(block.zeros * 100 / len).arg(block.text * 100 / len)
+    .arg(block.high * 100 / len);
+}
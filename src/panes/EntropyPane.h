@@ -0,0 +1,51 @@
+#ifndef BMOD_ENTROPY_PANE_H
+#define BMOD_ENTROPY_PANE_H
+
+#include "Pane.h"
+#include "../MappedFile.h"
+#include "../BinaryObject.h"
+#include "../analysis/EntropyMap.h"
+
+class QLabel;
+class QComboBox;
+class EntropyView;
+class HistogramView;
+
+/**
+ * Overview of the entropy and byte classes of the bytes of the object in
+ * the file. Clicking a block shows its byte histogram and navigates to
+ * its address.
+ */
+class EntropyPane : public Pane {
+  Q_OBJECT
+
+public:
+  EntropyPane(const QString &file, BinaryObjectPtr obj);
+
+protected:
+  void showEvent(QShowEvent *event);
+
+private slots:
+  void onModeChanged(int idx);
+  void onBlockClicked(int idx);
+  void onBlockHovered(int idx);
+
+private:
+  void createLayout();
+  void setup();
+  QString blockString(int idx) const;
+
+  QString file;
+  BinaryObjectPtr obj;
+  MappedFilePtr mapped; // Keeps data valid.
+  const uchar *data;
+  EntropyMapPtr map;
+
+  bool shown;
+  QLabel *label, *infoLabel;
+  QComboBox *modeBox;
+  EntropyView *view;
+  HistogramView *histView;
+};
+
+#endif // BMOD_ENTROPY_PANE_H
@@ -9,8 +9,12 @@ GenericPane::GenericPane(BinaryObjectPtr obj, SectionPtr sec)
   createLayout();
 }
 
+bool GenericPane::selectAddress(quint64 addr) {
+  return codeWidget->selectAddress(addr);
+}
+
 void GenericPane::createLayout() {
-  auto *codeWidget = new MachineCodeWidget(obj, sec);
+  codeWidget = new MachineCodeWidget(obj, sec);
   connect(codeWidget, SIGNAL(modified()), this, SIGNAL(modified()));
 
   auto *layout = new QVBoxLayout;
@@ -5,15 +5,20 @@
 #include "../Section.h"
 #include "../BinaryObject.h"
 
+class MachineCodeWidget;
+
 class GenericPane : public Pane {
 public:
   GenericPane(BinaryObjectPtr obj, SectionPtr sec);
 
+  bool selectAddress(quint64 addr);
+
 private:
   void createLayout();
 
   BinaryObjectPtr obj;
   SectionPtr sec;
+  MachineCodeWidget *codeWidget;
 };
 
 #endif // BMOD_GENERIC_PANE_H
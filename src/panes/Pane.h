@@ -13,18 +13,34 @@ public:
     Disassembly,
     Strings,
     Symbols,
+    CallGraph,
+    CodeSignature,
+    Core,
+    Archive,
+    StringScan,
+    Entropy,
     Generic
   };
 
 signals:
   void modified();
 
+  /**
+   * Request to show the address in the pane that has it.
+   */
+  void navigate(quint64 addr);
+
 protected:
   Pane(Kind kind) : kind{kind} { }  
 
 public:
   Kind getKind() const { return kind; }
 
+  /**
+   * Select the address if the pane shows it.
+   */
+  virtual bool selectAddress(quint64 addr) { Q_UNUSED(addr); return false; }
+
 private:
   Kind kind;
 };
@@ -0,0 +1,352 @@
+#include <QLabel>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QApplication>
+#include <QProgressDialog>
+#include <QAbstractTableModel>
+
+#include <algorithm>
+
+#include "../Util.h"
+#include "StringScanPane.h"
+#include "../MappedFile.h"
+#include "../AddressSpace.h"
+#include "../StringScanner.h"
+
+namespace {
+  // Longest text shown in a row.
+  const int MAX_DISPLAY{512};
+}
+
+class StringScanModel : public QAbstractTableModel {
+public:
+  struct Region {
+    const uchar *ptr; // Into data or the mapped file.
+    quint64 size;
+    QByteArray data;
+    MappedFilePtr file; // Keeps mapped data valid.
+    quint64 offset; // File offset of the data.
+    quint64 addr;
+    bool hasAddr; // Otherwise addresses are found by file offset.
+    QString name;
+  };
+
+  struct Row {
+    StringScanner::Match match;
+    int region;
+  };
+
+  StringScanModel(BinaryObjectPtr obj, QObject *parent = nullptr)
+    : QAbstractTableModel(parent), obj{obj}
+  {
+    padSize = obj->getSystemBits() / 8;
+
+    // File ranges of sections first, and segments for the parts in
+    // between like load commands.
+    foreach (const auto sec, obj->getSections()) {
+      if (sec->getType() == SectionType::Memory || sec->getOffset() == 0 ||
+          sec->getSize() == 0) {
+        continue;
+      }
+      secAreas << Area{sec->getOffset(), sec->getSize(), sec->getAddress(),
+          sec->getName()};
+    }
+    auto space = obj->getAddressSpace();
+    if (space) {
+      foreach (const auto &mapping, space->getMappings()) {
+        if (mapping.fileSize > 0) {
+          segAreas << Area{mapping.offset, mapping.fileSize, mapping.addr,
+              mapping.name};
+        }
+      }
+    }
+    auto lessThan = [](const Area &a, const Area &b) {
+      return a.offset < b.offset;
+    };
+    std::sort(secAreas.begin(), secAreas.end(), lessThan);
+    std::sort(segAreas.begin(), segAreas.end(), lessThan);
+  }
+
+  void setResults(const QVector<Region> &regions, const QVector<Row> &rows) {
+    beginResetModel();
+    this->regions = regions;
+    this->rows = rows;
+    endResetModel();
+  }
+
+  bool getAddress(int row, quint64 &addr, QString *name = nullptr) const {
+    if (row < 0 || row >= rows.size()) {
+      return false;
+    }
+    const auto &res = rows[row];
+    const auto &region = regions[res.region];
+    if (region.hasAddr) {
+      addr = region.addr + res.match.offset;
+      if (name) *name = region.name;
+      return true;
+    }
+
+    quint64 offset = region.offset + res.match.offset;
+    return findArea(secAreas, offset, addr, name) ||
+      findArea(segAreas, offset, addr, name);
+  }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const {
+    return parent.isValid() ? 0 : rows.size();
+  }
+
+  int columnCount(const QModelIndex &parent = QModelIndex()) const {
+    Q_UNUSED(parent);
+    return 6;
+  }
+
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+      return QVariant();
+    }
+    switch (section) {
+    case 0: return QObject::tr("Offset");
+    case 1: return QObject::tr("Address");
+    case 2: return QObject::tr("Section");
+    case 3: return QObject::tr("Type");
+    case 4: return QObject::tr("Length");
+    case 5: return QObject::tr("String");
+    }
+    return QVariant();
+  }
+
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const {
+    if (!index.isValid() || role != Qt::DisplayRole ||
+        index.row() >= rows.size()) {
+      return QVariant();
+    }
+
+    // Rows are only formatted when shown.
+    const auto &res = rows[index.row()];
+    const auto &region = regions[res.region];
+    switch (index.column()) {
+    case 0:
+      return Util::padString(QString::number(region.offset + res.match.offset,
+                                             16).toUpper(), padSize);
+
+    case 1: {
+      quint64 addr;
+      if (getAddress(index.row(), addr)) {
+        return Util::padString(QString::number(addr, 16).toUpper(), padSize);
+      }
+      break;
+    }
+
+    case 2: {
+      quint64 addr;
+      QString name;
+      if (getAddress(index.row(), addr, &name)) {
+        return name;
+      }
+      break;
+    }
+
+    case 3:
+      switch (res.match.encoding) {
+      case StringScanner::Encoding::Ascii: return QString("ASCII");
+      case StringScanner::Encoding::Utf8: return QString("UTF-8");
+      case StringScanner::Encoding::Utf16: return QString("UTF-16");
+      }
+      break;
+
+    case 4:
+      return StringScanner::decode(region.ptr, region.size, res.match).size();
+
+    case 5: {
+      QString str = StringScanner::decode(region.ptr, region.size, res.match);
+      if (str.size() > MAX_DISPLAY) {
+        str = str.left(MAX_DISPLAY) + "...";
+      }
+      return str.replace("\n", "\\n").replace("\t", "\\t").replace("\r", "\\r");
+    }
+    }
+    return QVariant();
+  }
+
+private:
+  struct Area {
+    quint64 offset, size, addr;
+    QString name;
+  };
+
+  static bool findArea(const QVector<Area> &areas, quint64 offset,
+                       quint64 &addr, QString *name) {
+    auto it = std::upper_bound(areas.constBegin(), areas.constEnd(), offset,
+                               [](quint64 offset, const Area &area) {
+                                 return offset < area.offset;
+                               });
+    if (it == areas.constBegin()) {
+      return false;
+    }
+    --it;
+    if (offset - it->offset >= it->size) {
+      return false;
+    }
+    addr = it->addr + (offset - it->offset);
+    if (name) *name = it->name;
+    return true;
+  }
+
+  BinaryObjectPtr obj;
+  int padSize;
+  QVector<Area> secAreas, segAreas; // Sorted by file offset.
+  QVector<Region> regions;
+  QVector<Row> rows;
+};
+
+StringScanPane::StringScanPane(const QString &file, BinaryObjectPtr obj)
+  : Pane(Kind::StringScan), file{file}, obj{obj}, shown{false}
+{
+  createLayout();
+}
+
+void StringScanPane::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (!shown) {
+    shown = true;
+    scan();
+  }
+}
+
+void StringScanPane::scan() {
+  typedef StringScanModel::Region Region;
+  typedef StringScanModel::Row Row;
+
+  QVector<Region> regions;
+  if (sourceBox->currentIndex() == 0) {
+    // The bytes of the object as they are in the file, including those
+    // not in any section.
+    auto space = obj->getAddressSpace();
+    auto mapped = (space ? space->getFile() : MappedFile::open(file));
+    if (!mapped) {
+      label->setText(tr("Could not map file!"));
+      return;
+    }
+    quint64 offset = obj->getFileOffset(),
+      size = (obj->getFileSize() > 0 ? obj->getFileSize()
+              : mapped->getSize() - offset);
+    if (!mapped->contains(offset, size)) {
+      label->setText(tr("Object is outside the file!"));
+      return;
+    }
+    // Mapped directly since whole files can exceed a QByteArray.
+    Region region;
+    region.ptr = mapped->getPointer() + offset;
+    region.size = size;
+    region.file = mapped;
+    region.offset = offset;
+    region.addr = 0;
+    region.hasAddr = false;
+    regions << region;
+  }
+  else {
+    // Section data includes unsaved modifications.
+    foreach (const auto sec, obj->getSections()) {
+      if (sec->getType() == SectionType::Memory) continue;
+      Region region;
+      auto snap = sec->getSnapshot();
+      region.data = snap.data;
+      region.ptr = (const uchar*) region.data.constData();
+      region.size = region.data.size();
+      region.file = snap.file;
+      region.offset = sec->getOffset();
+      region.addr = sec->getAddress();
+      region.hasAddr = true;
+      region.name = sec->getName();
+      regions << region;
+    }
+  }
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Scanning for strings.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, regions.size());
+  progDiag.show();
+  qApp->processEvents();
+
+  StringScanner scanner(minLenSpin->value(), utf16Check->isChecked());
+  QVector<Row> rows;
+  quint64 bytes{0};
+  for (int i = 0; i < regions.size(); i++) {
+    const auto &region = regions[i];
+    foreach (const auto &match, scanner.scan(region.ptr, region.size)) {
+      rows << Row{match, i};
+    }
+    bytes += region.size;
+    progDiag.setValue(i + 1);
+    qApp->processEvents();
+  }
+
+  model->setResults(regions, rows);
+  label->setText(tr("%1 strings in %2").arg(rows.size())
+                 .arg(Util::formatSize(bytes)));
+}
+
+void StringScanPane::onActivated(const QModelIndex &index) {
+  quint64 addr;
+  if (model->getAddress(index.row(), addr)) {
+    emit navigate(addr);
+  }
+}
+
+void StringScanPane::createLayout() {
+  label = new QLabel;
+
+  sourceBox = new QComboBox;
+  sourceBox->addItem(tr("Whole file"));
+  sourceBox->addItem(tr("All sections"));
+
+  minLenSpin = new QSpinBox;
+  minLenSpin->setRange(2, 256);
+  minLenSpin->setValue(4);
+
+  utf16Check = new QCheckBox(tr("UTF-16"));
+  utf16Check->setChecked(true);
+
+  auto *scanBtn = new QPushButton(tr("Scan"));
+  connect(scanBtn, &QPushButton::clicked, this, &StringScanPane::scan);
+
+  auto *topLayout = new QHBoxLayout;
+  topLayout->addWidget(label);
+  topLayout->addStretch();
+  topLayout->addWidget(new QLabel(tr("Source:")));
+  topLayout->addWidget(sourceBox);
+  topLayout->addWidget(new QLabel(tr("Min. length:")));
+  topLayout->addWidget(minLenSpin);
+  topLayout->addWidget(utf16Check);
+  topLayout->addWidget(scanBtn);
+
+  model = new StringScanModel(obj, this);
+
+  // Uniform rows let the view skip measuring rows out of sight.
+  treeView = new QTreeView;
+  treeView->setModel(model);
+  treeView->setRootIsDecorated(false);
+  treeView->setUniformRowHeights(true);
+  treeView->setColumnWidth(0, obj->getSystemBits() == 64 ? 110 : 70);
+  treeView->setColumnWidth(1, obj->getSystemBits() == 64 ? 110 : 70);
+  treeView->setColumnWidth(2, 100);
+  treeView->setColumnWidth(3, 60);
+  treeView->setColumnWidth(4, 50);
+  connect(treeView, &QTreeView::activated,
+          this, &StringScanPane::onActivated);
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->addLayout(topLayout);
+  layout->addWidget(treeView);
+
+  setLayout(layout);
+}
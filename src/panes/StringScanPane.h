@@ -0,0 +1,48 @@
+#ifndef BMOD_STRING_SCAN_PANE_H
+#define BMOD_STRING_SCAN_PANE_H
+
+#include <QModelIndex>
+
+#include "Pane.h"
+#include "../BinaryObject.h"
+
+class QLabel;
+class QSpinBox;
+class QComboBox;
+class QTreeView;
+class QCheckBox;
+class StringScanModel;
+
+/**
+ * Strings found anywhere in the file or the sections of an object, shown
+ * in a view that only formats the rows in sight.
+ */
+class StringScanPane : public Pane {
+  Q_OBJECT
+
+public:
+  StringScanPane(const QString &file, BinaryObjectPtr obj);
+
+protected:
+  void showEvent(QShowEvent *event);
+
+private slots:
+  void scan();
+  void onActivated(const QModelIndex &index);
+
+private:
+  void createLayout();
+
+  QString file;
+  BinaryObjectPtr obj;
+
+  bool shown;
+  QLabel *label;
+  QComboBox *sourceBox;
+  QSpinBox *minLenSpin;
+  QCheckBox *utf16Check;
+  QTreeView *treeView;
+  StringScanModel *model;
+};
+
+#endif // BMOD_STRING_SCAN_PANE_H
@@ -9,9 +9,24 @@
 
 #include "../Util.h"
 #include "StringsPane.h"
+#include "../analysis/XrefIndex.h"
 #include "../widgets/TreeWidget.h"
 
 namespace {
+  /**
+   * Section offset of the string in a row.
+   */
+  int rowStart(QTreeWidgetItem *item) {
+    return item->data(0, Qt::UserRole).toInt();
+  }
+
+  /**
+   * Size of the string in a row including its terminator.
+   */
+  int rowSize(QTreeWidgetItem *item) {
+    return item->data(3, Qt::UserRole).toInt();
+  }
+
   class ItemDelegate : public QStyledItemDelegate {
   public:
     ItemDelegate(StringsPane *pane, QTreeWidget *tree, SectionPtr sec)
@@ -52,22 +67,11 @@ namespace {
         if (newStr == oldStr) {
           return;
         }
-        model->setData(index, newStr);
         auto *item = tree->topLevelItem(index.row());
         if (item) {
-          Util::setTreeItemMarked(item, index.column());
-
-          // Update string representation.
-          item->setText(1, Util::hexToString(newStr)
-                        .replace("\n", "\\n")
-                        .replace("\t", "\\t")
-                        .replace("\r", "\\r"));
-
-          // Change region.
-          quint64 addr = item->text(0).toULongLong(nullptr, 16);
-          quint64 pos = addr - sec->getAddress();
+          // The pane updates the affected rows when the section changes.
           QByteArray data = Util::hexToData(newStr);
-          sec->setSubData(data, pos);
+          sec->setSubData(data, rowStart(item));
 
           emit pane->modified();
         }
@@ -85,6 +89,7 @@ StringsPane::StringsPane(BinaryObjectPtr obj, SectionPtr sec)
   : Pane(Kind::Strings), obj{obj}, sec{sec}, shown{false}
 {
   createLayout();
+  connect(sec.get(), &Section::dataChanged, this, &StringsPane::onDataChanged);
 }
 
 void StringsPane::showEvent(QShowEvent *event) {
@@ -93,13 +98,18 @@ void StringsPane::showEvent(QShowEvent *event) {
     shown = true;
     setup();
   }
-  else if (sec->isModified()) {
-    QDateTime mod = sec->modifiedWhen();
-    if (secModified.isNull() || mod != secModified) {
-      secModified = mod;
-      setup();
-    }
+}
+
+bool StringsPane::selectAddress(quint64 addr) {
+  quint64 start = sec->getAddress();
+  if (addr < start || addr >= start + sec->getSize()) {
+    return false;
+  }
+  if (!shown) {
+    shown = true;
+    setup();
   }
+  return treeWidget->selectAddress(addr);
 }
 
 void StringsPane::createLayout() {
@@ -107,11 +117,12 @@ void StringsPane::createLayout() {
 
   treeWidget = new TreeWidget;
   treeWidget->setHeaderLabels(QStringList{tr("Address"), tr("String"),
-        tr("Length"), tr("Data")});
+        tr("Length"), tr("Data"), tr("Xrefs")});
   treeWidget->setColumnWidth(0, obj->getSystemBits() == 64 ? 110 : 70);
   treeWidget->setColumnWidth(1, 200);
   treeWidget->setColumnWidth(2, 50);
   treeWidget->setColumnWidth(3, 200);
+  treeWidget->setColumnWidth(4, 50);
   treeWidget->setItemDelegate(new ItemDelegate(this, treeWidget, sec));
   treeWidget->setAddressColumn(0);
 
@@ -141,30 +152,15 @@ void StringsPane::setup() {
   progDiag.show();
   qApp->processEvents();
 
+  xrefs = obj->getXrefIndex();
+
   QByteArray cur;
   for (int i = 0; i < len; i++) {
     char c = data[i];
     cur += c;
     if (c == 0) {
       auto *item = new QTreeWidgetItem;
-      item->setFlags(Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-      item->setText(0, Util::padString(QString::number(addr, 16).toUpper(),
-                                       obj->getSystemBits() / 8));
-
-      QString str = QString::fromUtf8(cur);
-      str = str.replace("\n", "\\n").replace("\t", "\\t").replace("\r", "\\r");
-
-      item->setText(1, str);
-      item->setText(2, QString::number(str.size()));
-
-      QString dataStr;
-      for (int j = 0; j < cur.size(); j++) {
-        QString hex =
-          Util::padString(QString::number((unsigned char) cur[j], 16), 2);
-        dataStr += hex;
-      }
-      item->setText(3, dataStr.toUpper());
-
+      setItemString(item, addr, cur);
       treeWidget->addTopLevelItem(item);
       addr += cur.size();
       cur.clear();
@@ -186,34 +182,124 @@ void StringsPane::setup() {
   // Mark items as modified if a region states it.
   const auto &modRegs = sec->getModifiedRegions();
   int rows = treeWidget->topLevelItemCount();
-  quint64 offset =
-    treeWidget->topLevelItem(0)->text(0).toULongLong(nullptr, 16);
   for (int row = 0; row < rows; row++) {
     auto *item = treeWidget->topLevelItem(row);
-    addr = item->text(0).toULongLong(nullptr, 16) - offset;
-    int size = item->text(2).toInt() + 1; // account for \0
+    quint64 start = rowStart(item);
+    int size = rowSize(item);
     foreach (const auto &reg, modRegs) {
-      if (reg.first >= addr && reg.first < addr + size) {
+      if (reg.first >= start && reg.first < start + size) {
         Util::setTreeItemMarked(item, 3);
-        int excess = (reg.first + reg.second) - (addr + size);
-        if (excess > 0) {
-          for (int row2 = row + 1; row2 < rows; row2++) {
-            auto *item2 = treeWidget->topLevelItem(row2);
-            if (item2) {
-              int size2 = item2->text(2).toInt() + 1; // account for \0
-              Util::setTreeItemMarked(item2, 3);
-              excess -= size2;
-              if (excess <= 0) break;
-            }
-            else break;
-          }
+        int excess = (reg.first + reg.second) - (start + size);
+        for (int row2 = row + 1; excess > 0 && row2 < rows; row2++) {
+          auto *item2 = treeWidget->topLevelItem(row2);
+          Util::setTreeItemMarked(item2, 3);
+          excess -= rowSize(item2);
         }
       }
     }
   }
 
+  updateLabel();
+  treeWidget->setFocus();
+}
+
+void StringsPane::onDataChanged(int pos, int size) {
+  // Rows are made from the current data once shown.
+  if (!shown || size <= 0) return;
+
+  const QByteArray &data = sec->getData();
+  quint64 secAddr = sec->getAddress();
+  int len = data.size(), end = pos + size;
+
+  // Rows are contiguous strings from the start of the section, so the row
+  // holding the first changed byte is the last one starting at or before
+  // it. Bytes after the last terminator have no row.
+  int rows = treeWidget->topLevelItemCount(), lo{0}, hi{rows};
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (rowStart(treeWidget->topLevelItem(mid)) <= pos) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  int first = qMax(lo - 1, 0), spanStart{0};
+  if (first < rows) {
+    auto *item = treeWidget->topLevelItem(first);
+    spanStart = rowStart(item);
+    if (spanStart + rowSize(item) <= pos) {
+      spanStart += rowSize(item);
+      first++;
+    }
+  }
+
+  // Find the old end of the row holding the last changed byte.
+  int last{first}, oldEnd{end - 1};
+  while (last < rows) {
+    auto *item = treeWidget->topLevelItem(last++);
+    int rowEnd = rowStart(item) + rowSize(item);
+    if (rowEnd >= end) {
+      oldEnd = rowEnd - 1;
+      break;
+    }
+  }
+
+  // The new span ends at the first string terminator from there, which
+  // is unchanged unless it is inside the changed range.
+  int spanEnd = data.indexOf('\0', qMin(oldEnd, len));
+  if (spanEnd == -1) {
+    spanEnd = len;
+  }
+  for (int row = last; row < rows; row++) {
+    if (rowStart(treeWidget->topLevelItem(row)) > spanEnd) break;
+    last = row + 1;
+  }
+
+  // Update the rows in place when the strings start at the same places,
+  // otherwise replace them.
+  QList<QPair<int, int>> strs;
+  for (int start = spanStart; start < spanEnd + 1 && start < len;) {
+    int nul = data.indexOf('\0', start);
+    if (nul == -1 || nul > spanEnd) break;
+    strs << qMakePair(start, nul + 1 - start);
+    start = nul + 1;
+  }
+
+  bool same = (strs.size() == last - first);
+  for (int i = 0; same && i < strs.size(); i++) {
+    same = (rowStart(treeWidget->topLevelItem(first + i)) == strs[i].first);
+  }
+  if (!same) {
+    for (int row = last - 1; row >= first; row--) {
+      delete treeWidget->takeTopLevelItem(row);
+    }
+  }
+
+  for (int i = 0; i < strs.size(); i++) {
+    const auto &str = strs[i];
+    QTreeWidgetItem *item;
+    if (same) {
+      item = treeWidget->topLevelItem(first + i);
+    }
+    else {
+      item = new QTreeWidgetItem;
+      treeWidget->insertTopLevelItem(first + i, item);
+    }
+    setItemString(item, secAddr + str.first, data.mid(str.first, str.second));
+    if (str.first < end && str.first + str.second > pos) {
+      Util::setTreeItemMarked(item, 3);
+    }
+  }
+
+  if (!same) {
+    updateLabel();
+  }
+}
+
+void StringsPane::updateLabel() {
   int padSize = obj->getSystemBits() / 8;
-  addr = sec->getAddress();
+  quint64 addr = sec->getAddress(), len = sec->getSize();
   label->setText(tr("Section size: %1, address %2 to %3, %4 rows")
                  .arg(Util::formatSize(len))
                  .arg(Util::padString(QString::number(addr, 16).toUpper(),
@@ -221,6 +307,39 @@ void StringsPane::setup() {
                  .arg(Util::padString(QString::number(addr + len, 16).toUpper(),
                                       padSize))
                  .arg(treeWidget->topLevelItemCount()));
+}
 
-  treeWidget->setFocus();
+void StringsPane::setItemString(QTreeWidgetItem *item, quint64 addr,
+                                const QByteArray &cur) {
+  int padSize = obj->getSystemBits() / 8;
+  item->setFlags(Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+  item->setText(0, Util::padString(QString::number(addr, 16).toUpper(),
+                                   padSize));
+  item->setData(0, Qt::UserRole, (int) (addr - sec->getAddress()));
+  item->setData(3, Qt::UserRole, cur.size());
+
+  QString str = QString::fromUtf8(cur);
+  str = str.replace("\n", "\\n").replace("\t", "\\t").replace("\r", "\\r");
+
+  item->setText(1, str);
+  item->setText(2, QString::number(str.size()));
+
+  QString dataStr;
+  for (int j = 0; j < cur.size(); j++) {
+    QString hex =
+      Util::padString(QString::number((unsigned char) cur[j], 16), 2);
+    dataStr += hex;
+  }
+  item->setText(3, dataStr.toUpper());
+
+  int refCnt = xrefs ? xrefs->getCount(addr) : 0;
+  if (refCnt > 0) {
+    item->setText(4, QString::number(refCnt));
+    item->setToolTip(4, Util::referencesString(xrefs->getReferences(addr),
+                                               padSize));
+  }
+  else {
+    item->setText(4, QString());
+    item->setToolTip(4, QString());
+  }
 }
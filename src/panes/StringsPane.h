@@ -1,31 +1,44 @@
 #ifndef BMOD_STRINGS_PANE_H
 #define BMOD_STRINGS_PANE_H
 
-#include <QDateTime>
 #include <QTreeWidgetItem>
 
 #include "Pane.h"
 #include "../Section.h"
 #include "../BinaryObject.h"
+#include "../analysis/XrefIndex.h"
 
 class QLabel;
 class TreeWidget;
 
 class StringsPane : public Pane {
+  Q_OBJECT
+
 public:
   StringsPane(BinaryObjectPtr obj, SectionPtr sec);
 
+  bool selectAddress(quint64 addr);
+
 protected:
   void showEvent(QShowEvent *event);
 
+private slots:
+  void onDataChanged(int pos, int size);
+
 private:
   void createLayout();
   void setup();
   void setItemMarked(QTreeWidgetItem *item, int column);
+  void updateLabel();
+
+  /**
+   * Show the NUL-terminated string cur at addr in the item.
+   */
+  void setItemString(QTreeWidgetItem *item, quint64 addr, const QByteArray &cur);
 
   BinaryObjectPtr obj;
   SectionPtr sec;
-  QDateTime secModified;
+  XrefIndexPtr xrefs;
 
   bool shown;
   QLabel *label;
@@ -9,18 +9,81 @@
 
 #include "Util.h"
 #include "BinaryWidget.h"
+#include "../formats/Archive.h"
+#include "../formats/CodeSignature.h"
 
 #include "../panes/Pane.h"
 #include "../panes/ArchPane.h"
+#include "../panes/ArchivePane.h"
 #include "../panes/ProgramPane.h"
 #include "../panes/SymbolsPane.h"
 #include "../panes/StringsPane.h"
+#include "../panes/StringScanPane.h"
+#include "../panes/EntropyPane.h"
 #include "../panes/GenericPane.h"
+#include "../panes/CallGraphPane.h"
+#include "../panes/CodeSignaturePane.h"
+#include "../panes/CorePane.h"
 #include "../panes/DisassemblyPane.h"
 
-BinaryWidget::BinaryWidget(FormatPtr fmt) : fmt{fmt} {
+namespace {
+  /**
+   * The changed ranges within the section relative to it.
+   */
+  IntervalSet sectionChanges(const IntervalSet &changed, SectionPtr sec) {
+    IntervalSet res;
+    quint64 start = sec->getOffset(), end = start + sec->getSize();
+    foreach (const auto &in, changed.getIntervals()) {
+      if (in.second <= start || in.first >= end) continue;
+      quint64 first = qMax(in.first, start), last = qMin(in.second, end);
+      res.add(first - start, last - first);
+    }
+    return res;
+  }
+
+  bool sameLayout(const QList<BinaryObjectPtr> &objs,
+                  const QList<BinaryObjectPtr> &others) {
+    if (objs.size() != others.size()) {
+      return false;
+    }
+    for (int i = 0; i < objs.size(); i++) {
+      auto obj = objs[i], other = others[i];
+      auto secs = obj->getSections(), otherSecs = other->getSections();
+      if (obj->getCpuType() != other->getCpuType() ||
+          obj->getCpuSubType() != other->getCpuSubType() ||
+          obj->getFileOffset() != other->getFileOffset() ||
+          obj->getFileSize() != other->getFileSize() ||
+          secs.size() != otherSecs.size()) {
+        return false;
+      }
+      for (int j = 0; j < secs.size(); j++) {
+        auto sec = secs[j], otherSec = otherSecs[j];
+        if (sec->getType() != otherSec->getType() ||
+            sec->getName() != otherSec->getName() ||
+            sec->getAddress() != otherSec->getAddress() ||
+            sec->getSize() != otherSec->getSize() ||
+            sec->getOffset() != otherSec->getOffset()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  QString conflictString(SectionPtr sec, const QPair<int, int> &region) {
+    return QObject::tr("%1: %2 bytes at %3").arg(sec->getName())
+      .arg(region.second)
+      .arg(QString::number(sec->getAddress() + region.first, 16).toUpper());
+  }
+}
+
+BinaryWidget::BinaryWidget(FormatPtr fmt) : fmt{fmt}, insertRow{-1} {
   createLayout();
   setup();
+
+  if (fmt->isWatched()) {
+    snapshot = FileSnapshot::take(getFile());
+  }
 }
 
 void BinaryWidget::commit() {
@@ -37,20 +100,178 @@ void BinaryWidget::commit() {
   progDiag.show();
   qApp->processEvents();
 
+  bool ok{true};
+  auto writeSection = [this, &f, &ok](SectionPtr sec) {
+    const QByteArray &data = sec->getData();
+    foreach (const auto &region, sec->getModifiedRegions()) {
+      QByteArray sub = data.mid(region.first, region.second);
+      if (!f.seek(sec->getOffset() + region.first) ||
+          f.write(sub) != sub.size()) {
+        ok = false;
+      }
+      written.add(sec->getOffset() + region.first, region.second);
+    }
+  };
+
   foreach (const auto obj, fmt->getObjects()) {
+    IntervalSet dirty;
     foreach (const auto sec, obj->getSections()) {
       if (!sec->isModified()) {
         continue;
       }
-      const QByteArray &data = sec->getData();
+      writeSection(sec);
       foreach (const auto &region, sec->getModifiedRegions()) {
-        f.seek(sec->getOffset() + region.first);
-        f.write(data.mid(region.first, region.second));
+        dirty.add(sec->getOffset() + region.first, region.second);
       }
     }
+
+    // Rehash only the signed pages that were touched so an ad-hoc
+    // signature stays valid.
+    auto sig = CodeSignature::parse(obj->getSection(SectionType::CodeSig));
+    if (!sig || dirty.isEmpty()) {
+      continue;
+    }
+    f.flush();
+    int changed = sig->rehash(f, dirty);
+    if (changed == -1) {
+      QMessageBox::warning(this, "bmod",
+                           tr("Could not update the code signature!"));
+    }
+    else if (changed > 0) {
+      writeSection(sig->getSection());
+    }
+  }
+
+  if (!ok) {
+    QMessageBox::critical(this, "bmod", tr("Could not write all changes!"));
+    return;
+  }
+
+  // The file holds the edits now so they are not carried over on reload.
+  foreach (const auto obj, fmt->getObjects()) {
+    foreach (const auto sec, obj->getSections()) {
+      sec->setCommitted();
+    }
+  }
+
+  // Our own writes are not changes to reload.
+  if (snapshot) {
+    f.close();
+    snapshot = FileSnapshot::take(getFile());
   }
 }
 
+BinaryWidget::Reload BinaryWidget::reload(QStringList &conflicts) {
+  if (!snapshot) {
+    return Reload::Failed;
+  }
+  auto snap = FileSnapshot::take(getFile());
+  if (!snap) {
+    return Reload::Failed;
+  }
+  IntervalSet changed = snap->changedRanges(*snapshot);
+  if (changed.isEmpty()) {
+    return Reload::Unchanged;
+  }
+
+  // The headers are parsed again to know what the changed pages belong
+  // to. Only the changed pages, and those we wrote ourselves, are read
+  // since the rest of the data is taken from the previous copy.
+  auto newFmt = Format::detect(getFile());
+  if (!newFmt) {
+    return Reload::Failed;
+  }
+  IntervalSet reread = changed;
+  foreach (const auto &in, written.getIntervals()) {
+    reread.add(in.first, in.second - in.first);
+  }
+  newFmt->setWatched(true);
+  newFmt->setPrevious(fmt, reread);
+  if (!newFmt->parse()) {
+    return Reload::Failed;
+  }
+  snapshot = snap;
+  written.clear();
+
+  auto objs = fmt->getObjects(), newObjs = newFmt->getObjects();
+  if (!sameLayout(objs, newObjs)) {
+    // Carry the edits over to the sections that still exist.
+    for (int i = 0; i < objs.size(); i++) {
+      foreach (auto sec, objs[i]->getSections()) {
+        if (!sec->isModified()) continue;
+        SectionPtr newSec;
+        if (i < newObjs.size() &&
+            objs[i]->getCpuType() == newObjs[i]->getCpuType()) {
+          foreach (auto other, newObjs[i]->getSections()) {
+            if (other->getType() == sec->getType() &&
+                other->getName() == sec->getName() &&
+                other->getSize() == sec->getSize()) {
+              newSec = other;
+              break;
+            }
+          }
+        }
+        const QByteArray &local = sec->getData();
+        foreach (const auto &region, sec->getModifiedRegions()) {
+          QByteArray edit = local.mid(region.first, region.second);
+          if (!newSec) {
+            conflicts << conflictString(sec, region) + tr(" (lost)");
+            continue;
+          }
+          if (sectionChanges(changed, newSec).intersects(region.first,
+                                                         region.second) &&
+              newSec->getData().mid(region.first, region.second) != edit) {
+            conflicts << conflictString(newSec, region);
+          }
+          newSec->setSubData(edit, region.first);
+        }
+      }
+    }
+
+    fmt = newFmt;
+    removePanes(0, stackLayout->count());
+    setup();
+    return Reload::Full;
+  }
+
+  for (int i = 0; i < objs.size(); i++) {
+    auto obj = objs[i], newObj = newObjs[i];
+    quint64 size = (obj->getFileSize() > 0 ? obj->getFileSize()
+                    : snap->getSize() - obj->getFileOffset());
+    if (!changed.intersects(obj->getFileOffset(), size)) {
+      continue;
+    }
+
+    // The panes of the object are recreated in place. They are deleted
+    // later since one may be processing events in its setup, so detach
+    // them from the sections lest they update for every changed range.
+    int row = listWidget->currentRow(), begin, end;
+    getObjectPanes(findObjectPane(obj), begin, end);
+    removePanes(begin, end);
+
+    // Unchanged sections are moved to the new copy of the file as well so
+    // the previous one is released.
+    auto secs = obj->getSections(), newSecs = newObj->getSections();
+    for (int j = 0; j < secs.size(); j++) {
+      auto sec = secs[j];
+      disconnect(sec.get(), &Section::dataChanged, nullptr, nullptr);
+      IntervalSet secChanged = sectionChanges(changed, sec);
+      foreach (const auto &region, sec->rebase(newSecs[j], secChanged)) {
+        conflicts << conflictString(sec, region);
+      }
+    }
+    obj->update(newObj);
+
+    insertRow = begin;
+    addObjectPanes(obj);
+    insertRow = -1;
+    if (row != -1 && row < listWidget->count()) {
+      listWidget->setCurrentRow(row);
+    }
+  }
+  return Reload::Partial;
+}
+
 void BinaryWidget::createLayout() {
   listWidget = new QListWidget;
   listWidget->setFixedWidth(175);
@@ -72,58 +293,68 @@ void BinaryWidget::onModeChanged(int row) {
   stackLayout->setCurrentIndex(row);
 }
 
-void BinaryWidget::setup() {
-  foreach (const auto obj, fmt->getObjects()) {
-    auto *archPane = new ArchPane(fmt->getType(), obj);
-    QString cpuStr = Util::cpuTypeString(obj->getCpuType()),
-      cpuSubStr = Util::cpuTypeString(obj->getCpuSubType());
-    addPane(tr("%1 (%2)").arg(cpuStr).arg(cpuSubStr), archPane);
-
-    SectionPtr sec = obj->getSection(SectionType::Text);
-    if (sec) {
-      addPane(tr("Executable Code"), new ProgramPane(obj, sec), 1);
-      addPane(tr("Disassembly"), new DisassemblyPane(obj, sec), 2);
-    }
+void BinaryWidget::onNavigate(quint64 addr) {
+  auto *from = qobject_cast<Pane*>(sender());
+  int idx = stackLayout->indexOf(from);
+  if (idx == -1) return;
+  selectAddress(idx, addr, from);
+}
 
-    sec = obj->getSection(SectionType::SymbolStubs);
-    if (sec) {
-      addPane(sec->getName(), new GenericPane(obj, sec), 1);
-    }
+bool BinaryWidget::selectAddress(BinaryObjectPtr obj, quint64 addr) {
+  int idx = findObjectPane(obj);
+  return idx != -1 && selectAddress(idx, addr);
+}
 
-    sec = obj->getSection(SectionType::Symbols);
-    if (sec) {
-      addPane(sec->getName(),
-              new SymbolsPane(obj, sec, SymbolsPane::Type::Symbols), 1);
-      addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+bool BinaryWidget::selectAddress(int idx, quint64 addr, Pane *skip) {
+  int begin, end;
+  getObjectPanes(idx, begin, end);
+  for (int i = begin; i < end; i++) {
+    auto *pane = static_cast<Pane*>(stackLayout->widget(i));
+    if (pane != skip && pane->selectAddress(addr)) {
+      listWidget->setCurrentRow(i);
+      return true;
     }
+  }
+  return false;
+}
 
-    sec = obj->getSection(SectionType::DynSymbols);
-    if (sec) {
-      addPane(sec->getName(),
-              new SymbolsPane(obj, sec, SymbolsPane::Type::DynSymbols), 1);
-      addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
-    }
+int BinaryWidget::findObjectPane(BinaryObjectPtr obj) const {
+  int num = fmt->getObjects().indexOf(obj);
+  if (num == -1) return -1;
 
-    sec = obj->getSection(SectionType::String);
-    if (sec) {
-      addPane(sec->getName(), new StringsPane(obj, sec), 1);
-      addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+  // The panes of each object start at its architecture pane.
+  for (int i = 0; i < stackLayout->count(); i++) {
+    auto *pane = static_cast<Pane*>(stackLayout->widget(i));
+    if (pane->getKind() == Pane::Kind::Arch && num-- == 0) {
+      return i;
     }
+  }
+  return -1;
+}
 
-    foreach (auto sec, obj->getSectionsByType(SectionType::CString)) {
-      addPane(sec->getName(), new StringsPane(obj, sec), 1);
-      addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
-    }
+void BinaryWidget::getObjectPanes(int idx, int &begin, int &end) const {
+  begin = idx;
+  end = idx + 1;
+  while (begin > 0 &&
+         static_cast<Pane*>(stackLayout->widget(begin))->getKind() !=
+         Pane::Kind::Arch) {
+    begin--;
+  }
+  while (end < stackLayout->count() &&
+         static_cast<Pane*>(stackLayout->widget(end))->getKind() !=
+         Pane::Kind::Arch) {
+    end++;
+  }
+}
 
-    sec = obj->getSection(SectionType::FuncStarts);
-    if (sec) {
-      addPane(sec->getName(), new GenericPane(obj, sec), 1);
-    }
+void BinaryWidget::setup() {
+  auto archive = std::dynamic_pointer_cast<Archive>(fmt);
+  if (archive) {
+    addPane(tr("Archive"), new ArchivePane(archive));
+  }
 
-    sec = obj->getSection(SectionType::CodeSig);
-    if (sec) {
-      addPane(sec->getName(), new GenericPane(obj, sec), 1);
-    }
+  foreach (const auto obj, fmt->getObjects()) {
+    addObjectPanes(obj);
   }
 
   if (listWidget->count() > 0) {
@@ -131,8 +362,88 @@ void BinaryWidget::setup() {
   }
 }
 
+void BinaryWidget::addObjectPanes(BinaryObjectPtr obj) {
+  auto archive = std::dynamic_pointer_cast<Archive>(fmt);
+  auto *archPane = new ArchPane(fmt->getType(), getFile(), obj);
+  QString cpuStr = Util::cpuTypeString(obj->getCpuType()),
+    cpuSubStr = Util::cpuTypeString(obj->getCpuSubType());
+  if (archive) {
+    addPane(tr("%1 (%2)").arg(archive->getMemberName(obj)).arg(cpuStr),
+            archPane);
+  }
+  else {
+    addPane(tr("%1 (%2)").arg(cpuStr).arg(cpuSubStr), archPane);
+  }
+
+  if (obj->getFileType() == FileType::Core && obj->getAddressSpace()) {
+    addPane(tr("Core Dump"), new CorePane(obj), 1);
+  }
+
+  SectionPtr sec = obj->getSection(SectionType::Text);
+  if (sec) {
+    addPane(tr("Executable Code"), new ProgramPane(obj, sec), 1);
+    addPane(tr("Disassembly"), new DisassemblyPane(obj, sec), 2);
+    addPane(tr("Call Graph"), new CallGraphPane(obj), 2);
+  }
+
+  sec = obj->getSection(SectionType::SymbolStubs);
+  if (sec) {
+    addPane(sec->getName(), new GenericPane(obj, sec), 1);
+  }
+
+  sec = obj->getSection(SectionType::Symbols);
+  if (sec) {
+    addPane(sec->getName(),
+            new SymbolsPane(obj, sec, SymbolsPane::Type::Symbols), 1);
+    addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+  }
+
+  sec = obj->getSection(SectionType::DynSymbols);
+  if (sec) {
+    addPane(sec->getName(),
+            new SymbolsPane(obj, sec, SymbolsPane::Type::DynSymbols), 1);
+    addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+  }
+
+  sec = obj->getSection(SectionType::String);
+  if (sec) {
+    addPane(sec->getName(), new StringsPane(obj, sec), 1);
+    addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+  }
+
+  foreach (auto sec, obj->getSectionsByType(SectionType::CString)) {
+    addPane(sec->getName(), new StringsPane(obj, sec), 1);
+    addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+  }
+
+  addPane(tr("String Scan"), new StringScanPane(getFile(), obj), 1);
+  addPane(tr("Entropy"), new EntropyPane(getFile(), obj), 1);
+
+  sec = obj->getSection(SectionType::FuncStarts);
+  if (sec) {
+    addPane(sec->getName(), new GenericPane(obj, sec), 1);
+  }
+
+  sec = obj->getSection(SectionType::CodeSig);
+  if (sec) {
+    addPane(sec->getName(), new CodeSignaturePane(getFile(), obj, sec), 1);
+    addPane(tr("Raw View"), new GenericPane(obj, sec), 2);
+  }
+}
+
+void BinaryWidget::removePanes(int begin, int end) {
+  for (int i = end - 1; i >= begin; i--) {
+    auto *pane = stackLayout->widget(i);
+    stackLayout->removeWidget(pane);
+    pane->deleteLater();
+    delete listWidget->takeItem(i);
+  }
+}
+
 void BinaryWidget::addPane(const QString &title, Pane *pane, int level) {
-  listWidget->addItem(QString(level * 4, ' ') + title);
-  stackLayout->addWidget(pane);
+  int row = (insertRow == -1 ? listWidget->count() : insertRow++);
+  listWidget->insertItem(row, QString(level * 4, ' ') + title);
+  stackLayout->insertWidget(row, pane);
   connect(pane, SIGNAL(modified()), this, SIGNAL(modified()));
+  connect(pane, &Pane::navigate, this, &BinaryWidget::onNavigate);
 }
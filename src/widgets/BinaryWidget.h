@@ -3,9 +3,11 @@
 
 #include <QWidget>
 
+#include "../FileSnapshot.h"
 #include "../formats/Format.h"
 
 class Pane;
+class QStringList;
 class QListWidget;
 class QStackedLayout;
 
@@ -13,24 +15,68 @@ class BinaryWidget : public QWidget {
   Q_OBJECT
 
 public:
+  enum class Reload {
+    Unchanged,
+    Partial, // Objects with changed bytes were updated in place.
+    Full, // The layout changed so everything was parsed again.
+    Failed
+  };
+
   BinaryWidget(FormatPtr fmt);
 
   QString getFile() const { return fmt->getFile(); }
+  FormatPtr getFormat() const { return fmt; }
 
   void commit();
 
+  /**
+   * Bring the binary up to date after the file changed on disk. Only the
+   * sections with changed pages take the new data, and only the analyses
+   * and panes of objects with changed pages are redone. Local edits are
+   * kept on top, and those that the file changed too are described in
+   * conflicts.
+   */
+  Reload reload(QStringList &conflicts);
+
+  /**
+   * Shows the first pane of the object that can select the address.
+   */
+  bool selectAddress(BinaryObjectPtr obj, quint64 addr);
+
 signals:
   void modified();
 
 private slots:
   void onModeChanged(int row);
+  void onNavigate(quint64 addr);
 
 private:
   void createLayout();
   void setup();
+  void addObjectPanes(BinaryObjectPtr obj);
+  void removePanes(int begin, int end);
   void addPane(const QString &title, Pane *pane, int level = 0);
+
+  /**
+   * Selects the address in the first pane of the object of the pane at
+   * idx, not counting skip.
+   */
+  bool selectAddress(int idx, quint64 addr, Pane *skip = nullptr);
+
+  /**
+   * Index of the architecture pane of the object, or -1.
+   */
+  int findObjectPane(BinaryObjectPtr obj) const;
+
+  /**
+   * Range of the panes of the object of the pane at idx.
+   */
+  void getObjectPanes(int idx, int &begin, int &end) const;
   
   FormatPtr fmt;
+  FileSnapshotPtr snapshot;
+  IntervalSet written; // Committed since the file was last read.
+  int insertRow;
 
   QListWidget *listWidget;
   QStackedLayout *stackLayout;
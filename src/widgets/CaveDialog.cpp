@@ -0,0 +1,129 @@
+#include <QLabel>
+#include <QFileInfo>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+#include "../Util.h"
+#include "TreeWidget.h"
+#include "CaveDialog.h"
+#include "BinaryWidget.h"
+
+namespace {
+  QString kindString(CaveFinder::Kind kind) {
+    switch (kind) {
+    case CaveFinder::Kind::Zeros:
+      return QObject::tr("Zeros");
+
+    case CaveFinder::Kind::Int3:
+      return QObject::tr("INT3");
+
+    case CaveFinder::Kind::Nops:
+      return QObject::tr("NOPs");
+
+    case CaveFinder::Kind::Slack:
+      return QObject::tr("Segment slack");
+    }
+    return QString();
+  }
+}
+
+CaveDialog::CaveDialog(BinaryWidget *binary,
+                       const QVector<CaveFinder::Cave> &caves, QWidget *parent)
+  : QDialog{parent}, binary{binary}, caves{caves}
+{
+  setWindowTitle(tr("Code Caves of %1")
+                 .arg(QFileInfo(binary->getFile()).fileName()));
+  createLayout();
+  resize(700, 400);
+  Util::centerWidget(this);
+}
+
+void CaveDialog::onItemDoubleClicked(QTreeWidgetItem *item, int column) {
+  Q_UNUSED(column);
+  emit caveActivated(item->data(0, Qt::UserRole).toInt());
+}
+
+void CaveDialog::onFillNops() {
+  int idx = selectedCave();
+  if (idx != -1) {
+    emit fillRequested(idx, 0x90);
+  }
+}
+
+void CaveDialog::onFillInt3() {
+  int idx = selectedCave();
+  if (idx != -1) {
+    emit fillRequested(idx, 0xCC);
+  }
+}
+
+void CaveDialog::createLayout() {
+  int padSize{8};
+  quint64 total{0};
+  foreach (const auto &cave, caves) {
+    total += cave.size;
+    if (cave.obj->getSystemBits() == 32) {
+      padSize = 4;
+    }
+  }
+  bool multiple = (binary->getFormat()->getObjects().size() > 1);
+
+  treeWidget = new TreeWidget;
+  treeWidget->setHeaderLabels(QStringList{tr("Size"), tr("Address"),
+        tr("Offset"), tr("Kind"), tr("Section"), tr("Architecture")});
+  treeWidget->setColumnWidth(0, 80);
+  treeWidget->setColumnWidth(1, padSize == 8 ? 110 : 70);
+  treeWidget->setColumnWidth(2, padSize == 8 ? 110 : 70);
+  treeWidget->setColumnWidth(3, 100);
+  treeWidget->setColumnWidth(4, 150);
+  treeWidget->setColumnHidden(5, !multiple);
+  treeWidget->setAddressColumn(1);
+  connect(treeWidget, &QTreeWidget::itemDoubleClicked,
+          this, &CaveDialog::onItemDoubleClicked);
+
+  for (int i = 0; i < caves.size(); i++) {
+    const auto &cave = caves[i];
+    auto *item = new QTreeWidgetItem;
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setData(0, Qt::UserRole, i);
+    item->setText(0, QString::number(cave.size));
+    item->setText(1, Util::padString(QString::number(cave.addr, 16).toUpper(),
+                                     padSize));
+    item->setText(2, Util::padString(QString::number(cave.offset, 16).toUpper(),
+                                     padSize));
+    item->setText(3, kindString(cave.kind));
+    item->setText(4, cave.where);
+    item->setText(5, Util::cpuTypeString(cave.obj->getCpuType()));
+    treeWidget->addTopLevelItem(item);
+  }
+
+  auto *fillNops = new QPushButton(tr("Fill with NOPs"));
+  connect(fillNops, &QPushButton::clicked, this, &CaveDialog::onFillNops);
+
+  auto *fillInt3 = new QPushButton(tr("Fill with INT3"));
+  connect(fillInt3, &QPushButton::clicked, this, &CaveDialog::onFillInt3);
+
+  auto *buttonLayout = new QHBoxLayout;
+  buttonLayout->addWidget(new QLabel(tr("%1 caves, %2 in total")
+                                     .arg(caves.size())
+                                     .arg(Util::formatSize(total))));
+  buttonLayout->addStretch();
+  buttonLayout->addWidget(fillNops);
+  buttonLayout->addWidget(fillInt3);
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(treeWidget);
+  layout->addLayout(buttonLayout);
+
+  setLayout(layout);
+}
+
+int CaveDialog::selectedCave() const {
+  auto *item = treeWidget->currentItem();
+  if (!item) {
+    return -1;
+  }
+  return item->data(0, Qt::UserRole).toInt();
+}
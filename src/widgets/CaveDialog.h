@@ -0,0 +1,49 @@
+#ifndef BMOD_CAVE_DIALOG_H
+#define BMOD_CAVE_DIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+#include "../analysis/CaveFinder.h"
+
+class TreeWidget;
+class BinaryWidget;
+class QTreeWidgetItem;
+
+/**
+ * Lists the code caves of a binary. Activating a cave navigates to it
+ * and the fill buttons request overwriting the selected cave.
+ */
+class CaveDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  CaveDialog(BinaryWidget *binary, const QVector<CaveFinder::Cave> &caves,
+             QWidget *parent = nullptr);
+
+  BinaryWidget *getBinary() const { return binary; }
+  const QVector<CaveFinder::Cave> &getCaves() const { return caves; }
+
+signals:
+  void caveActivated(int idx);
+
+  /**
+   * Fill the cave with the byte value.
+   */
+  void fillRequested(int idx, int byte);
+
+private slots:
+  void onItemDoubleClicked(QTreeWidgetItem *item, int column);
+  void onFillNops();
+  void onFillInt3();
+
+private:
+  void createLayout();
+  int selectedCave() const;
+
+  BinaryWidget *binary;
+  QVector<CaveFinder::Cave> caves;
+  TreeWidget *treeWidget;
+};
+
+#endif // BMOD_CAVE_DIALOG_H
@@ -0,0 +1,109 @@
+#include <QPainter>
+#include <QMouseEvent>
+
+#include "EntropyView.h"
+
+namespace {
+  const int COLUMNS{256};
+}
+
+EntropyView::EntropyView(QWidget *parent)
+  : QWidget(parent), mode{Mode::Entropy}, rows{0}, selected{-1}
+{
+  setMouseTracking(true);
+  setMinimumHeight(64);
+}
+
+void EntropyView::setMap(EntropyMapPtr map) {
+  this->map = map;
+  selected = -1;
+  render();
+}
+
+void EntropyView::setMode(Mode mode) {
+  this->mode = mode;
+  render();
+}
+
+void EntropyView::setSelected(int idx) {
+  selected = idx;
+  update();
+}
+
+void EntropyView::paintEvent(QPaintEvent *event) {
+  Q_UNUSED(event);
+  QPainter painter(this);
+  painter.fillRect(rect(), Qt::white);
+  if (image.isNull()) return;
+
+  painter.drawImage(rect(), image);
+  if (selected != -1) {
+    painter.setPen(Qt::white);
+    painter.drawRect(cellRect(selected).adjusted(-1, -1, 0, 0));
+  }
+}
+
+void EntropyView::mousePressEvent(QMouseEvent *event) {
+  int idx = blockAt(event->pos());
+  if (idx != -1) {
+    setSelected(idx);
+    emit blockClicked(idx);
+  }
+}
+
+void EntropyView::mouseMoveEvent(QMouseEvent *event) {
+  emit blockHovered(blockAt(event->pos()));
+}
+
+void EntropyView::render() {
+  image = QImage();
+  rows = 0;
+  if (map) {
+    const auto &blocks = map->getBlocks();
+    int count = blocks.size();
+    rows = (count + COLUMNS - 1) / COLUMNS;
+    if (rows > 0) {
+      image = QImage(COLUMNS, rows, QImage::Format_RGB32);
+      image.fill(Qt::white);
+      for (int i = 0; i < count; i++) {
+        const auto &block = blocks[i];
+        quint32 len = map->getBlockLength(i);
+        QColor color;
+        if (block.zeros == len) {
+          color = Qt::black;
+        }
+        else if (mode == Mode::Entropy) {
+          color = QColor::fromHsv(240 - int(block.entropy / 8.0 * 240.0), 255,
+                                  255);
+        }
+        else {
+          quint32 other = len - block.text - block.high - block.zeros;
+          color = QColor(block.high * 255 / len, block.text * 255 / len,
+                         other * 255 / len);
+        }
+        image.setPixel(i % COLUMNS, i / COLUMNS, color.rgb());
+      }
+    }
+  }
+  update();
+}
+
+int EntropyView::blockAt(const QPoint &pos) const {
+  if (!map || rows == 0 || width() == 0 || height() == 0) {
+    return -1;
+  }
+  int col = pos.x() * COLUMNS / width(), row = pos.y() * rows / height();
+  int idx = row * COLUMNS + col;
+  if (col < 0 || col >= COLUMNS || row < 0 || row >= rows ||
+      idx >= map->getBlocks().size()) {
+    return -1;
+  }
+  return idx;
+}
+
+QRect EntropyView::cellRect(int idx) const {
+  int col = idx % COLUMNS, row = idx / COLUMNS;
+  int x = col * width() / COLUMNS, y = row * height() / rows;
+  return QRect(x, y, (col + 1) * width() / COLUMNS - x,
+               (row + 1) * height() / rows - y);
+}
@@ -0,0 +1,51 @@
+#ifndef BMOD_ENTROPY_VIEW_H
+#define BMOD_ENTROPY_VIEW_H
+
+#include <QImage>
+#include <QWidget>
+
+#include "../analysis/EntropyMap.h"
+
+/**
+ * Grid of the blocks of an entropy map, one cell per block in rows from
+ * the top left. The cells are drawn once into an image that is scaled
+ * to the widget, so painting does not depend on the size of the data.
+ */
+class EntropyView : public QWidget {
+  Q_OBJECT
+
+public:
+  enum class Mode {
+    Entropy, // Blue for low to red for high entropy, black if all zeros.
+    Classes // Red for high bytes, green for text, blue for the rest.
+  };
+
+  EntropyView(QWidget *parent = nullptr);
+
+  void setMap(EntropyMapPtr map);
+  void setMode(Mode mode);
+
+  int getSelected() const { return selected; }
+  void setSelected(int idx);
+
+signals:
+  void blockClicked(int idx);
+  void blockHovered(int idx);
+
+protected:
+  void paintEvent(QPaintEvent *event);
+  void mousePressEvent(QMouseEvent *event);
+  void mouseMoveEvent(QMouseEvent *event);
+
+private:
+  void render();
+  int blockAt(const QPoint &pos) const;
+  QRect cellRect(int idx) const;
+
+  EntropyMapPtr map;
+  Mode mode;
+  QImage image;
+  int rows, selected;
+};
+
+#endif // BMOD_ENTROPY_VIEW_H
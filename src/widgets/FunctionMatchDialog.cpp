@@ -0,0 +1,48 @@
+#include <QLabel>
+#include <QVBoxLayout>
+
+#include "../Util.h"
+#include "TreeWidget.h"
+#include "FunctionMatchDialog.h"
+
+FunctionMatchDialog::FunctionMatchDialog(const QList<SimilarityIndex::Match> &matches,
+                                         int padSize, QWidget *parent)
+  : QDialog{parent}
+{
+  setWindowTitle(tr("Function Matches"));
+  createLayout(matches, padSize);
+  resize(700, 400);
+  Util::centerWidget(this);
+}
+
+void FunctionMatchDialog::createLayout(const QList<SimilarityIndex::Match> &matches,
+                                       int padSize) {
+  auto *treeWidget = new TreeWidget;
+  treeWidget->setHeaderLabels(QStringList{tr("Address"), tr("Function"),
+        tr("Match"), tr("Matched function"), tr("Similarity")});
+  treeWidget->setColumnWidth(0, padSize == 8 ? 110 : 70);
+  treeWidget->setColumnWidth(1, 200);
+  treeWidget->setColumnWidth(2, padSize == 8 ? 110 : 70);
+  treeWidget->setColumnWidth(3, 200);
+  treeWidget->setAddressColumn(0);
+
+  foreach (const auto &match, matches) {
+    auto *item = new QTreeWidgetItem;
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setText(0, Util::padString(QString::number(match.addr, 16).toUpper(),
+                                     padSize));
+    item->setText(1, match.name);
+    item->setText(2, Util::padString(QString::number(match.other, 16).toUpper(),
+                                     padSize));
+    item->setText(3, match.otherName);
+    item->setText(4, QString("%1%").arg(qRound(match.similarity * 100)));
+    treeWidget->addTopLevelItem(item);
+  }
+
+  auto *layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(new QLabel(tr("%1 functions matched").arg(matches.size())));
+  layout->addWidget(treeWidget);
+
+  setLayout(layout);
+}
@@ -0,0 +1,18 @@
+#ifndef BMOD_FUNCTION_MATCH_DIALOG_H
+#define BMOD_FUNCTION_MATCH_DIALOG_H
+
+#include <QDialog>
+
+#include "../analysis/SimilarityIndex.h"
+
+class FunctionMatchDialog : public QDialog {
+public:
+  FunctionMatchDialog(const QList<SimilarityIndex::Match> &matches,
+                      int padSize, QWidget *parent = nullptr);
+
+private:
+  void createLayout(const QList<SimilarityIndex::Match> &matches,
+                    int padSize);
+};
+
+#endif // BMOD_FUNCTION_MATCH_DIALOG_H
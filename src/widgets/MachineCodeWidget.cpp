@@ -94,6 +94,8 @@ MachineCodeWidget::MachineCodeWidget(BinaryObjectPtr obj, SectionPtr sec)
 {
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
   createLayout();
+  connect(sec.get(), &Section::dataChanged,
+          this, &MachineCodeWidget::onDataChanged);
 }
 
 void MachineCodeWidget::showEvent(QShowEvent *event) {
@@ -102,15 +104,44 @@ void MachineCodeWidget::showEvent(QShowEvent *event) {
     shown = true;
     setup();
   }
-  else if (sec->isModified()) {
-    QDateTime mod = sec->modifiedWhen();
-    if (secModified.isNull() || mod != secModified) {
-      secModified = mod;
-      setup();
+  else if (sec->isDiffed() && sec->diffedWhen() != secDiffed) {
+    // Edits are shown as they happen but differences are not.
+    secDiffed = sec->diffedWhen();
+    setup();
+  }
+}
+
+void MachineCodeWidget::onDataChanged(int pos, int size) {
+  // Rows are made from the current data once shown.
+  if (!shown || size <= 0) return;
+
+  int first = pos / 16, last = (pos + size - 1) / 16;
+  for (int row = first; row <= last; row++) {
+    auto *item = treeWidget->topLevelItem(row);
+    if (!item) break;
+    int byte = row * 16;
+    setRowData(item, byte);
+    if (pos < byte + 8 && pos + size > byte) {
+      Util::setTreeItemMarked(item, 1);
+    }
+    if (pos < byte + 16 && pos + size > byte + 8) {
+      Util::setTreeItemMarked(item, 2);
     }
   }
 }
 
+bool MachineCodeWidget::selectAddress(quint64 addr) {
+  quint64 start = sec->getAddress();
+  if (addr < start || addr >= start + sec->getSize()) {
+    return false;
+  }
+  if (!shown) {
+    shown = true;
+    setup();
+  }
+  return treeWidget->selectAddress(addr);
+}
+
 void MachineCodeWidget::createLayout() {
   label = new QLabel;
 
@@ -161,22 +192,8 @@ void MachineCodeWidget::setup() {
     item->setFlags(Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
     item->setText(0, Util::padString(QString::number(addr, 16).toUpper(),
                                      obj->getSystemBits() / 8));
-
-    QString code, ascii;
-    for (int cur = 0; cur < 16 && byte < len; cur++, byte++) {
-      QString hex =
-        Util::padString(QString::number((unsigned char) data[byte], 16), 2);
-      code += hex + " ";
-
-      ascii += Util::dataToAscii(data, byte, 1);
-    }
-    if (code.endsWith(" ")) {
-      code.chop(1);
-    }
-    code = code.toUpper();
-    item->setText(1, code.mid(0, 8 * 3));
-    item->setText(2, code.mid(8 * 3));
-    item->setText(3, ascii);
+    setRowData(item, byte);
+    byte = qMin(byte + 16, len);
 
     treeWidget->addTopLevelItem(item);
     addr += 16;
@@ -227,6 +244,20 @@ void MachineCodeWidget::setup() {
     }
   }
 
+  // Highlight differences to the section last compared against.
+  const auto &diffRegs = sec->getDiffRegions();
+  if (!diffRegs.isEmpty()) {
+    for (int row = 0, byte = 0; row < rows; row++, byte += 16) {
+      auto *item = treeWidget->topLevelItem(row);
+      if (diffRegs.intersects(byte, 8)) {
+        Util::setTreeItemDiffed(item, 1);
+      }
+      if (diffRegs.intersects(byte + 8, 8)) {
+        Util::setTreeItemDiffed(item, 2);
+      }
+    }
+  }
+
   int padSize = obj->getSystemBits() / 8;
   addr = sec->getAddress();
   label->setText(tr("Section size: %1, address %2 to %3, %4 rows")
@@ -239,3 +270,24 @@ void MachineCodeWidget::setup() {
 
   treeWidget->setFocus();
 }
+
+void MachineCodeWidget::setRowData(QTreeWidgetItem *item, int pos) {
+  const QByteArray &data = sec->getData();
+  int len = data.size();
+
+  QString code, ascii;
+  for (int byte = pos; byte < pos + 16 && byte < len; byte++) {
+    QString hex =
+      Util::padString(QString::number((unsigned char) data[byte], 16), 2);
+    code += hex + " ";
+
+    ascii += Util::dataToAscii(data, byte, 1);
+  }
+  if (code.endsWith(" ")) {
+    code.chop(1);
+  }
+  code = code.toUpper();
+  item->setText(1, code.mid(0, 8 * 3));
+  item->setText(2, code.mid(8 * 3));
+  item->setText(3, ascii);
+}
@@ -17,20 +17,30 @@ class MachineCodeWidget : public QWidget {
 public:
   MachineCodeWidget(BinaryObjectPtr obj, SectionPtr sec);
 
+  bool selectAddress(quint64 addr);
+
 signals:
   void modified();
 
 protected:
   void showEvent(QShowEvent *event);
 
+private slots:
+  void onDataChanged(int pos, int size);
+
 private:
   void createLayout();
   void setup();
   void setItemMarked(QTreeWidgetItem *item, int column);
 
+  /**
+   * Show the 16 bytes from pos in the item.
+   */
+  void setRowData(QTreeWidgetItem *item, int pos);
+
   BinaryObjectPtr obj;
   SectionPtr sec;
-  QDateTime secModified;
+  QDateTime secDiffed;
 
   bool shown;
   QLabel *label;
@@ -1,21 +1,58 @@
+#include <QSet>
 #include <QDebug>
+#include <QTimer>
 #include <QMenuBar>
 #include <QSettings>
 #include <QTabWidget>
 #include <QCloseEvent>
 #include <QVBoxLayout>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
+#include <QUndoStack>
 #include <QApplication>
 #include <QProgressDialog>
+#include <QFileSystemWatcher>
 
 #include "../Util.h"
+#include "../Patch.h"
+#include "../BytePattern.h"
+#include "../ReplaceCommand.h"
 #include "MainWindow.h"
 #include "BinaryWidget.h"
 #include "ConversionHelper.h"
 #include "../formats/Format.h"
+#include "../formats/DyldCache.h"
 #include "PreferencesDialog.h"
 #include "DisassemblerDialog.h"
+#include "ReplaceDialog.h"
+#include "FunctionMatchDialog.h"
+#include "CaveDialog.h"
+#include "../analysis/BinaryDiff.h"
+#include "../analysis/SimilarityIndex.h"
+#include "../analysis/CaveFinder.h"
+
+namespace {
+  /**
+   * Index of the item chosen in an input dialog, or -1 if cancelled.
+   * Repeated labels are numbered so every choice is told apart.
+   */
+  int chooseItem(QWidget *parent, const QString &label, QStringList items) {
+    for (int i = 0; i < items.size(); i++) {
+      int num{1};
+      for (int j = i + 1; j < items.size(); j++) {
+        if (items[j] == items[i]) {
+          items[j] += QString(" #%1").arg(++num);
+        }
+      }
+    }
+
+    bool ok;
+    QString item =
+      QInputDialog::getItem(parent, "bmod", label, items, 0, false, &ok);
+    return (ok ? items.indexOf(item) : -1);
+  }
+}
 
 MainWindow::MainWindow(const QStringList &files)
   : shown{false}, modified{false}, startupFiles{files}
@@ -24,6 +61,19 @@ MainWindow::MainWindow(const QStringList &files)
   startupFiles = startupFiles.toSet().toList();
 
   setWindowTitle("bmod");
+  undoStack = new QUndoStack(this);
+
+  // Builds write their output in several steps so changes are collected
+  // for a moment before reloading.
+  watcher = new QFileSystemWatcher(this);
+  connect(watcher, &QFileSystemWatcher::fileChanged,
+          this, &MainWindow::onFileChanged);
+  reloadTimer = new QTimer(this);
+  reloadTimer->setSingleShot(true);
+  reloadTimer->setInterval(500);
+  connect(reloadTimer, &QTimer::timeout,
+          this, &MainWindow::reloadChangedFiles);
+
   readSettings();
   createLayout();
   createMenu();
@@ -75,6 +125,9 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 void MainWindow::openBinary() {
   QFileDialog diag(this, tr("Open Binary"), QDir::homePath());
   diag.setNameFilters(QStringList{"Mach-O binary (*.o *.dylib *.bundle *)",
+                                  "ELF binary (*.o *.so *)",
+                                  "dyld shared cache (dyld_shared_cache_*)",
+                                  "Static library (*.a)",
                                   "Any file (*)"});
   if (!diag.exec()) {
     if (binaryWidgets.isEmpty()) {
@@ -146,7 +199,12 @@ void MainWindow::closeBinary() {
     }
 
     tabWidget->removeTab(idx);
-    delete binaryWidgets.takeAt(idx);
+    auto *binary = binaryWidgets.takeAt(idx);
+    watcher->removePath(binary->getFile());
+    delete binary;
+
+    // Commands might refer to sections of the closed binary.
+    undoStack->clear();
   }
 
   if (binaryWidgets.isEmpty()) {
@@ -154,6 +212,76 @@ void MainWindow::closeBinary() {
   }
 }
 
+void MainWindow::exportPatch() {
+  int idx = tabWidget->currentIndex();
+  if (idx == -1) return;
+
+  auto *binary = binaryWidgets[idx];
+  auto patch = Patch::fromFormat(binary->getFormat());
+  if (!patch) {
+    QMessageBox::warning(this, "bmod", tr("Could not read original bytes!"));
+    return;
+  }
+  if (patch->getEntries().isEmpty()) {
+    QMessageBox::information(this, "bmod", tr("There are no modifications."));
+    return;
+  }
+
+  QString file =
+    QFileDialog::getSaveFileName(this, tr("Export patch"),
+                                 binary->getFile() + ".bmpatch");
+  if (file.isEmpty()) return;
+
+  if (!patch->save(file)) {
+    QMessageBox::warning(this, "bmod", tr("Could not save patch!"));
+  }
+}
+
+void MainWindow::applyPatch() {
+  QString file =
+    QFileDialog::getOpenFileName(this, tr("Open patch"), QDir::homePath(),
+                                 tr("Patches (*.bmpatch);;All files (*)"));
+  if (file.isEmpty()) return;
+
+  auto patch = Patch::load(file);
+  if (!patch) {
+    QMessageBox::warning(this, "bmod", tr("Could not read patch!"));
+    return;
+  }
+
+  QStringList targets =
+    QFileDialog::getOpenFileNames(this, tr("Choose binaries to patch"),
+                                  QDir::homePath());
+  if (targets.isEmpty()) return;
+
+  // Open binaries would not reflect the changes.
+  foreach (const auto *binary, binaryWidgets) {
+    if (targets.contains(binary->getFile())) {
+      QMessageBox::warning(this, "bmod",
+                           tr("Close \"%1\" before patching it.")
+                           .arg(binary->getFile()));
+      return;
+    }
+  }
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Applying patch.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  auto results = patch->applyAll(targets);
+  progDiag.close();
+
+  QStringList lines;
+  for (int i = 0; i < targets.size(); i++) {
+    lines << QString("%1: %2").arg(QFileInfo(targets[i]).fileName())
+      .arg(Util::patchResultString(results[i]));
+  }
+  QMessageBox::information(this, "bmod", lines.join("\n"));
+}
+
 void MainWindow::showPreferences() {
   PreferencesDialog diag(config);
   diag.exec();
@@ -170,6 +298,119 @@ void MainWindow::showDisassembler() {
   disass->show();
 }
 
+void MainWindow::matchFunctions() {
+  auto obj = selectObject();
+  if (!obj) return;
+
+  // Match against the objects of the other binaries or a saved index.
+  QStringList items;
+  QList<BinaryObjectPtr> objs;
+  int cur = tabWidget->currentIndex();
+  for (int i = 0; i < binaryWidgets.size(); i++) {
+    if (i == cur) continue;
+    const auto *binary = binaryWidgets[i];
+    foreach (auto other, binary->getFormat()->getObjects()) {
+      items << QString("%1 (%2)")
+        .arg(QDir::toNativeSeparators(binary->getFile()))
+        .arg(Util::cpuTypeString(other->getCpuType()));
+      objs << other;
+    }
+  }
+  items << tr("Saved function index..");
+
+  int idx = chooseItem(this, tr("Match functions against:"), items);
+  if (idx == -1) return;
+
+  SimilarityIndexPtr other;
+  if (idx == objs.size()) {
+    QString file =
+      QFileDialog::getOpenFileName(this, tr("Open function index"),
+                                   QDir::homePath());
+    if (file.isEmpty()) return;
+    other = SimilarityIndex::load(file);
+    if (!other) {
+      QMessageBox::warning(this, "bmod",
+                           tr("Could not read function index!"));
+      return;
+    }
+  }
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Matching functions.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  // Fingerprint the code as it is now.
+  obj->dropStaleAnalyses();
+  if (!other) {
+    objs[idx]->dropStaleAnalyses();
+    other = objs[idx]->getSimilarityIndex();
+  }
+  auto matches = obj->getSimilarityIndex()->match(*other);
+  progDiag.close();
+
+  auto *diag =
+    new FunctionMatchDialog(matches, obj->getSystemBits() / 8, this);
+  diag->show();
+}
+
+void MainWindow::saveFunctionIndex() {
+  auto obj = selectObject();
+  if (!obj) return;
+
+  QString file =
+    QFileDialog::getSaveFileName(this, tr("Save function index"),
+                                 QDir::homePath());
+  if (file.isEmpty()) return;
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Fingerprinting functions.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  obj->dropStaleAnalyses();
+  if (!obj->getSimilarityIndex()->save(file)) {
+    QMessageBox::warning(this, "bmod", tr("Could not save function index!"));
+  }
+}
+
+void MainWindow::findCaves() {
+  int idx = tabWidget->currentIndex();
+  if (idx == -1) return;
+
+  bool ok;
+  int minSize =
+    QInputDialog::getInt(this, "bmod", tr("Minimum cave size:"), 16, 1,
+                         1024 * 1024, 1, &ok);
+  if (!ok) return;
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Searching for code caves.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  auto *binary = binaryWidgets[idx];
+  auto caves = CaveFinder::find(binary->getFormat()->getObjects(), minSize);
+  progDiag.close();
+
+  if (caves.isEmpty()) {
+    QMessageBox::information(this, "bmod", tr("No code caves found."));
+    return;
+  }
+
+  auto *diag = new CaveDialog(binary, caves, this);
+  connect(diag, &CaveDialog::caveActivated,
+          this, &MainWindow::onCaveActivated);
+  connect(diag, &CaveDialog::fillRequested, this, &MainWindow::onCaveFill);
+  diag->show();
+}
+
 void MainWindow::onRecentFile() {
   auto *action = qobject_cast<QAction*>(sender());
   if (!action) return;
@@ -179,12 +420,89 @@ void MainWindow::onRecentFile() {
 void MainWindow::onBinaryObjectModified() {
   auto *bin = qobject_cast<BinaryWidget*>(sender());
   if (!bin) return;
+  markModified(binaryWidgets.indexOf(bin));
+}
 
-  modified = true;
-  int idx = tabWidget->currentIndex();
-  QString text = tabWidget->tabText(idx);
-  if (!text.endsWith(" *")) {
-    tabWidget->setTabText(idx, text + " *");
+void MainWindow::onCaveActivated(int idx) {
+  auto *diag = qobject_cast<CaveDialog*>(sender());
+  if (!diag) return;
+
+  // The binary might have been closed in the meantime.
+  auto *binary = diag->getBinary();
+  int tab = binaryWidgets.indexOf(binary);
+  if (tab == -1) return;
+
+  const auto &cave = diag->getCaves()[idx];
+  tabWidget->setCurrentIndex(tab);
+  if (!binary->selectAddress(cave.obj, cave.addr)) {
+    QMessageBox::information(this, "bmod",
+                             tr("No pane shows address %1.")
+                             .arg(QString::number(cave.addr, 16).toUpper()));
+  }
+}
+
+void MainWindow::onCaveFill(int idx, int byte) {
+  auto *diag = qobject_cast<CaveDialog*>(sender());
+  if (!diag) return;
+
+  int tab = binaryWidgets.indexOf(diag->getBinary());
+  if (tab == -1) return;
+
+  const auto &cave = diag->getCaves()[idx];
+  if (!cave.sec) {
+    QMessageBox::warning(this, "bmod",
+                         tr("Segment slack is not part of any section and "
+                            "cannot be edited."));
+    return;
+  }
+  auto cpu = cave.obj->getCpuType();
+  if (cpu != CpuType::X86 && cpu != CpuType::X86_64) {
+    QMessageBox::warning(this, "bmod",
+                         tr("Filling is only supported for x86 code."));
+    return;
+  }
+
+  ReplaceCommand::Edit edit;
+  edit.sec = cave.sec;
+  edit.pos = cave.addr - cave.sec->getAddress();
+  edit.oldData = cave.sec->getData().mid(edit.pos, cave.size);
+  edit.newData = QByteArray(cave.size, (char) byte);
+  if (edit.newData == edit.oldData) return;
+
+  QString text = tr("Fill cave at %1")
+    .arg(QString::number(cave.addr, 16).toUpper());
+  undoStack->push(new ReplaceCommand(QList<ReplaceCommand::Edit>{edit}, text));
+  markModified(tab);
+}
+
+void MainWindow::onFileChanged(const QString &file) {
+  changedFiles << file;
+  reloadTimer->start();
+}
+
+void MainWindow::reloadChangedFiles() {
+  foreach (const auto &file, changedFiles) {
+    int idx{-1};
+    for (int i = 0; i < binaryWidgets.size(); i++) {
+      if (binaryWidgets[i]->getFile() == file) {
+        idx = i;
+        break;
+      }
+    }
+    if (idx == -1) {
+      changedFiles.remove(file);
+      continue;
+    }
+
+    // Files replaced by a new one are no longer watched. Wait until it
+    // has been written if it is not there yet.
+    if (!QFile::exists(file)) {
+      reloadTimer->start();
+      continue;
+    }
+    changedFiles.remove(file);
+    watcher->addPath(file);
+    reloadBinary(idx);
   }
 }
 
@@ -237,12 +555,26 @@ void MainWindow::createMenu() {
                       QKeySequence::Save);
   fileMenu->addAction(tr("Close binary"), this, SLOT(closeBinary()),
                       QKeySequence::Close);
+  fileMenu->addSeparator();
+  fileMenu->addAction(tr("Export patch"), this, SLOT(exportPatch()));
+  fileMenu->addAction(tr("Apply patch"), this, SLOT(applyPatch()));
 #ifndef MAC
   fileMenu->addSeparator();
 #endif
   fileMenu->addAction(tr("Preferences"), this, SLOT(showPreferences()),
                       QKeySequence(Qt::CTRL + Qt::Key_P));
 
+  QMenu *editMenu = menuBar()->addMenu(tr("Edit"));
+  auto *undoAction = undoStack->createUndoAction(this, tr("Undo"));
+  undoAction->setShortcut(QKeySequence::Undo);
+  editMenu->addAction(undoAction);
+  auto *redoAction = undoStack->createRedoAction(this, tr("Redo"));
+  redoAction->setShortcut(QKeySequence::Redo);
+  editMenu->addAction(redoAction);
+  editMenu->addSeparator();
+  editMenu->addAction(tr("Search and replace.."), this, SLOT(searchReplace()),
+                      QKeySequence(Qt::CTRL + Qt::Key_R));
+
   QMenu *toolsMenu = menuBar()->addMenu(tr("Tools"));
   toolsMenu->addAction(tr("Conversion helper"),
                        this, SLOT(showConversionHelper()),
@@ -250,6 +582,15 @@ void MainWindow::createMenu() {
   toolsMenu->addAction(tr("Disassembler"),
                        this, SLOT(showDisassembler()),
                        QKeySequence(Qt::SHIFT + Qt::CTRL + Qt::Key_D));
+  toolsMenu->addSeparator();
+  toolsMenu->addAction(tr("Diff with.."),
+                       this, SLOT(diffBinaries()));
+  toolsMenu->addAction(tr("Match functions"),
+                       this, SLOT(matchFunctions()));
+  toolsMenu->addAction(tr("Save function index"),
+                       this, SLOT(saveFunctionIndex()));
+  toolsMenu->addAction(tr("Find code caves.."),
+                       this, SLOT(findCaves()));
 }
 
 void MainWindow::loadBinary(QString file) {
@@ -274,6 +615,10 @@ void MainWindow::loadBinary(QString file) {
   
   qDebug() << "detected:" << Util::formatTypeString(fmt->getType());
 
+  // Shared caches are not build products so they are not watched.
+  fmt->setWatched(config.getWatchFiles() &&
+                  fmt->getType() != FormatType::DyldCache);
+
   progDiag.setLabelText(tr("Reading and parsing binary.."));
   qApp->processEvents();
   if (!fmt->parse()) {
@@ -281,6 +626,32 @@ void MainWindow::loadBinary(QString file) {
     return;
   }
 
+  // Only the chosen image of a shared cache is loaded.
+  QString title = QFileInfo(file).fileName();
+  if (fmt->getType() == FormatType::DyldCache) {
+    auto cache = std::dynamic_pointer_cast<DyldCache>(fmt);
+    QStringList paths;
+    foreach (const auto &image, cache->getImages()) {
+      paths << image.path;
+    }
+
+    progDiag.hide();
+    bool ok;
+    QString path =
+      QInputDialog::getItem(this, "bmod", tr("Image to open:"), paths, 0,
+                            true, &ok);
+    if (!ok || path.isEmpty()) {
+      return;
+    }
+
+    if (!cache->loadImage(cache->findImage(path))) {
+      QMessageBox::warning(this, "bmod",
+                           tr("Could not load image \"%1\"!").arg(path));
+      return;
+    }
+    title += QString(" (%1)").arg(QFileInfo(path).fileName());
+  }
+
   // Add recent file.
   if (!recentFiles.contains(file)) {
     recentFiles << file;
@@ -293,10 +664,151 @@ void MainWindow::loadBinary(QString file) {
   connect(binWidget, &BinaryWidget::modified,
           this, &MainWindow::onBinaryObjectModified);
   binaryWidgets << binWidget;
-  int idx = tabWidget->addTab(binWidget, QFileInfo(file).fileName());
+  if (fmt->isWatched()) {
+    watcher->addPath(file);
+  }
+  int idx = tabWidget->addTab(binWidget, title);
   tabWidget->setCurrentIndex(idx);
 }
 
+void MainWindow::diffBinaries() {
+  auto obj = selectObject();
+  if (!obj) return;
+
+  // Any other object can be compared, including other slices of the
+  // same fat binary.
+  QStringList items;
+  QList<BinaryObjectPtr> objs;
+  foreach (const auto *binary, binaryWidgets) {
+    foreach (auto other, binary->getFormat()->getObjects()) {
+      if (other == obj) continue;
+      items << QString("%1 (%2)")
+        .arg(QDir::toNativeSeparators(binary->getFile()))
+        .arg(Util::cpuTypeString(other->getCpuType()));
+      objs << other;
+    }
+  }
+  if (objs.isEmpty()) {
+    QMessageBox::information(this, "bmod",
+                             tr("Open another binary to compare with."));
+    return;
+  }
+
+  int idx = chooseItem(this, tr("Compare with:"), items);
+  if (idx == -1) return;
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Comparing binaries.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  auto diff = BinaryDiff::diff(obj, objs[idx]);
+  diff->markSections();
+  progDiag.close();
+
+  quint64 changed{0};
+  foreach (const auto &sec, diff->getSections()) {
+    changed += sec.changedA.getTotalSize();
+  }
+  QMessageBox::information(this, "bmod",
+                           tr("%1 of %2 sections differ with %3 changed.\n"
+                              "Differences are highlighted in the panes.")
+                           .arg(diff->getChangedCount())
+                           .arg(diff->getSections().size())
+                           .arg(Util::formatSize(changed)));
+}
+
+void MainWindow::searchReplace() {
+  int cur = tabWidget->currentIndex();
+  if (cur == -1) return;
+
+  ReplaceDialog diag(this);
+  if (!diag.exec()) return;
+
+  BytePattern pattern(diag.getPattern());
+  pattern.setReplacement(diag.getReplacement());
+
+  // Every section of every object in scope, remembering the binary.
+  QList<SectionPtr> secs;
+  QList<int> owners;
+  for (int i = 0; i < binaryWidgets.size(); i++) {
+    if (!diag.isAllBinaries() && i != cur) continue;
+    foreach (auto obj, binaryWidgets[i]->getFormat()->getObjects()) {
+      foreach (auto sec, obj->getSections()) {
+        secs << sec;
+        owners << i;
+      }
+    }
+  }
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Searching.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  auto matches = pattern.findAll(secs);
+  progDiag.close();
+
+  QList<ReplaceCommand::Edit> edits;
+  QSet<int> touched;
+  for (int i = 0; i < secs.size(); i++) {
+    auto sec = secs[i];
+    const QByteArray &data = sec->getData();
+    foreach (int pos, matches[i]) {
+      ReplaceCommand::Edit edit;
+      edit.sec = sec;
+      edit.pos = pos;
+      edit.oldData = data.mid(pos, pattern.size());
+      edit.newData = pattern.replacement(data, pos);
+      if (edit.newData == edit.oldData) continue;
+      edits << edit;
+      touched << owners[i];
+    }
+  }
+  if (edits.isEmpty()) {
+    QMessageBox::information(this, "bmod", tr("Nothing to replace."));
+    return;
+  }
+
+  auto answer =
+    QMessageBox::question(this, "bmod",
+                          tr("Replace %1 matches in %2 binaries?")
+                          .arg(edits.size()).arg(touched.size()));
+  if (answer == QMessageBox::No) {
+    return;
+  }
+
+  // Pushing applies the edits and the whole batch is undone in one step.
+  QString text = tr("Replace %1").arg(diag.getPattern());
+  undoStack->push(new ReplaceCommand(edits, text));
+  foreach (int idx, touched) {
+    markModified(idx);
+  }
+}
+
+BinaryObjectPtr MainWindow::selectObject() {
+  int idx = tabWidget->currentIndex();
+  if (idx == -1) {
+    return nullptr;
+  }
+
+  auto objs = binaryWidgets[idx]->getFormat()->getObjects();
+  if (objs.size() < 2) {
+    return objs.isEmpty() ? nullptr : objs.first();
+  }
+
+  QStringList items;
+  foreach (auto obj, objs) {
+    items << Util::cpuTypeString(obj->getCpuType());
+  }
+  int choice = chooseItem(this, tr("Architecture:"), items);
+  return (choice == -1 ? nullptr : objs[choice]);
+}
+
 void MainWindow::saveBackup(const QString &file) {
   // Determine if prior backups have been made and, if so, how many.
   QFileInfo fi(file);
@@ -331,3 +843,48 @@ void MainWindow::saveBackup(const QString &file) {
                          tr("Could not save backup to \"%1\"!").arg(dest));
   }
 }
+
+void MainWindow::reloadBinary(int idx) {
+  auto *binary = binaryWidgets[idx];
+
+  QProgressDialog progDiag(this);
+  progDiag.setLabelText(tr("Reloading changed binary.."));
+  progDiag.setCancelButton(nullptr);
+  progDiag.setRange(0, 0);
+  progDiag.show();
+  qApp->processEvents();
+
+  QStringList conflicts;
+  auto res = binary->reload(conflicts);
+  progDiag.close();
+
+  QString file = QFileInfo(binary->getFile()).fileName();
+  if (res == BinaryWidget::Reload::Failed) {
+    QMessageBox::warning(this, "bmod",
+                         tr("\"%1\" changed on disk but could not be "
+                            "reloaded!").arg(file));
+    return;
+  }
+
+  // Commands refer to the sections that were replaced.
+  if (res == BinaryWidget::Reload::Full) {
+    undoStack->clear();
+  }
+
+  if (!conflicts.isEmpty()) {
+    QMessageBox::warning(this, "bmod",
+                         tr("\"%1\" changed on disk where it was edited. "
+                            "The edits were kept:\n\n%2")
+                         .arg(file).arg(conflicts.join("\n")));
+  }
+}
+
+void MainWindow::markModified(int idx) {
+  if (idx == -1) return;
+
+  modified = true;
+  QString text = tabWidget->tabText(idx);
+  if (!text.endsWith(" *")) {
+    tabWidget->setTabText(idx, text + " *");
+  }
+}
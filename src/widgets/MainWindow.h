@@ -1,14 +1,19 @@
 #ifndef BMOD_MAIN_WINDOW_H
 #define BMOD_MAIN_WINDOW_H
 
+#include <QSet>
 #include <QList>
 #include <QMainWindow>
 
 #include "Config.h"
+#include "../BinaryObject.h"
 
+class QTimer;
 class QTabWidget;
+class QUndoStack;
 class QStringList;
 class BinaryWidget;
+class QFileSystemWatcher;
 
 class MainWindow : public QMainWindow {
   Q_OBJECT
@@ -25,11 +30,22 @@ private slots:
   void openBinary();
   void saveBinary();
   void closeBinary();
+  void exportPatch();
+  void applyPatch();
   void showPreferences();
   void showConversionHelper();
   void showDisassembler();
+  void matchFunctions();
+  void saveFunctionIndex();
+  void findCaves();
+  void diffBinaries();
+  void searchReplace();
   void onRecentFile();
   void onBinaryObjectModified();
+  void onCaveActivated(int idx);
+  void onCaveFill(int idx, int byte);
+  void onFileChanged(const QString &file);
+  void reloadChangedFiles();
 
 private:
   void readSettings();
@@ -39,6 +55,13 @@ private:
 
   void loadBinary(QString file);
   void saveBackup(const QString &file);
+  void markModified(int idx);
+  void reloadBinary(int idx);
+
+  /**
+   * Object of the current binary, asking which one if it has several.
+   */
+  BinaryObjectPtr selectObject();
 
   Config config;
   bool shown, modified;
@@ -47,6 +70,11 @@ private:
 
   QTabWidget *tabWidget;
   QList<BinaryWidget*> binaryWidgets;
+  QUndoStack *undoStack;
+
+  QFileSystemWatcher *watcher;
+  QTimer *reloadTimer;
+  QSet<QString> changedFiles;
 };
 
 #endif // BMOD_MAIN_WINDOW_H
@@ -23,6 +23,10 @@ void PreferencesDialog::onConfirmQuitChanged(int state) {
   config.setConfirmQuit(state == Qt::Checked);
 }
 
+void PreferencesDialog::onWatchFilesChanged(int state) {
+  config.setWatchFiles(state == Qt::Checked);
+}
+
 void PreferencesDialog::onBackupsToggled(bool on) {
   config.setBackupEnabled(on);
 }
@@ -59,9 +63,18 @@ void PreferencesDialog::createTabs() {
   connect(generalConfirmQuitChk, &QCheckBox::stateChanged,
           this, &PreferencesDialog::onConfirmQuitChanged);
 
+  auto *generalWatchFilesChk =
+    new QCheckBox(tr("Reload binaries when they are rewritten on disk.\n"
+                     "They are then kept in memory instead of mapped. "
+                     "Applies to binaries opened afterwards."));
+  generalWatchFilesChk->setChecked(config.getWatchFiles());
+  connect(generalWatchFilesChk, &QCheckBox::stateChanged,
+          this, &PreferencesDialog::onWatchFilesChanged);
+
   auto *generalLayout = new QVBoxLayout;
   generalLayout->addWidget(generalConfirmCommitChk);
   generalLayout->addWidget(generalConfirmQuitChk);
+  generalLayout->addWidget(generalWatchFilesChk);
   generalLayout->addStretch();
 
   auto *generalWidget = new QWidget;
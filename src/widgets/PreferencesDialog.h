@@ -16,6 +16,7 @@ public:
 private slots:
   void onConfirmCommitChanged(int state);
   void onConfirmQuitChanged(int state);
+  void onWatchFilesChanged(int state);
   void onBackupsToggled(bool on);
   void onBackupAskChanged(int state);
   void onBackupAmountChanged(int amount);
@@ -0,0 +1,83 @@
+#include <QLabel>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QMessageBox>
+#include <QDialogButtonBox>
+
+#include "../Util.h"
+#include "ReplaceDialog.h"
+#include "../BytePattern.h"
+
+ReplaceDialog::ReplaceDialog(QWidget *parent) : QDialog{parent} {
+  setWindowTitle(tr("Search and Replace"));
+  createLayout();
+  resize(450, 150);
+  Util::centerWidget(this);
+}
+
+QString ReplaceDialog::getPattern() const {
+  return patternEdit->text();
+}
+
+QString ReplaceDialog::getReplacement() const {
+  return replaceEdit->text();
+}
+
+bool ReplaceDialog::isAllBinaries() const {
+  return allBinariesBox->isChecked();
+}
+
+void ReplaceDialog::onAccept() {
+  bool ok;
+  BytePattern pattern(getPattern(), &ok);
+  if (!ok) {
+    patternEdit->setFocus();
+    QMessageBox::warning(this, "bmod",
+                         tr("Invalid pattern! Use hex bytes and ?? for any byte."));
+    return;
+  }
+  if (!pattern.setReplacement(getReplacement())) {
+    replaceEdit->setFocus();
+    QMessageBox::warning(this, "bmod",
+                         tr("Invalid replacement! It must have %1 bytes.")
+                         .arg(pattern.size()));
+    return;
+  }
+  accept();
+}
+
+void ReplaceDialog::createLayout() {
+  patternEdit = new QLineEdit;
+  patternEdit->setPlaceholderText("E8 ?? ?? ?? ??");
+
+  replaceEdit = new QLineEdit;
+  replaceEdit->setPlaceholderText("90 90 90 90 90");
+
+  allBinariesBox = new QCheckBox(tr("Search all open binaries"));
+
+  auto *formLayout = new QFormLayout;
+  formLayout->addRow(tr("Pattern:"), patternEdit);
+  formLayout->addRow(tr("Replacement:"), replaceEdit);
+  formLayout->addRow(allBinariesBox);
+
+  auto *help =
+    new QLabel(tr("In the replacement ?? keeps the matched byte and $N "
+                  "inserts the byte matched by the Nth wildcard."));
+  help->setWordWrap(true);
+
+  auto *buttonBox =
+    new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  connect(buttonBox, &QDialogButtonBox::accepted,
+          this, &ReplaceDialog::onAccept);
+  connect(buttonBox, &QDialogButtonBox::rejected,
+          this, &ReplaceDialog::reject);
+
+  auto *layout = new QVBoxLayout;
+  layout->addLayout(formLayout);
+  layout->addWidget(help);
+  layout->addWidget(buttonBox);
+
+  setLayout(layout);
+}
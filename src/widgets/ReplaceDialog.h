@@ -0,0 +1,29 @@
+#ifndef BMOD_REPLACE_DIALOG_H
+#define BMOD_REPLACE_DIALOG_H
+
+#include <QDialog>
+
+class QLineEdit;
+class QCheckBox;
+
+class ReplaceDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  ReplaceDialog(QWidget *parent = nullptr);
+
+  QString getPattern() const;
+  QString getReplacement() const;
+  bool isAllBinaries() const;
+
+private slots:
+  void onAccept();
+
+private:
+  void createLayout();
+
+  QLineEdit *patternEdit, *replaceEdit;
+  QCheckBox *allBinariesBox;
+};
+
+#endif // BMOD_REPLACE_DIALOG_H
@@ -196,6 +196,17 @@ void TreeWidget::findAddress() {
     return;
   }
 
+  if (!selectAddress(num)) {
+    QMessageBox::information(this, "bmdo", tr("Did not find anything."));
+  }
+}
+
+bool TreeWidget::selectAddress(quint64 num) {
+  if (addrColumn == -1) {
+    return false;
+  }
+
+  bool ok;
   int cnt = topLevelItemCount();
   for (int i = 0; i < cnt; i++) {
     auto *item = topLevelItem(i);
@@ -204,7 +215,7 @@ void TreeWidget::findAddress() {
     if (n == num) {
       setCurrentItem(item);
       scrollToItem(item, QAbstractItemView::PositionAtCenter);
-      return;
+      return true;
     }
 
     if (i < cnt - 1) {
@@ -214,12 +225,11 @@ void TreeWidget::findAddress() {
       if (num >= n && num < n2) {
         setCurrentItem(item);
         scrollToItem(item, QAbstractItemView::PositionAtCenter);
-        return;
+        return true;
       }
     }
   }
-
-  QMessageBox::information(this, "bmdo", tr("Did not find anything."));
+  return false;
 }
 
 void TreeWidget::resetSearch() {
@@ -21,6 +21,12 @@ public:
 
   void setAddressColumn(int column);
 
+  /**
+   * Select and scroll to the item that contains the address. Returns
+   * false if no such item exists.
+   */
+  bool selectAddress(quint64 addr);
+
 protected:
   void keyPressEvent(QKeyEvent *event);
   void resizeEvent(QResizeEvent *event);